@@ -87,6 +87,12 @@ struct SolverConfiguration
 
     DecimationPrecision decimation_precision;   
     std::string optimization_timeout;    
+
+    /* The solver context and the bed size sufficient for a group of objects
+       are reused by the next group of the same bed. What the solver learned
+       for a group is not kept. The result may differ from solving each group
+       from scratch when the solver times out. */
+    bool incremental_solving;
 };
 
     
@@ -9,6 +9,8 @@
  */
 /*================================================================*/
 
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+
 #include "seq_defs.hpp"
 
 #include "seq_sequential.hpp"
@@ -110,6 +112,7 @@ SolverConfiguration::SolverConfiguration()
     , temporal_spread(SEQ_SCHEDULING_TEMPORAL_SPREAD)
     , decimation_precision(SEQ_DECIMATION_PRECISION_LOW)
     , optimization_timeout(SEQ_Z3_SOLVER_TIMEOUT)
+    , incremental_solving(true)
 {
 	/* nothing */
 }
@@ -124,6 +127,7 @@ SolverConfiguration::SolverConfiguration(const PrinterGeometry &printer_geometry
     , temporal_spread(SEQ_SCHEDULING_TEMPORAL_SPREAD)
     , decimation_precision(SEQ_DECIMATION_PRECISION_LOW)
     , optimization_timeout(SEQ_Z3_SOLVER_TIMEOUT)
+    , incremental_solving(true)
 {
     setup(printer_geometry);
 }
@@ -390,6 +394,15 @@ void schedule_ObjectsForSequentialPrint(const SolverConfiguration        &solver
     #endif
     
     for (unsigned int i = 0; i < objects_to_print.size(); ++i)
+    {
+	original_index_map[i] = objects_to_print[i].id;
+    }
+
+    /* Objects are prepared independently of each other, exceptions are
+       propagated to the caller by the parallel loop. */
+    solvable_objects.resize(objects_to_print.size());
+    
+    Slic3r::execution::for_each(Slic3r::ex_tbb, size_t(0), objects_to_print.size(), [&](size_t i)
     {
 	std::vector<Slic3r::Polygon> convex_level_polygons;	    
 	std::vector<Slic3r::Polygon> box_level_polygons;
@@ -397,8 +410,7 @@ void schedule_ObjectsForSequentialPrint(const SolverConfiguration        &solver
 	std::vector<std::vector<Slic3r::Polygon> > extruder_convex_level_polygons;	    
 	std::vector<std::vector<Slic3r::Polygon> > extruder_box_level_polygons;	
 
-	SolvableObject solvable_object;
-	original_index_map[i] = objects_to_print[i].id;
+	SolvableObject &solvable_object = solvable_objects[i];
 	    
 	prepare_ExtruderPolygons(solver_configuration,
 				 printer_geometry,
@@ -419,9 +431,7 @@ void schedule_ObjectsForSequentialPrint(const SolverConfiguration        &solver
 
 	solvable_object.id = objects_to_print[i].id;
 	solvable_object.lepox_to_next = objects_to_print[i].glued_to_next;
-
-    	solvable_objects.push_back(solvable_object);
-    }
+    });
 
     std::vector<int> remaining_polygons;
     std::vector<int> decided_polygons;
@@ -9619,6 +9619,7 @@ bool optimize_ConsequentialWeakPolygonNonoverlappingBinaryCentered(z3::solver
 								   z3::context                                      &Context,
 								   const SolverConfiguration                        &solver_configuration,
 								   BoundingBox                                      &inner_half_box,
+								   BoundingBox                                      &warm_half_box,
 								   const z3::expr_vector                            &dec_vars_X,
 								   const z3::expr_vector                            &dec_vars_Y,
 								   const z3::expr_vector                            &dec_vars_T,
@@ -9651,6 +9652,13 @@ bool optimize_ConsequentialWeakPolygonNonoverlappingBinaryCentered(z3::solver
     BoundingBox _inner_half_box = inner_half_box;
     BoundingBox _outer_half_box = solver_configuration.plate_bounding_box;
 
+    /* The box sufficient for the previous group is tried first, the next group
+       usually needs a similar one. The warm start only changes the order of the
+       probes. Solvability would be monotone in the box size with exact answers,
+       but a probe that times out is taken as unsolvable, so the resulting box
+       may differ from the one found without the warm start. */
+    bool warm_start = warm_half_box.defined;
+
     int progress_total_estimation = MAX(1, std::log2(1 + MAX(MAX(ABS(_outer_half_box.min.x() - _inner_half_box.min.x()), ABS(_outer_half_box.max.x() - _inner_half_box.max.x())),
 							     MAX(ABS(_outer_half_box.min.y() - _inner_half_box.min.y()), ABS(_outer_half_box.max.y() - _inner_half_box.max.y())))));
     int progress = 0;
@@ -9681,6 +9689,23 @@ bool optimize_ConsequentialWeakPolygonNonoverlappingBinaryCentered(z3::solver
 	coord_t box_min_y = (_outer_half_box.min.y() + _inner_half_box.min.y()) / 2;
 	coord_t box_max_y = (_outer_half_box.max.y() + _inner_half_box.max.y()) / 2;	
 
+	if (warm_start)
+	{
+	    warm_start = false;
+
+	    if (   warm_half_box.min.x() >= _outer_half_box.min.x() && warm_half_box.min.x() <= _inner_half_box.min.x()
+		&& warm_half_box.min.y() >= _outer_half_box.min.y() && warm_half_box.min.y() <= _inner_half_box.min.y()
+		&& warm_half_box.max.x() <= _outer_half_box.max.x() && warm_half_box.max.x() >= _inner_half_box.max.x()
+		&& warm_half_box.max.y() <= _outer_half_box.max.y() && warm_half_box.max.y() >= _inner_half_box.max.y()
+		&& warm_half_box != _outer_half_box)
+	    {
+		box_min_x = warm_half_box.min.x();
+		box_max_x = warm_half_box.max.x();
+		box_min_y = warm_half_box.min.y();
+		box_max_y = warm_half_box.max.y();
+	    }
+	}
+
 	#ifdef DEBUG
 	{
 	    printf("BBX: %d, %d, %d, %d\n", box_min_x, box_max_x, box_min_y, box_max_y);
@@ -9915,6 +9940,11 @@ bool optimize_ConsequentialWeakPolygonNonoverlappingBinaryCentered(z3::solver
     }
     progress_callback(progress_range.progress_max);    
 
+    if (solving_result)
+    {
+	warm_half_box = _outer_half_box;
+    }
+
     return solving_result;
 }
 
@@ -9923,6 +9953,7 @@ bool optimize_ConsequentialWeakPolygonNonoverlappingBinaryCentered(z3::solver
 								   z3::context                                      &Context,
 								   const SolverConfiguration                        &solver_configuration,
 								   Polygon                                          &inner_half_polygon,
+								   Polygon                                          &warm_half_polygon,
 								   const z3::expr_vector                            &dec_vars_X,
 								   const z3::expr_vector                            &dec_vars_Y,
 								   const z3::expr_vector                            &dec_vars_T,
@@ -9962,6 +9993,10 @@ bool optimize_ConsequentialWeakPolygonNonoverlappingBinaryCentered(z3::solver
 
     assert(_inner_half_polygon.points.size() == _outer_half_polygon.points.size());
 
+    /* The polygon sufficient for the previous group is tried first, see the
+       bounding box variant above. */
+    bool warm_start = warm_half_polygon.points.size() == _outer_half_polygon.points.size();
+
     coord_t max_diff = ABS(_outer_half_polygon.points[0].x() - _inner_half_polygon.points[0].x());
     for (unsigned int i = 1; i < _outer_half_polygon.points.size(); ++i)
     {
@@ -10034,6 +10069,24 @@ bool optimize_ConsequentialWeakPolygonNonoverlappingBinaryCentered(z3::solver
 										      (_outer_half_polygon[i].y() + _inner_half_polygon[i].y()) / 2));
 	}
 	    
+	if (warm_start)
+	{
+	    warm_start = false;
+
+	    bool between = warm_half_polygon != _outer_half_polygon;
+	    for (unsigned int i = 0; between && i < _outer_half_polygon.points.size(); ++i)
+	    {
+		between =    warm_half_polygon[i].x() >= MIN(_inner_half_polygon[i].x(), _outer_half_polygon[i].x())
+		          && warm_half_polygon[i].x() <= MAX(_inner_half_polygon[i].x(), _outer_half_polygon[i].x())
+		          && warm_half_polygon[i].y() >= MIN(_inner_half_polygon[i].y(), _outer_half_polygon[i].y())
+		          && warm_half_polygon[i].y() <= MAX(_inner_half_polygon[i].y(), _outer_half_polygon[i].y());
+	    }
+	    if (between)
+	    {
+		bounding_polygon = warm_half_polygon;
+	    }
+	}
+	    
 	#ifdef DEBUG
 	{
 	    printf("BBX: ");
@@ -10274,6 +10327,11 @@ bool optimize_ConsequentialWeakPolygonNonoverlappingBinaryCentered(z3::solver
     }
     progress_callback(progress_range.progress_max);    
 
+    if (solving_result)
+    {
+	warm_half_polygon = _outer_half_polygon;
+    }
+
     return solving_result;
 }
 
@@ -11286,10 +11344,15 @@ bool optimize_SubglobalConsequentialPolygonNonoverlappingBinaryCentered(const So
     coord_t box_center_y = (solver_configuration.plate_bounding_box.min.y() + solver_configuration.plate_bounding_box.max.y()) / 2;
     
     BoundingBox inner_half_box({box_center_x, box_center_y}, {box_center_x, box_center_y});
+    BoundingBox warm_half_box;
     
     for (unsigned int curr_polygon = 0; curr_polygon < polygons.size(); /* nothing */)
     {	
 	bool optimized = false;
+	if (!solver_configuration.incremental_solving)
+	{
+	    warm_half_box = BoundingBox();
+	}
 	z3::set_param("timeout", solver_configuration.optimization_timeout.c_str());
 	    
 	z3::context z_context;
@@ -11424,6 +11487,7 @@ bool optimize_SubglobalConsequentialPolygonNonoverlappingBinaryCentered(const So
 										      z_context,
 										      solver_configuration,
 										      inner_half_box,
+										      warm_half_box,
 										      local_dec_vars_X,
 										      local_dec_vars_Y,
 										      local_dec_vars_T,
@@ -11546,6 +11610,10 @@ bool optimize_SubglobalConsequentialPolygonNonoverlappingBinaryCentered(const So
     BoundingBox inner_half_box;
     Polygon inner_half_polygon;    
 
+    /* The smallest bed area sufficient for the last decided group. */
+    BoundingBox warm_half_box;
+    Polygon warm_half_polygon;
+
     if (solver_configuration.plate_bounding_polygon.points.size() > 0)
     {
 	coord_t sum_x = 0;
@@ -11583,14 +11651,30 @@ bool optimize_SubglobalConsequentialPolygonNonoverlappingBinaryCentered(const So
 	lepox_to_next.push_back(solvable_object.lepox_to_next);
     }
 
+    z3::set_param("timeout", solver_configuration.optimization_timeout.c_str());
+
+    /* A single solver serves all the groups of the bed. The constraints of
+       a group are added in their own scope, which is dropped once the group is
+       decided, so that the context and the declarations of the decision
+       variables are reused. The lemmas learned inside the scope are dropped
+       with it, nothing learned for one group carries over to the next one.
+       Objects left out of a group are only switched off by the presence
+       assumptions, the constraints stay in place. Without incremental solving
+       each group gets a fresh solver and no warm start. */
+    z3::context z_context;
+    z3::solver z_solver(z_context);
+
     unsigned int curr_polygon;    
     for (curr_polygon = 0; curr_polygon < solvable_objects.size(); /* nothing */)
     {
 	bool optimized = false;
-	z3::set_param("timeout", solver_configuration.optimization_timeout.c_str());
-	    
-	z3::context z_context;
-	z3::solver z_solver(z_context);
+	if (!solver_configuration.incremental_solving)
+	{
+	    z_solver = z3::solver(z_context);
+	    warm_half_box = BoundingBox();
+	    warm_half_polygon = Polygon();
+	}
+	z_solver.push();
 	
 	z3::expr_vector local_dec_vars_X(z_context);
 	z3::expr_vector local_dec_vars_Y(z_context);
@@ -11726,6 +11810,7 @@ bool optimize_SubglobalConsequentialPolygonNonoverlappingBinaryCentered(const So
 											  z_context,
 											  solver_configuration,
 											  inner_half_polygon,
+											  warm_half_polygon,
 											  local_dec_vars_X,
 											  local_dec_vars_Y,
 											  local_dec_vars_T,
@@ -11750,6 +11835,7 @@ bool optimize_SubglobalConsequentialPolygonNonoverlappingBinaryCentered(const So
 											  z_context,
 											  solver_configuration,
 											  inner_half_box,
+											  warm_half_box,
 											  local_dec_vars_X,
 											  local_dec_vars_Y,
 											  local_dec_vars_T,
@@ -11849,6 +11935,7 @@ bool optimize_SubglobalConsequentialPolygonNonoverlappingBinaryCentered(const So
 		return true;		   
 	    }
 	}
+	z_solver.pop();
     }
     for (; curr_polygon < solvable_objects.size(); ++curr_polygon)
     {
@@ -17,9 +17,12 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <map>
+#include <algorithm>
 
 #include "libslic3r/Polygon.hpp"
 #include "libslic3r/ExPolygon.hpp"
+#include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Geometry/ConvexHull.hpp"
 #include "libslic3r/SVG.hpp"
 
@@ -1247,6 +1250,80 @@ TEST_CASE("Interface test 6", "[Sequential Arrangement Interface]")
 }
 
 
+TEST_CASE("Interface test 7", "[Sequential Arrangement Interface]")
+//void interface_test_7(void)
+{
+    INFO("Testing interface 7 ...");
+
+    /* A small scene solved in several groups. Both with the incremental
+       solver and with a fresh solver for each group, every object has to be
+       scheduled exactly once, the plates have to be sequentially printable
+       and the objects on a plate must not overlap. The arrangements of the
+       two settings may differ. */
+    SolverConfiguration solver_configuration;
+    solver_configuration.decimation_precision = SEQ_DECIMATION_PRECISION_LOW;
+    solver_configuration.object_group_size = 2;
+
+    std::vector<ObjectToPrint> objects_to_print = load_exported_data_from_text(arrange_data_export_text);
+    REQUIRE(objects_to_print.size() >= 6);
+    objects_to_print.resize(6);
+
+    PrinterGeometry printer_geometry;
+    int result = load_printer_geometry_from_text(printer_geometry_mk4_compatibility_text, printer_geometry);
+    REQUIRE(result == 0);
+    solver_configuration.setup(printer_geometry);
+
+    for (bool incremental_solving : {true, false})
+    {
+	solver_configuration.incremental_solving = incremental_solving;
+	std::vector<ScheduledPlate> scheduled_plates = schedule_ObjectsForSequentialPrint(solver_configuration,
+											printer_geometry,
+											objects_to_print);
+	std::map<int, int> scheduled_counts;
+	for (const auto &scheduled_plate : scheduled_plates)
+	{
+	    const std::vector<ScheduledObject> &scheduled_objects = scheduled_plate.scheduled_objects;
+
+	    std::vector<Slic3r::Polygon> footprints;
+	    for (const auto &scheduled_object : scheduled_objects)
+	    {
+		++scheduled_counts[scheduled_object.id];
+
+		auto object = std::find_if(objects_to_print.begin(), objects_to_print.end(),
+					   [&scheduled_object](const ObjectToPrint &object) { return object.id == scheduled_object.id; });
+		REQUIRE(object != objects_to_print.end());
+
+		Slic3r::Polygon footprint = object->pgns_at_height[0].second;
+		footprint.translate(scheduled_object.x, scheduled_object.y);
+		footprints.push_back(footprint);
+	    }
+
+	    for (unsigned int i = 0; i < footprints.size(); ++i)
+	    {
+		for (unsigned int j = i + 1; j < footprints.size(); ++j)
+		{
+		    REQUIRE(Slic3r::intersection(footprints[i], footprints[j]).empty());
+		}
+	    }
+	}
+
+	REQUIRE(scheduled_counts.size() == objects_to_print.size());
+	for (const auto &scheduled_count : scheduled_counts)
+	{
+	    REQUIRE(scheduled_count.second == 1);
+	}
+
+	bool printable = check_ScheduledObjectsForSequentialPrintability(solver_configuration,
+									 printer_geometry,
+									 objects_to_print,
+									 scheduled_plates);
+	REQUIRE(printable);
+    }
+
+    INFO("Testing interface 7 ... finished");
+}
+
+
 /*----------------------------------------------------------------*/
 
 
@@ -5,6 +5,7 @@
 #ifndef PERFORMCSGMESHBOOLEANS_HPP
 #define PERFORMCSGMESHBOOLEANS_HPP
 
+#include <algorithm>
 #include <stack>
 #include <vector>
 
@@ -46,39 +47,74 @@ namespace detail_cgal {
 
 using MeshBoolean::cgal::CGALMeshPtr;
 
-inline void perform_csg(CSGType op, CGALMeshPtr &dst, CGALMeshPtr &src)
+// A CGAL mesh with a conservative estimate of its bounding box. The boxes are
+// used to skip the booleans which can not change the result.
+struct CGALOperand {
+    CGALMeshPtr   mesh;
+    BoundingBoxf3 bb;
+};
+
+inline bool may_intersect(const BoundingBoxf3 &a, const BoundingBoxf3 &b)
 {
-    if (!dst && op == CSGType::Union && src) {
-        dst = std::move(src);
-        return;
-    }
+    return a.defined && b.defined && a.inflated(EPSILON).intersects(b);
+}
+
+inline CGALOperand empty_operand()
+{
+    return {MeshBoolean::cgal::triangle_mesh_to_cgal(indexed_triangle_set{}), {}};
+}
 
-    if (!dst || !src)
-        return;
-
-    switch (op) {
-    case CSGType::Union:
-        MeshBoolean::cgal::plus(*dst, *src);
-        break;
-    case CSGType::Difference:
-        MeshBoolean::cgal::minus(*dst, *src);
-        break;
-    case CSGType::Intersection:
-        MeshBoolean::cgal::intersect(*dst, *src);
-        break;
+// Union of all the operands evaluated as a balanced tree. The pairs on one
+// level of the tree are independent and they are done in parallel, the pairs
+// with disjoint bounding boxes are only concatenated.
+inline CGALOperand union_all(std::vector<CGALOperand> &&operands)
+{
+    operands.erase(std::remove_if(operands.begin(), operands.end(),
+                                  [](const CGALOperand &o) {
+                                      return !o.mesh || MeshBoolean::cgal::empty(*o.mesh);
+                                  }),
+                   operands.end());
+
+    if (operands.empty())
+        return empty_operand();
+
+    while (operands.size() > 1) {
+        size_t npairs = operands.size() / 2;
+        execution::for_each(ex_tbb, size_t(0), npairs, [&operands](size_t i) {
+            CGALOperand &dst = operands[2 * i];
+            CGALOperand &src = operands[2 * i + 1];
+
+            if (may_intersect(dst.bb, src.bb))
+                MeshBoolean::cgal::plus(*dst.mesh, *src.mesh);
+            else
+                MeshBoolean::cgal::merge(*dst.mesh, *src.mesh);
+
+            dst.bb.merge(src.bb);
+            src.mesh.reset();
+        });
+
+        size_t n = 0;
+        for (size_t i = 0; i < operands.size(); i += 2)
+            operands[n++] = std::move(operands[i]);
+
+        operands.resize(n);
     }
+
+    return std::move(operands.front());
 }
 
 template<class Ex, class It>
-std::vector<CGALMeshPtr> get_cgalptrs(Ex policy, const Range<It> &csgrange)
+std::vector<CGALOperand> get_cgaloperands(Ex policy, const Range<It> &csgrange)
 {
-    std::vector<CGALMeshPtr> ret(csgrange.size());
+    std::vector<CGALOperand> ret(csgrange.size());
     execution::for_each(policy, size_t(0), csgrange.size(),
                         [&csgrange, &ret](size_t i) {
         auto it = csgrange.begin();
         std::advance(it, i);
         auto &csgpart = *it;
-        ret[i]        = get_cgalmesh(csgpart);
+        ret[i].mesh   = get_cgalmesh(csgpart);
+        if (ret[i].mesh)
+            ret[i].bb = MeshBoolean::cgal::bounding_box(*ret[i].mesh);
     });
 
     return ret;
@@ -87,53 +123,98 @@ std::vector<CGALMeshPtr> get_cgalptrs(Ex policy, const Range<It> &csgrange)
 } // namespace detail
 
 // Process the sequence of CSG parts with CGAL.
+//
+// Every part is converted to a CGAL mesh once, in parallel. Consecutive
+// unions are commutative, so they are only collected and evaluated as a
+// balanced tree when a different operation or the end of the current stack
+// frame comes. Differences and intersections with parts whose bounding boxes
+// do not touch the result so far are resolved without a boolean.
 template<class It>
 void perform_csgmesh_booleans(MeshBoolean::cgal::CGALMeshPtr &cgalm,
                               const Range<It>                &csgrange)
 {
-    using MeshBoolean::cgal::CGALMesh;
     using MeshBoolean::cgal::CGALMeshPtr;
     using namespace detail_cgal;
 
     struct Frame {
-        CSGType op; CGALMeshPtr cgalptr;
-        explicit Frame(CSGType csgop = CSGType::Union)
-            : op{csgop}
-            , cgalptr{MeshBoolean::cgal::triangle_mesh_to_cgal(indexed_triangle_set{})}
-        {}
+        CSGType op;
+
+        // Union of these is the result of the frame so far.
+        std::vector<CGALOperand> unions;
+
+        explicit Frame(CSGType csgop = CSGType::Union) : op{csgop} {}
+
+        CGALOperand &flush()
+        {
+            if (unions.size() != 1) {
+                CGALOperand res = union_all(std::move(unions));
+                unions.clear();
+                unions.emplace_back(std::move(res));
+            }
+
+            return unions.front();
+        }
+
+        void apply(CSGType csgop, CGALOperand &&src)
+        {
+            if (!src.mesh)
+                return;
+
+            if (csgop == CSGType::Union) {
+                unions.emplace_back(std::move(src));
+                return;
+            }
+
+            CGALOperand &dst = flush();
+            bool overlap = may_intersect(dst.bb, src.bb);
+
+            switch (csgop) {
+            case CSGType::Difference:
+                if (overlap)
+                    MeshBoolean::cgal::minus(*dst.mesh, *src.mesh);
+                break;
+            case CSGType::Intersection:
+                if (overlap)
+                    MeshBoolean::cgal::intersect(*dst.mesh, *src.mesh);
+                else
+                    dst = empty_operand();
+                break;
+            default:;
+            }
+        }
     };
 
     std::stack opstack{std::vector<Frame>{}};
 
     opstack.push(Frame{});
 
-    std::vector<CGALMeshPtr> cgalmeshes = get_cgalptrs(ex_tbb, csgrange);
+    std::vector<CGALOperand> operands = get_cgaloperands(ex_tbb, csgrange);
 
     size_t csgidx = 0;
     for (auto &csgpart : csgrange) {
 
         auto op = get_operation(csgpart);
-        CGALMeshPtr &cgalptr = cgalmeshes[csgidx++];
+        CGALOperand &operand = operands[csgidx++];
 
+        // The part opening a frame is united with the frame, its operation
+        // is applied to the whole frame when it is popped, the same way as
+        // csg::slice_csgmesh_ex() does.
         if (get_stack_operation(csgpart) == CSGStackOp::Push) {
             opstack.push(Frame{op});
             op = CSGType::Union;
         }
 
-        Frame *top = &opstack.top();
-
-        perform_csg(get_operation(csgpart), top->cgalptr, cgalptr);
+        opstack.top().apply(op, std::move(operand));
 
         if (get_stack_operation(csgpart) == CSGStackOp::Pop) {
-            CGALMeshPtr src = std::move(top->cgalptr);
+            CGALOperand src = std::move(opstack.top().flush());
             auto popop = opstack.top().op;
             opstack.pop();
-            CGALMeshPtr &dst = opstack.top().cgalptr;
-            perform_csg(popop, dst, src);
+            opstack.top().apply(popop, std::move(src));
         }
     }
 
-    cgalm = std::move(opstack.top().cgalptr);
+    cgalm = std::move(opstack.top().flush().mesh);
 }
 
 // Check if all requirements for doing mesh booleans are met by the input csgrange.
@@ -7,6 +7,8 @@
 
 #include "CSGMesh.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <stack>
 
 #include "libslic3r/TriangleMeshSlicer.hpp"
@@ -17,40 +19,85 @@ namespace Slic3r { namespace csg {
 
 namespace detail {
 
-inline void merge_slices(csg::CSGType op, size_t i,
-                  std::vector<ExPolygons> &target,
-                  std::vector<ExPolygons> &source)
+// Slices of one CSG part on the layers [first, first + slices.size()) of the
+// slice grid. The other layers do not intersect the part.
+struct PartSlices
+{
+    size_t                  first = 0;
+    std::vector<ExPolygons> slices;
+
+    ExPolygons *at(size_t layer)
+    {
+        return layer >= first && layer - first < slices.size() ? &slices[layer - first] : nullptr;
+    }
+};
+
+// Slice the part only on the layers spanned by its transformed mesh.
+template<class CSGPartT>
+PartSlices slice_csgpart(const CSGPartT                &csgpart,
+                         const std::vector<float>      &slicegrid,
+                         const MeshSlicingParamsEx     &params,
+                         const std::function<void()>   &throw_on_cancel)
+{
+    PartSlices ret;
+
+    const indexed_triangle_set *its = csg::get_mesh(csgpart);
+    if (!its || its->empty())
+        return ret;
+
+    MeshSlicingParamsEx params_cpy = params;
+    params_cpy.trafo = params.trafo * csg::get_transform(csgpart).template cast<double>();
+
+    double zmin = std::numeric_limits<double>::max();
+    double zmax = std::numeric_limits<double>::lowest();
+    for (const Vec3f &v : its->vertices) {
+        double z = (params_cpy.trafo * v.cast<double>()).z();
+        zmin = std::min(zmin, z);
+        zmax = std::max(zmax, z);
+    }
+
+    auto from = std::lower_bound(slicegrid.begin(), slicegrid.end(), zmin);
+    auto to   = std::upper_bound(from, slicegrid.end(), zmax);
+    if (from == to)
+        return ret;
+
+    ret.first  = size_t(from - slicegrid.begin());
+    ret.slices = slice_mesh_ex(*its, std::vector<float>(from, to), params_cpy, throw_on_cancel);
+
+    assert(ret.slices.size() == size_t(to - from));
+
+    return ret;
+}
+
+inline void merge_slices(csg::CSGType op, ExPolygons &target, ExPolygons *source)
 {
     switch(op) {
     case CSGType::Union:
-        for (ExPolygon &expoly : source[i])
-            target[i].emplace_back(std::move(expoly));
+        if (source)
+            for (ExPolygon &expoly : *source)
+                target.emplace_back(std::move(expoly));
         break;
     case CSGType::Difference:
-        target[i] = diff_ex(target[i], source[i]);
+        if (source && !source->empty() && !target.empty())
+            target = diff_ex(target, *source);
         break;
     case CSGType::Intersection:
-        target[i] = intersection_ex(target[i], source[i]);
+        if (source && !source->empty())
+            target = intersection_ex(target, *source);
+        else
+            target.clear();
         break;
     }
 }
 
-inline void collect_nonempty_indices(csg::CSGType                   op,
-                              const std::vector<float>      &slicegrid,
-                              const std::vector<ExPolygons> &slices,
-                              std::vector<size_t>           &indices)
-{
-    indices.clear();
-    for (size_t i = 0; i < slicegrid.size(); ++i) {
-        if (op == CSGType::Intersection || !slices[i].empty())
-            indices.emplace_back(i);
-    }
-}
-
 } // namespace detail
 
 // Slice the input csgrange and return the corresponding layers as a vector of ExPolygons.
 // All boolean operations are performed on the 2D slices.
+//
+// The parts are sliced in parallel, each only on the layers it spans, then
+// the whole CSG expression is evaluated on every layer independently, also in
+// parallel. No 3D boolean is needed.
 template<class ItCSG>
 std::vector<ExPolygons> slice_csgmesh_ex(
     const Range<ItCSG>          &csgrange,
@@ -60,65 +107,50 @@ std::vector<ExPolygons> slice_csgmesh_ex(
 {
     using namespace detail;
 
-    struct Frame { CSGType op; std::vector<ExPolygons> slices; };
-
-    std::stack opstack{std::vector<Frame>{}};
-
-    MeshSlicingParamsEx params_cpy = params;
-    auto trafo = params.trafo;
-    auto nonempty_indices = reserve_vector<size_t>(slicegrid.size());
+    assert(std::is_sorted(slicegrid.begin(), slicegrid.end()));
 
-    opstack.push({CSGType::Union, std::vector<ExPolygons>(slicegrid.size())});
+    std::vector<PartSlices> partslices(csgrange.size());
+    execution::for_each(ex_tbb, size_t(0), csgrange.size(),
+                        [&csgrange, &partslices, &slicegrid, &params, &throw_on_cancel](size_t i) {
+        auto it = csgrange.begin();
+        std::advance(it, i);
+        partslices[i] = slice_csgpart(*it, slicegrid, params, throw_on_cancel);
+    });
 
-    for (const auto &csgpart : csgrange) {
-        const indexed_triangle_set *its = csg::get_mesh(csgpart);
+    throw_on_cancel();
 
-        auto op = get_operation(csgpart);
+    std::vector<ExPolygons> ret(slicegrid.size());
 
-        if (get_stack_operation(csgpart) == CSGStackOp::Push) {
-            opstack.push({op, std::vector<ExPolygons>(slicegrid.size())});
-            op = CSGType::Union;
-        }
+    execution::for_each(ex_tbb, size_t(0), slicegrid.size(),
+                        [&csgrange, &partslices, &ret](size_t layer) {
+        struct Frame { CSGType op; ExPolygons slice; };
 
-        Frame *top = &opstack.top();
+        // Every layer owns its slices of the parts, they can be moved.
+        std::stack opstack{std::vector<Frame>{}};
+        opstack.push({CSGType::Union, {}});
 
-        if (its) {
-            params_cpy.trafo = trafo * csg::get_transform(csgpart).template cast<double>();
-            std::vector<ExPolygons> slices = slice_mesh_ex(*its,
-                                                           slicegrid, params_cpy,
-                                                           throw_on_cancel);
+        size_t partidx = 0;
+        for (const auto &csgpart : csgrange) {
+            auto op = get_operation(csgpart);
 
-            assert(slices.size() == slicegrid.size());
+            if (get_stack_operation(csgpart) == CSGStackOp::Push) {
+                opstack.push({op, {}});
+                op = CSGType::Union;
+            }
 
-            collect_nonempty_indices(op, slicegrid, slices, nonempty_indices);
+            merge_slices(op, opstack.top().slice, partslices[partidx++].at(layer));
 
-            execution::for_each(
-                ex_tbb, nonempty_indices.begin(), nonempty_indices.end(),
-                [op, &slices, &top](size_t i) {
-                    merge_slices(op, i, top->slices, slices);
-                }, execution::max_concurrency(ex_tbb));
+            if (get_stack_operation(csgpart) == CSGStackOp::Pop) {
+                ExPolygons popslice = std::move(opstack.top().slice);
+                auto popop = opstack.top().op;
+                opstack.pop();
+                merge_slices(popop, opstack.top().slice, &popslice);
+            }
         }
 
-        if (get_stack_operation(csgpart) == CSGStackOp::Pop) {
-            std::vector<ExPolygons> popslices = std::move(top->slices);
-            auto popop = opstack.top().op;
-            opstack.pop();
-            std::vector<ExPolygons> &prev_slices = opstack.top().slices;
-
-            collect_nonempty_indices(popop, slicegrid, popslices, nonempty_indices);
-
-            execution::for_each(
-                ex_tbb, nonempty_indices.begin(), nonempty_indices.end(),
-                [&popslices, &prev_slices, popop](size_t i) {
-                    merge_slices(popop, i, prev_slices, popslices);
-                }, execution::max_concurrency(ex_tbb));
-        }
-    }
-
-    std::vector<ExPolygons> ret = std::move(opstack.top().slices);
+        ExPolygons &slice = opstack.top().slice;
 
-    // TODO: verify if this part can be omitted or not.
-    execution::for_each(ex_tbb, ret.begin(), ret.end(), [](ExPolygons &slice) {
+        // TODO: verify if this part can be omitted or not.
         auto it = std::remove_if(slice.begin(), slice.end(), [](const ExPolygon &p){
             return p.area() < double(SCALED_EPSILON) * double(SCALED_EPSILON);
         });
@@ -126,7 +158,7 @@ std::vector<ExPolygons> slice_csgmesh_ex(
         // Hopefully, ExPolygons are moved, not copied to new positions
         // and that is cheap for expolygons
         slice.erase(it, slice.end());
-        slice = union_ex(slice);
+        ret[layer] = union_ex(slice);
     }, execution::max_concurrency(ex_tbb));
 
     return ret;
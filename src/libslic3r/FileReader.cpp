@@ -216,12 +216,24 @@ static int removed_objects_with_zero_volume(Model& model)
     return removed;
 }
 
+// Cheap equivalent of !model.mesh().empty(), which would merge all the instances of all the objects.
+static bool has_printable_mesh(const Model& model)
+{
+    for (const ModelObject* obj : model.objects)
+        if (!obj->instances.empty())
+            for (const ModelVolume* vol : obj->volumes)
+                if (vol->is_model_part() && !vol->mesh().empty())
+                    return true;
+    return false;
+}
+
 Model load_model(const std::string& input_file,
                  LoadAttributes options/* = LoadAttribute::AddDefaultInstances*/, 
                  LoadStats* stats/*= nullptr*/,
                  std::optional<std::pair<double, double>> step_deflections/* = std::nullopt*/)
 {
     Model model = read_model_from_file(input_file, options, step_deflections);
+    ModelProcessing::share_identical_meshes(model);
 
     for (auto obj : model.objects)
         if (obj->name.empty())
@@ -249,8 +261,9 @@ Model load_model_with_config(const std::string& input_file,
                              FullSpectrum::FullSpectrumConfig* out_fs_config)
 {
     Model model = read_all_from_file(input_file, config, config_substitutions, prusaslicer_generator_version, options, out_fs_config);
+    ModelProcessing::share_identical_meshes(model);
 
-    if (stats && !model.mesh().empty()) {
+    if (stats && has_printable_mesh(model)) {
         stats->deleted_objects_cnt          = removed_objects_with_zero_volume(model);
         stats->looks_like_multipart_object  = looks_like_multipart_object(model);
     }
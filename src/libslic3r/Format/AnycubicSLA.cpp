@@ -22,6 +22,7 @@
 
 #include "libslic3r/GCode/ThumbnailData.hpp"
 #include "libslic3r/SLA/RasterBase.hpp"
+#include "libslic3r/SLA/SpanRaster.hpp"
 #include "libslic3r/SLAPrint.hpp"
 #include "LocalesUtils.hpp"
 #include "libslic3r/Config.hpp"
@@ -46,24 +47,51 @@
 #define PREV_H 168
 #define PREV_DPI 42
 
-#define LAYER_SIZE_ESTIMATE (32 * 1024)
-
 namespace Slic3r {
 
-static void anycubicsla_get_pixel_span(const std::uint8_t* ptr, const std::uint8_t* end,
-                               std::uint8_t& pixel, size_t& span_len)
+// Builds the RLE layer image from runs of pixels in row-major order. Only the
+// upper 4 bits of a pixel are kept. Fully transparent or fully opaque runs take
+// two bytes (12 bit length), antialiased runs take one byte (4 bit length).
+class AnycubicSLARunWriter
 {
-    size_t max_len;
-
-    span_len = 0;
-    pixel = (*ptr) & 0xF0;
-    // the maximum length of the span depends on the pixel color
-    max_len = (pixel == 0 || pixel == 0xF0) ? 0xFFF : 0xF;
-    while (ptr < end && span_len < max_len && ((*ptr) & 0xF0) == pixel) {
-        span_len++;
-        ptr++;
+    std::vector<uint8_t> m_dst;
+    std::uint8_t         m_pixel = 0;
+    size_t               m_len   = 0;
+
+    void flush()
+    {
+        // the maximum length of the span depends on the pixel color
+        const bool   solid   = m_pixel == 0 || m_pixel == 0xF0;
+        const size_t max_len = solid ? 0xFFF : 0xF;
+        while (m_len > 0) {
+            size_t span_len = std::min(m_len, max_len);
+            if (solid) {
+                m_dst.emplace_back(std::uint8_t(m_pixel | (span_len >> 8)));
+                m_dst.emplace_back(std::uint8_t(span_len & 0xFF));
+            } else {
+                m_dst.emplace_back(std::uint8_t(m_pixel | span_len));
+            }
+            m_len -= span_len;
+        }
     }
-}
+
+public:
+    void push(std::uint8_t value, size_t len)
+    {
+        std::uint8_t pixel = value & 0xF0;
+        if (pixel != m_pixel) {
+            flush();
+            m_pixel = pixel;
+        }
+        m_len += len;
+    }
+
+    sla::EncodedRaster finish()
+    {
+        flush();
+        return sla::EncodedRaster(std::move(m_dst), "pwimg");
+    }
+};
 
 struct AnycubicSLARasterEncoder
 {
@@ -72,32 +100,14 @@ struct AnycubicSLARasterEncoder
                                   size_t      h,
                                   size_t      num_components)
     {
-        std::vector<uint8_t> dst;
-        size_t               span_len;
-        std::uint8_t         pixel;
-        auto                 size = w * h * num_components;
-        dst.reserve(size);
+        AnycubicSLARunWriter writer;
 
         const std::uint8_t *src = reinterpret_cast<const std::uint8_t *>(ptr);
-        const std::uint8_t *src_end = src + size;
-        while (src < src_end) {
-            anycubicsla_get_pixel_span(src, src_end, pixel, span_len);
-            src += span_len;
-            // fully transparent of fully opaque pixel
-            if (pixel == 0 || pixel == 0xF0) {
-                pixel = pixel | (span_len >> 8);
-                std::copy(&pixel, (&pixel) + 1, std::back_inserter(dst));
-                pixel = span_len & 0xFF;
-                std::copy(&pixel, (&pixel) + 1, std::back_inserter(dst));
-            }
-            // antialiased pixel
-            else {
-                pixel = pixel | span_len;
-                std::copy(&pixel, (&pixel) + 1, std::back_inserter(dst));
-            }
-        }
+        const std::uint8_t *src_end = src + w * h * num_components;
+        for (; src < src_end; ++src)
+            writer.push(*src, 1);
 
-        return sla::EncodedRaster(std::move(dst), "pwimg");
+        return writer.finish();
     }
 };
 
@@ -412,7 +422,7 @@ std::unique_ptr<sla::RasterBase> AnycubicSLAArchive::create_raster() const
 
     double gamma = m_cfg.gamma_correction.getFloat();
 
-    return sla::create_raster_grayscale_aa(res, pxdim, gamma, tr);
+    return sla::create_raster_grayscale_spans(res, pxdim, gamma, tr);
 }
 
 sla::RasterEncoder AnycubicSLAArchive::get_encoder() const
@@ -420,6 +430,15 @@ sla::RasterEncoder AnycubicSLAArchive::get_encoder() const
     return AnycubicSLARasterEncoder{};
 }
 
+sla::EncodedRaster AnycubicSLAArchive::encode_layer(const sla::RasterBase &rst) const
+{
+    // The image is built straight from the scanline spans of the raster.
+    AnycubicSLARunWriter writer;
+    rst.foreach_pixel_run([&writer](std::uint8_t value, size_t len) { writer.push(value, len); });
+
+    return writer.finish();
+}
+
 // Endian safe write of little endian 32bit ints
 static void anycubicsla_write_int32(std::ofstream &out, std::uint32_t val)
 {
@@ -513,14 +532,14 @@ void AnycubicSLAArchive::export_print(const std::string     fname,
                                const ThumbnailsList &thumbnails,
                                const std::string    &/*projectname*/)
 {
-    std::uint32_t layer_count = m_layers.size();
+    std::uint32_t layer_count = layer_num();
 
     anycubicsla_format_intro         intro = {};
     anycubicsla_format_header        header = {};
     anycubicsla_format_preview       preview = {};
     anycubicsla_format_layers_header layers_header = {};
     anycubicsla_format_misc          misc = {};
-    std::vector<uint8_t>      layer_images;
+    std::vector<anycubicsla_format_layer> layers;
     std::uint32_t             image_offset;
 
     assert(m_version == ANYCUBIC_SLA_FORMAT_VERSION_1);
@@ -550,13 +569,18 @@ void AnycubicSLAArchive::export_print(const std::string     fname,
         layers_header.layer_count = layer_count;
         anycubicsla_write_layers_header(out, layers_header);
 
-        //layers
-        layer_images.reserve(layer_count * LAYER_SIZE_ESTIMATE);
+        // The layer table precedes the images, but the image sizes are only
+        // known once the layers are encoded. Reserve the table with zeros,
+        // stream the images right behind it and fill the table in afterwards,
+        // so that no more than a few encoded layers are held in memory.
+        const std::streampos layer_table_pos = out.tellp();
+        layers.assign(layer_count, anycubicsla_format_layer{});
+        for (anycubicsla_format_layer &l : layers)
+            anycubicsla_write_layer(out, l);
+
         image_offset = intro.image_data_offset;
-        size_t i = 0;
-        for (const sla::EncodedRaster &rst : m_layers) {
-            anycubicsla_format_layer l;
-            std::memset(&l, 0, sizeof(l));
+        foreach_layer([&](const sla::EncodedRaster &rst, size_t i) {
+            anycubicsla_format_layer &l = layers[i];
             l.image_offset = image_offset;
             l.image_size = rst.size();
             if (i < header.bottom_layer_count) {
@@ -571,15 +595,13 @@ void AnycubicSLAArchive::export_print(const std::string     fname,
                 l.lift_speed_mms = header.lift_speed_mms;
             }
             image_offset += l.image_size;
+            // write the rle encoded layer image
+            out.write(reinterpret_cast<const char*>(rst.data()), rst.size());
+        });
+
+        out.seekp(layer_table_pos);
+        for (anycubicsla_format_layer &l : layers)
             anycubicsla_write_layer(out, l);
-            // add the rle encoded layer image into the buffer
-            const char* img_start = reinterpret_cast<const char*>(rst.data());
-            const char* img_end = img_start + rst.size();
-            std::copy(img_start, img_end, std::back_inserter(layer_images));
-            i++;
-        }
-        const char* img_buffer = reinterpret_cast<const char*>(layer_images.data());
-        out.write(img_buffer, layer_images.size());
         out.close();
     } catch(std::exception& e) {
         BOOST_LOG_TRIVIAL(error) << e.what();
@@ -529,7 +529,7 @@ std::unique_ptr<sla::RasterBase> SL1Archive::create_raster() const
 
 sla::RasterEncoder SL1Archive::get_encoder() const
 {
-    return sla::PNGRasterEncoder{};
+    return sla::PNGRasterEncoder{m_cfg.sla_archive_compression.getInt()};
 }
 
 static void write_thumbnail(Zipper &zipper, const ThumbnailData &data)
@@ -576,14 +576,12 @@ void SL1Archive::export_print(Zipper               &zipper,
         zipper.add_entry("config.json");
         zipper << to_json(print, iniconf);
 
-        size_t i = 0;
-        for (const sla::EncodedRaster &rst : m_layers) {
-
-            std::string imgname = project + string_printf("%.5d", i++) + "." +
+        foreach_layer([&zipper, &project](const sla::EncodedRaster &rst, size_t i) {
+            std::string imgname = project + string_printf("%.5d", int(i)) + "." +
                                   rst.extension();
 
             zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
-        }
+        });
 
         for (const ThumbnailData& data : thumbnails)
             if (data.is_valid())
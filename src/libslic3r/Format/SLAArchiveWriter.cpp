@@ -6,8 +6,22 @@
 #include "SLAArchiveWriter.hpp"
 
 #include "SLAArchiveFormatRegistry.hpp"
+#include "libslic3r/PrintBase.hpp"
 #include "libslic3r/PrintConfig.hpp"
 
+#include <algorithm>
+#include <utility>
+
+#include <tbb/version.h>
+#include <tbb/task_arena.h>
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
 std::unique_ptr<SLAArchiveWriter>
@@ -22,4 +36,51 @@ SLAArchiveWriter::create(const std::string &archtype, const SLAPrinterConfig &cf
     return ret;
 }
 
+void SLAArchiveWriter::foreach_layer(const LayerFn &fn) const
+{
+    if (! m_deferred_drawfn) {
+        for (size_t idx = 0; idx < m_layers.size(); ++idx)
+            fn(m_layers[idx], idx);
+
+        return;
+    }
+
+    using EncodedLayer = std::pair<size_t, sla::EncodedRaster>;
+
+    // Number of layers being rasterized or waiting for the writer. This is
+    // what bounds the memory, the writer is usually faster than the encoders.
+    const size_t max_layers_in_flight =
+        2 * size_t(std::max(1, tbb::this_task_arena::max_concurrency()));
+
+    size_t next_idx = 0;
+    bool   canceled = false;
+
+    const auto producer = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &next_idx, &canceled](tbb::flow_control &fc) -> size_t {
+            if (next_idx < m_deferred_layer_num && m_deferred_cancelfn())
+                canceled = true;
+            if (canceled || next_idx >= m_deferred_layer_num) {
+                fc.stop();
+                return 0;
+            }
+            return next_idx++;
+        });
+
+    const auto rasterizer = tbb::make_filter<size_t, EncodedLayer>(slic3r_tbb_filtermode::parallel,
+        [this](size_t idx) {
+            auto rst = create_raster();
+            m_deferred_drawfn(*rst, idx);
+            return EncodedLayer{idx, encode_layer(*rst)};
+        });
+
+    const auto writer = tbb::make_filter<EncodedLayer, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&fn](const EncodedLayer &layer) { fn(layer.second, layer.first); });
+
+    tbb::parallel_pipeline(max_layers_in_flight, producer & rasterizer & writer);
+
+    // Do not let the writer finish an archive with missing layers.
+    if (canceled)
+        throw CanceledException();
+}
+
 } // namespace Slic3r
@@ -10,6 +10,7 @@
 #include <memory>
 #include <string>
 #include <cstddef>
+#include <functional>
 
 #include "libslic3r/SLA/RasterBase.hpp"
 #include "libslic3r/Execution/ExecutionTBB.hpp"
@@ -22,12 +23,42 @@ class SLAPrint;
 class SLAPrinterConfig;
 
 class SLAArchiveWriter {
+public:
+    using DrawFn = std::function<void(sla::RasterBase &raster, size_t lyrid)>;
+    using LayerFn = std::function<void(const sla::EncodedRaster &rst, size_t lyrid)>;
+    using CancelFn = std::function<bool()>;
+
 protected:
     std::vector<sla::EncodedRaster> m_layers;
 
+    // Deferred mode (see defer_layers()): the layers are rasterized only
+    // while the archive is being written.
+    size_t   m_deferred_layer_num = 0;
+    DrawFn   m_deferred_drawfn;
+    CancelFn m_deferred_cancelfn;
+
     virtual std::unique_ptr<sla::RasterBase> create_raster() const = 0;
     virtual sla::RasterEncoder get_encoder() const = 0;
 
+    // Formats which can be written without a bitmap (see
+    // sla::RasterBase::foreach_pixel_run()) may override this.
+    virtual sla::EncodedRaster encode_layer(const sla::RasterBase &rst) const
+    {
+        return rst.encode(get_encoder());
+    }
+
+    size_t layer_num() const
+    {
+        return m_deferred_drawfn ? m_deferred_layer_num : m_layers.size();
+    }
+
+    // Call fn for every layer in ascending order of layer index. In deferred
+    // mode the layers are rasterized and encoded in parallel, but only a
+    // bounded number of encoded layers is alive at any time, thus the peak
+    // memory does not depend on the number of layers. Throws
+    // CanceledException if the deferred rasterization was canceled.
+    void foreach_layer(const LayerFn &fn) const;
+
 public:
     virtual ~SLAArchiveWriter() = default;
 
@@ -39,6 +70,10 @@ public:
         CancelFn cancelfn = []() { return false; },
         const EP & ep       = {})
     {
+        m_deferred_drawfn    = {};
+        m_deferred_cancelfn  = {};
+        m_deferred_layer_num = 0;
+
         m_layers.resize(layer_num);
         execution::for_each(
             ep, size_t(0), m_layers.size(),
@@ -48,11 +83,27 @@ public:
                 sla::EncodedRaster &enc = m_layers[idx];
                 auto                rst = create_raster();
                 drawfn(*rst, idx);
-                enc = rst->encode(get_encoder());
+                enc = encode_layer(*rst);
             },
             execution::max_concurrency(ep));
     }
 
+    // Alternative to draw_layers() for prints that would not fit into memory
+    // once rasterized: only the draw function is stored and it will be called
+    // from export_print(). drawfn has to be thread safe and it should own the
+    // data it draws, as the print may change before the export. cancelfn is
+    // checked before each layer is rasterized.
+    void defer_layers(
+        size_t   layer_num,
+        DrawFn   drawfn,
+        CancelFn cancelfn = []() { return false; })
+    {
+        m_layers             = {};
+        m_deferred_layer_num = layer_num;
+        m_deferred_drawfn    = std::move(drawfn);
+        m_deferred_cancelfn  = std::move(cancelfn);
+    }
+
     // Export the print into an archive using the provided filename.
     virtual void export_print(const std::string     fname,
                               const SLAPrint       &print,
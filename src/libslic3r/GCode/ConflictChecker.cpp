@@ -6,8 +6,8 @@
 #include "ConflictChecker.hpp"
 
 #include <oneapi/tbb/blocked_range.h>
-#include <oneapi/tbb/concurrent_vector.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <atomic>
 #include <map>
 #include <functional>
 #include <cmath>
@@ -237,6 +237,15 @@ LineWithIDs LinesBucketQueue::getCurLines() const
     return lines;
 }
 
+LinesBucketPiles LinesBucketQueue::getCurPiles() const
+{
+    LinesBucketPiles piles;
+    for (const LinesBucket &bucket : _buckets)
+        if (bucket.valid())
+            piles.push_back({ &bucket, bucket.curPileIdx() });
+    return piles;
+}
+
 void getExtrusionPathsFromEntity(const ExtrusionEntityCollection *entity, ExtrusionPaths &paths)
 {
     std::function<void(const ExtrusionEntityCollection *, ExtrusionPaths &)> getExtrusionPathImpl = [&](const ExtrusionEntityCollection *entity, ExtrusionPaths &paths) {
@@ -286,20 +295,70 @@ std::pair<std::vector<ExtrusionPaths>, std::vector<ExtrusionPaths>> getAllLayers
 ConflictComputeOpt ConflictChecker::find_inter_of_lines(const LineWithIDs &lines)
 {
     using namespace RasterizationImpl;
-    std::map<IndexPair, std::vector<int>> indexToLine;
 
+    // Lines of a single object instance never conflict with each other. Group the lines by their instance
+    // and calculate bounding boxes of the instances.
+    std::map<std::pair<int, int>, int> ownerIdx;
+    std::vector<int>                   lineOwner(lines.size());
+    std::vector<BoundingBox>           ownerBBoxes;
     for (int i = 0; i < (int)lines.size(); ++i) {
-        const LineWithID &l1      = lines[i];
-        auto              indexes = line_rasterization(l1._line);
-        for (auto index : indexes) {
-            const auto &possibleIntersectIdxs = indexToLine[index];
-            for (auto possibleIntersectIdx : possibleIntersectIdxs) {
-                const LineWithID &l2 = lines[possibleIntersectIdx];
-                if (auto interRes = line_intersect(l1, l2); interRes.has_value()) { return interRes; }
+        const LineWithID &l = lines[i];
+        auto [it, inserted] = ownerIdx.try_emplace(std::make_pair(l._obj_id, l._inst_id), int(ownerBBoxes.size()));
+        if (inserted)
+            ownerBBoxes.emplace_back();
+        lineOwner[i] = it->second;
+        ownerBBoxes[it->second].merge(l._line.a);
+        ownerBBoxes[it->second].merge(l._line.b);
+    }
+    if (ownerBBoxes.size() < 2)
+        return {};
+
+    // Sweep over the instances sorted by their minimum x and collect the regions, where an instance
+    // overlaps with another instance. Lines outside of these regions cannot conflict.
+    std::vector<BoundingBox> ownerOverlaps(ownerBBoxes.size());
+    {
+        std::vector<int> sorted(ownerBBoxes.size());
+        for (int i = 0; i < (int)sorted.size(); ++i)
+            sorted[i] = i;
+        std::sort(sorted.begin(), sorted.end(), [&ownerBBoxes](int l, int r) { return ownerBBoxes[l].min.x() < ownerBBoxes[r].min.x(); });
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            const BoundingBox &bbox1 = ownerBBoxes[sorted[i]];
+            for (size_t j = i + 1; j < sorted.size() && ownerBBoxes[sorted[j]].min.x() <= bbox1.max.x(); ++j) {
+                const BoundingBox &bbox2 = ownerBBoxes[sorted[j]];
+                if (bbox1.overlap(bbox2)) {
+                    BoundingBox overlap(bbox1.min.cwiseMax(bbox2.min), bbox1.max.cwiseMin(bbox2.max));
+                    ownerOverlaps[sorted[i]].merge(overlap);
+                    ownerOverlaps[sorted[j]].merge(overlap);
+                }
             }
-            indexToLine[index].push_back(i);
         }
     }
+
+    // Spatial hash of the lines: pairs of (grid cell, line index) sorted by the grid cell.
+    std::vector<std::pair<IndexPair, int>> cells;
+    for (int i = 0; i < (int)lines.size(); ++i) {
+        const BoundingBox &overlap = ownerOverlaps[lineOwner[i]];
+        const Line        &line    = lines[i]._line;
+        if (! overlap.defined ||
+            std::max(line.a.x(), line.b.x()) < overlap.min.x() || std::min(line.a.x(), line.b.x()) > overlap.max.x() ||
+            std::max(line.a.y(), line.b.y()) < overlap.min.y() || std::min(line.a.y(), line.b.y()) > overlap.max.y())
+            continue;
+        for (const IndexPair &index : line_rasterization(line))
+            cells.emplace_back(index, i);
+    }
+    std::sort(cells.begin(), cells.end());
+
+    for (size_t begin = 0; begin < cells.size();) {
+        size_t end = begin + 1;
+        while (end < cells.size() && cells[end].first == cells[begin].first)
+            ++end;
+        for (size_t i = begin; i < end; ++i)
+            for (size_t j = i + 1; j < end; ++j)
+                if (lineOwner[cells[i].second] != lineOwner[cells[j].second])
+                    if (auto interRes = line_intersect(lines[cells[i].second], lines[cells[j].second]); interRes.has_value())
+                        return interRes;
+        begin = end;
+    }
     return {};
 }
 
@@ -336,37 +395,39 @@ ConflictResultOpt ConflictChecker::find_inter_of_lines_in_diff_objs(SpanOfConstP
     }
     conflictQueue.build_queue();
 
-    std::vector<LineWithIDs> layersLines;
-    std::vector<double>      heights;
+    // Only remember which extrusions are printed at which height, the lines are generated layer by layer while checking.
+    std::vector<LinesBucketPiles> layersPiles;
+    std::vector<double>           heights;
     while (conflictQueue.valid()) {
-        LineWithIDs lines     = conflictQueue.getCurLines();
-        double      curHeight = conflictQueue.removeLowests();
+        LinesBucketPiles piles     = conflictQueue.getCurPiles();
+        double           curHeight = conflictQueue.removeLowests();
         heights.push_back(curHeight);
-        layersLines.push_back(std::move(lines));
+        layersPiles.push_back(std::move(piles));
     }
 
-    bool                                   find = false;
-    tbb::concurrent_vector<std::pair<ConflictComputeResult,double>> conflict;
-
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersLines.size()), [&](tbb::blocked_range<size_t> range) {
-        for (size_t i = range.begin(); i < range.end(); i++) {
-            auto interRes = find_inter_of_lines(layersLines[i]);
-            if (interRes.has_value()) {
-                find = true;
-                conflict.emplace_back(*interRes, heights[i]);
+    // Only the lowest conflict is reported, layers above an already found conflict are not checked.
+    std::atomic<size_t>             firstConflictLayer{ layersPiles.size() };
+    std::vector<ConflictComputeOpt> conflicts(layersPiles.size());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersPiles.size()), [&](tbb::blocked_range<size_t> range) {
+        LineWithIDs lines;
+        for (size_t i = range.begin(); i < range.end() && i < firstConflictLayer.load(std::memory_order_relaxed); i++) {
+            lines.clear();
+            for (const LinesBucketPile &pile : layersPiles[i])
+                pile.bucket->append_pile_lines(pile.pileIdx, lines);
+            if (conflicts[i] = find_inter_of_lines(lines); conflicts[i].has_value()) {
+                size_t first = firstConflictLayer.load();
+                while (i < first && ! firstConflictLayer.compare_exchange_weak(first, i))
+                    ;
                 break;
             }
         }
     });
 
-    if (find) {
-        std::sort(conflict.begin(), conflict.end(), [](const std::pair<ConflictComputeResult, double>& i1, const std::pair<ConflictComputeResult, double>& i2) {
-            return i1.second < i2.second;
-        });
-
-        const void *ptr1           = conflictQueue.idToObjsPtr(conflict[0].first._obj1);
-        const void *ptr2           = conflictQueue.idToObjsPtr(conflict[0].first._obj2);
-        double      conflictHeight = conflict[0].second;
+    if (size_t layerIdx = firstConflictLayer.load(); layerIdx < layersPiles.size()) {
+        const void *ptr1           = conflictQueue.idToObjsPtr(conflicts[layerIdx]->_obj1);
+        const void *ptr2           = conflictQueue.idToObjsPtr(conflicts[layerIdx]->_obj2);
+        double      conflictHeight = heights[layerIdx];
         if (ptr1 == &wtptr || ptr2 == &wtptr) {
             assert(! wipe_tower_data.z_and_depth_pairs.empty());
             if (ptr2 == &wtptr) { std::swap(ptr1, ptr2); }
@@ -61,10 +61,17 @@ public:
         }
     }
     double      curHeight() const { return _curHeight; }
-    LineWithIDs curLines() const
+    unsigned    curPileIdx() const { return _curPileIdx; }
+    LineWithIDs curLines() const { return pileLines(_curPileIdx); }
+    LineWithIDs pileLines(unsigned pileIdx) const
     {
         LineWithIDs lines;
-        for (const ExtrusionPath &path : _piles[_curPileIdx]) {
+        append_pile_lines(pileIdx, lines);
+        return lines;
+    }
+    void append_pile_lines(unsigned pileIdx, LineWithIDs &lines) const
+    {
+        for (const ExtrusionPath &path : _piles[pileIdx]) {
             Polyline check_polyline;
             for (int i = 0; i < (int)_offsets.size(); ++i) {
                 check_polyline = path.polyline;
@@ -73,7 +80,6 @@ public:
                 for (const Line& line : tmpLines) { lines.emplace_back(line, _id, i, path.role()); }
             }
         }
-        return lines;
     }
 
     friend bool operator>(const LinesBucket &left, const LinesBucket &right) { return left._curHeight > right._curHeight; }
@@ -81,6 +87,15 @@ public:
     friend bool operator==(const LinesBucket &left, const LinesBucket &right) { return left._curHeight == right._curHeight; }
 };
 
+// Extrusions of a single bucket at a single height, lines of which are only generated when the layer is being checked.
+struct LinesBucketPile
+{
+    const LinesBucket *bucket;
+    unsigned           pileIdx;
+};
+
+using LinesBucketPiles = std::vector<LinesBucketPile>;
+
 struct LinesBucketPtrComp
 {
     bool operator()(const LinesBucket *left, const LinesBucket *right) { return *left > *right; }
@@ -107,6 +122,7 @@ public:
     }
     double      removeLowests();
     LineWithIDs getCurLines() const;
+    LinesBucketPiles getCurPiles() const;
 };
 
 void getExtrusionPathsFromEntity(const ExtrusionEntityCollection *entity, ExtrusionPaths &paths);
@@ -133,6 +149,7 @@ using ConflictObjName = std::optional<std::pair<std::string, std::string>>;
 struct ConflictChecker
 {
     static ConflictResultOpt  find_inter_of_lines_in_diff_objs(SpanOfConstPtrs<PrintObject> objs, const WipeTowerData& wtd);
+    // Lines of a single layer are hashed into a uniform grid, only lines of instances with overlapping bounding boxes are tested.
     static ConflictComputeOpt find_inter_of_lines(const LineWithIDs &lines);
     static ConflictComputeOpt line_intersect(const LineWithID &l1, const LineWithID &l2);
 };
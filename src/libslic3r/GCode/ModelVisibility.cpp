@@ -306,4 +306,62 @@ float Visibility::calculate_point_visibility(const Vec3f &position) const {
     return total_visibility / total_weight;
 }
 
+bool VisibilityCache::matches(
+    const Transform3d &obj_transform,
+    const ModelVolumePtrs &volumes,
+    const Visibility::Params &params
+) const {
+    if (!m_visibility || !(m_params == params) || !(m_obj_transform.matrix() == obj_transform.matrix()))
+        return false;
+
+    auto it_key = m_volumes.begin();
+    for (const ModelVolume *model_volume : volumes) {
+        if (model_volume->type() != ModelVolumeType::MODEL_PART
+                && model_volume->type() != ModelVolumeType::NEGATIVE_VOLUME)
+            continue;
+        if (it_key == m_volumes.end() || it_key->type != model_volume->type()
+                || it_key->mesh.lock() != model_volume->mesh_ptr()
+                || !(it_key->matrix.matrix() == model_volume->get_matrix().matrix()))
+            return false;
+        ++it_key;
+    }
+    return it_key == m_volumes.end();
+}
+
+std::shared_ptr<const Visibility> VisibilityCache::get(
+    const Transform3d &obj_transform,
+    const ModelVolumePtrs &volumes,
+    const Visibility::Params &params,
+    const std::function<void(void)> &throw_if_canceled
+) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (this->matches(obj_transform, volumes, params)) {
+        BOOST_LOG_TRIVIAL(debug) << "SeamPlacer: reusing cached mesh visibility";
+        return m_visibility;
+    }
+
+    // Release the old samples before calculating the new ones.
+    this->clear_unlocked();
+    auto visibility = std::make_shared<const Visibility>(obj_transform, volumes, params, throw_if_canceled);
+
+    m_obj_transform = obj_transform;
+    for (const ModelVolume *model_volume : volumes)
+        if (model_volume->type() == ModelVolumeType::MODEL_PART
+                || model_volume->type() == ModelVolumeType::NEGATIVE_VOLUME)
+            m_volumes.push_back({model_volume->mesh_ptr(), model_volume->type(), model_volume->get_matrix()});
+    m_params = params;
+    m_visibility = std::move(visibility);
+    return m_visibility;
+}
+
+void VisibilityCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->clear_unlocked();
+}
+
+void VisibilityCache::clear_unlocked() {
+    m_visibility.reset();
+    m_volumes.clear();
+}
+
 }
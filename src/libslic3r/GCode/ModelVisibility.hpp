@@ -5,6 +5,8 @@
 #include <functional>
 #include <vector>
 #include <cstddef>
+#include <memory>
+#include <mutex>
 
 #include "libslic3r/KDTreeIndirect.hpp"
 #include "libslic3r/Point.hpp"
@@ -34,6 +36,12 @@ struct Visibility
         size_t fast_decimation_triangle_count_target{};
         // square of number of rays per sample point
         size_t sqr_rays_per_sample_point{};
+
+        bool operator==(const Params &other) const {
+            return raycasting_visibility_samples_count == other.raycasting_visibility_samples_count &&
+                fast_decimation_triangle_count_target == other.fast_decimation_triangle_count_target &&
+                sqr_rays_per_sample_point == other.sqr_rays_per_sample_point;
+        }
     };
 
     Visibility(
@@ -42,6 +50,9 @@ struct Visibility
         const Params &params,
         const std::function<void(void)> &throw_if_canceled
     );
+    // The KD tree references mesh_samples, thus the object must stay in place.
+    Visibility(const Visibility &) = delete;
+    Visibility &operator=(const Visibility &) = delete;
 
     TriangleSetSamples mesh_samples;
     std::vector<float> mesh_samples_visibility;
@@ -52,5 +63,43 @@ struct Visibility
     float calculate_point_visibility(const Vec3f &position) const;
 };
 
+// Keeps the visibility of an object between G-code exports. The visibility is only recalculated
+// if the meshes of the object, their transformations or the visibility parameters change,
+// thus changing non-geometry settings (speeds, temperatures...) does not pay for the raycasting again.
+class VisibilityCache
+{
+public:
+    std::shared_ptr<const Visibility> get(
+        const Transform3d &obj_transform,
+        const ModelVolumePtrs &volumes,
+        const Visibility::Params &params,
+        const std::function<void(void)> &throw_if_canceled
+    );
+    void clear();
+
+private:
+    struct VolumeKey
+    {
+        // Weak pointer to the mesh, so that the cache does not keep a replaced mesh alive,
+        // while it still detects the mesh being replaced by another one allocated at the same address.
+        std::weak_ptr<const TriangleMesh> mesh;
+        ModelVolumeType type;
+        Transform3d matrix;
+    };
+
+    bool matches(
+        const Transform3d &obj_transform,
+        const ModelVolumePtrs &volumes,
+        const Visibility::Params &params
+    ) const;
+    void clear_unlocked();
+
+    std::mutex m_mutex;
+    Transform3d m_obj_transform{Transform3d::Identity()};
+    std::vector<VolumeKey> m_volumes;
+    Visibility::Params m_params;
+    std::shared_ptr<const Visibility> m_visibility;
+};
+
 } // namespace Slic3r::ModelInfo
 #endif // libslic3r_ModelVisibility_hpp_
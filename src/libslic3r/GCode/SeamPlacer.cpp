@@ -78,11 +78,11 @@ ObjectSeams precalculate_seams(
             const Transform3d transformation{print_object->trafo_centered()};
             const ModelVolumePtrs &volumes{print_object->model_object()->volumes};
 
-            Slic3r::ModelInfo::Visibility
-                points_visibility{transformation, volumes, params.visibility, throw_if_canceled};
+            const std::shared_ptr<const Slic3r::ModelInfo::Visibility> points_visibility{
+                print_object->seam_visibility_cache().get(transformation, volumes, params.visibility, throw_if_canceled)};
             throw_if_canceled();
             const Aligned::VisibilityCalculator visibility_calculator{
-                points_visibility, params.convex_visibility_modifier,
+                *points_visibility, params.convex_visibility_modifier,
                 params.concave_visibility_modifier};
 
             Shells::Shells<> shells{Shells::create_shells(std::move(layer_perimeters), params.max_distance)};
@@ -79,10 +79,12 @@ void VoronoiDiagram::clear()
         m_edges.clear();
         m_cells.clear();
         m_is_modified = false;
-    } else {
-        m_voronoi_diagram.clear();
     }
 
+    // Boost Voronoi builder appends into the output diagram, so the original
+    // diagram has to be emptied even when a repaired copy was used.
+    m_voronoi_diagram.clear();
+
     m_state      = State::UNKNOWN;
     m_issue_type = IssueType::UNKNOWN;
 }
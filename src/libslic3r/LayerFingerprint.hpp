@@ -0,0 +1,88 @@
+///|/ Copyright (c) Prusa Research 2025
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef SRC_LIBSLIC3R_LAYERFINGERPRINT_HPP_
+#define SRC_LIBSLIC3R_LAYERFINGERPRINT_HPP_
+
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "libslic3r/Point.hpp"
+#include "libslic3r/Polygon.hpp"
+#include "libslic3r/ExPolygon.hpp"
+
+namespace Slic3r {
+
+// Identity of everything a generator reads from a layer. Generators which keep checkpoints of their state
+// (SupportSpotsGenerator, sla::generate_support_points) compare the fingerprints of the last run with the current ones
+// and resume from the last checkpoint below the first changed layer.
+// Besides the hash, cheap values are compared, so that a hash collision alone is not enough to reuse a changed layer.
+struct LayerFingerprint
+{
+    size_t hash{};
+    double print_z{};
+    size_t parts_count{};
+    // Sum of the areas of the layer parts [in scaled mm^2]
+    double area{};
+
+    bool operator==(const LayerFingerprint &rhs) const
+    {
+        return hash == rhs.hash && print_z == rhs.print_z && parts_count == rhs.parts_count && area == rhs.area;
+    }
+    bool operator!=(const LayerFingerprint &rhs) const { return !(*this == rhs); }
+};
+
+inline void hash_combine_points(size_t &seed, const Points &points)
+{
+    boost::hash_combine(seed, points.size());
+    for (const Point &p : points) {
+        boost::hash_combine(seed, p.x());
+        boost::hash_combine(seed, p.y());
+    }
+}
+
+inline void hash_combine_expolygon(size_t &seed, const ExPolygon &shape)
+{
+    hash_combine_points(seed, shape.contour.points);
+    boost::hash_combine(seed, shape.holes.size());
+    for (const Polygon &hole : shape.holes)
+        hash_combine_points(seed, hole.points);
+}
+
+// Index of the first of layers [begin, end) whose fingerprint differs from the one of the last run, end if none differs.
+// Layers missing in the last run are changed.
+inline size_t first_changed_layer(const std::vector<LayerFingerprint> &fingerprints,
+                                  const std::vector<LayerFingerprint> &last_fingerprints,
+                                  size_t                               begin,
+                                  size_t                               end)
+{
+    const size_t count = std::min(end, last_fingerprints.size());
+    if (begin >= count)
+        return begin;
+    return std::mismatch(fingerprints.begin() + begin, fingerprints.begin() + count, last_fingerprints.begin() + begin).first -
+           fingerprints.begin();
+}
+
+// Checkpoint of the state is stored before processing of each checkpoint_step-th layer,
+// except of the layer the processing started from, its checkpoint is already stored.
+inline bool is_checkpoint_layer(size_t layer_idx, size_t first_layer_idx, size_t checkpoint_step)
+{
+    return layer_idx > first_layer_idx && layer_idx % checkpoint_step == 0;
+}
+
+// Drop checkpoints stored above the first changed layer, the checkpoints are sorted by the index of their layer.
+template<typename Checkpoints, typename LayerIdxFn>
+void drop_checkpoints_above(Checkpoints &checkpoints, size_t first_changed_layer_idx, LayerIdxFn &&layer_idx_fn)
+{
+    checkpoints.erase(std::find_if(checkpoints.begin(), checkpoints.end(),
+                                   [&](const auto &checkpoint) { return layer_idx_fn(checkpoint) > first_changed_layer_idx; }),
+                      checkpoints.end());
+}
+
+} // namespace Slic3r
+
+#endif /* SRC_LIBSLIC3R_LAYERFINGERPRINT_HPP_ */
@@ -19,6 +19,7 @@
 
 // CGAL headers
 #include <CGAL/Polygon_mesh_processing/corefinement.h>
+#include <CGAL/Polygon_mesh_processing/bbox.h>
 #include <CGAL/Exact_integer.h>
 #include <CGAL/Surface_mesh.h>
 #include <CGAL/Cartesian_converter.h>
@@ -333,6 +334,21 @@ CGALMeshPtr clone(const CGALMesh &m)
     return CGALMeshPtr{new CGALMesh{m}};
 }
 
+BoundingBoxf3 bounding_box(const CGALMesh &mesh)
+{
+    if (mesh.m.is_empty())
+        return {};
+
+    CGAL::Bbox_3 bb = CGALProc::bbox(mesh.m);
+
+    return {Vec3d{bb.xmin(), bb.ymin(), bb.zmin()}, Vec3d{bb.xmax(), bb.ymax(), bb.zmax()}};
+}
+
+void merge(CGALMesh &A, const CGALMesh &B)
+{
+    A.m.join(B.m);
+}
+
 } // namespace cgal
 
 } // namespace MeshBoolean
@@ -74,6 +74,12 @@ bool does_self_intersect(const CGALMesh &mesh);
 bool does_bound_a_volume(const CGALMesh &mesh);
 bool empty(const CGALMesh &mesh);
 
+BoundingBoxf3 bounding_box(const CGALMesh &mesh);
+
+// Append B to A without any boolean. The result is the union of the two only
+// if their volumes do not intersect, e.g. if their bounding boxes are disjoint.
+void merge(CGALMesh &A, const CGALMesh &B);
+
 }
 
 } // namespace MeshBoolean
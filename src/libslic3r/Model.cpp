@@ -1374,6 +1374,7 @@ void ModelVolume::center_geometry_after_creation(bool update_source_offset)
     Vec3d shift = this->mesh().bounding_box().center();
     if (!shift.isApprox(Vec3d::Zero()))
     {
+        this->unshare_mesh();
     	if (m_mesh)
         	const_cast<TriangleMesh*>(m_mesh.get())->translate(-(float)shift(0), -(float)shift(1), -(float)shift(2));
         if (m_convex_hull)
@@ -1385,6 +1386,22 @@ void ModelVolume::center_geometry_after_creation(bool update_source_offset)
         source.mesh_offset = shift;
 }
 
+void ModelVolume::share_mesh(const ModelVolume &other)
+{
+    assert(this->mesh().its.vertices == other.mesh().its.vertices && this->mesh().its.indices == other.mesh().its.indices);
+    m_mesh = other.m_mesh;
+    if (other.m_convex_hull)
+        m_convex_hull = other.m_convex_hull;
+}
+
+void ModelVolume::unshare_mesh()
+{
+    if (m_mesh.use_count() > 1)
+        m_mesh = std::make_shared<const TriangleMesh>(*m_mesh);
+    if (m_convex_hull.use_count() > 1)
+        m_convex_hull = std::make_shared<const TriangleMesh>(*m_convex_hull);
+}
+
 void ModelVolume::calculate_convex_hull()
 {
     m_convex_hull = std::make_shared<TriangleMesh>(this->mesh().convex_hull_3d());
@@ -1493,9 +1510,9 @@ void ModelVolume::mirror(Axis axis)
     set_mirror(mirror);
 }
 
-// This method could only be called before the meshes of this ModelVolumes are not shared!
 void ModelVolume::scale_geometry_after_creation(const Vec3f& versor)
 {
+    this->unshare_mesh();
 	const_cast<TriangleMesh*>(m_mesh.get())->scale(versor);
 	const_cast<TriangleMesh*>(m_convex_hull.get())->scale(versor);
 }
@@ -1591,6 +1608,21 @@ indexed_triangle_set_with_color FacetsAnnotation::get_all_facets_strict_with_col
     return selector.get_all_facets_strict_with_colors();
 }
 
+std::vector<indexed_triangle_set> FacetsAnnotation::get_facets_strict_per_state(const ModelVolume &mv, size_t num_states) const {
+    if (this->empty()) {
+        // Nothing is painted, all facets are of the NONE state.
+        std::vector<indexed_triangle_set> out(num_states);
+        if (num_states > 0)
+            out[size_t(TriangleStateType::NONE)] = mv.mesh().its;
+        return out;
+    }
+
+    TriangleSelector selector(mv.mesh());
+    // Reset of TriangleSelector is done inside TriangleSelector's constructor, so we don't need it to perform it again in deserialize().
+    selector.deserialize(m_data, false);
+    return selector.get_facets_strict_per_state(num_states);
+}
+
 bool FacetsAnnotation::has_facets(const ModelVolume &mv, TriangleStateType type) const {
     return TriangleSelector::has_facets(m_data, type);
 }
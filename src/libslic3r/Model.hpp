@@ -697,6 +697,8 @@ public:
     indexed_triangle_set get_facets_strict(const ModelVolume &mv, TriangleStateType type) const;
     indexed_triangle_set_with_color get_all_facets_with_colors(const ModelVolume &mv) const;
     indexed_triangle_set_with_color get_all_facets_strict_with_colors(const ModelVolume &mv) const;
+    // Facets of the states [0, num_states), one mesh per state, deserializing the painting only once.
+    std::vector<indexed_triangle_set> get_facets_strict_per_state(const ModelVolume &mv, size_t num_states) const;
     bool has_facets(const ModelVolume &mv, TriangleStateType type) const;
     bool empty() const { return m_data.triangles_to_split.empty(); }
 
@@ -814,6 +816,8 @@ public:
     void                set_mesh(std::unique_ptr<const TriangleMesh> &&mesh) { m_mesh = std::move(mesh); }
 	void				reset_mesh() { m_mesh = std::make_shared<const TriangleMesh>(); }
     const std::shared_ptr<const TriangleMesh>& get_mesh_shared_ptr() const { return m_mesh; }
+    // Reference the mesh and the convex hull of another volume with an equal mesh instead of an own copy.
+    void                share_mesh(const ModelVolume &other);
     // Configuration parameters specific to an object model geometry or a modifier volume, 
     // overriding the global Slic3r settings and the ModelObject settings.
     ModelConfigObject	config;
@@ -872,12 +876,12 @@ public:
     void                rotate(double angle, const Vec3d& axis);
     void                mirror(Axis axis);
 
-    // This method could only be called before the meshes of this ModelVolumes are not shared!
+    // Scales the mesh and the convex hull in place, a shared mesh is copied first.
     void                scale_geometry_after_creation(const Vec3f &versor);
     void                scale_geometry_after_creation(const float scale) { this->scale_geometry_after_creation(Vec3f(scale, scale, scale)); }
 
     // Translates the mesh and the convex hull so that the origin of their vertices is in the center of this volume's bounding box.
-    // Attention! This method may only be called just after ModelVolume creation! It must not be called once the TriangleMesh of this ModelVolume is shared!
+    // Attention! This method may only be called just after ModelVolume creation! A shared mesh is copied first.
     void                center_geometry_after_creation(bool update_source_offset = true);
 
     void                calculate_convex_hull();
@@ -958,6 +962,10 @@ protected:
     void     transform_this_mesh(const Matrix3d& m, bool fix_left_handed);
 
 private:
+    // The mesh and the convex hull may be shared with other volumes, with the Print or with the Undo / Redo stack.
+    // Copy them if they are shared, before they are modified in place.
+    void     unshare_mesh();
+
     // Parent object owning this ModelVolume.
     ModelObject*                    	object;
     // The triangular model.
@@ -14,6 +14,9 @@
 #include "Model.hpp"
 #include "ModelProcessing.hpp"
 
+#include <string_view>
+#include <unordered_map>
+
 #include <boost/filesystem.hpp>
 #include <boost/log/trivial.hpp>
 
@@ -398,4 +401,48 @@ void merge(ModelObject* object)
         return;
 }
 
+static size_t mesh_content_hash(const TriangleMesh& mesh)
+{
+    const indexed_triangle_set& its = mesh.its;
+    size_t hv = std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(its.vertices.data()), its.vertices.size() * sizeof(stl_vertex)));
+    size_t hi = std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(its.indices.data()), its.indices.size() * sizeof(stl_triangle_vertex_indices)));
+    return hv ^ (hi + 0x9e3779b9 + (hv << 6) + (hv >> 2));
+}
+
+size_t share_identical_meshes(Model& model)
+{
+    // The first volume found with each mesh, by the hash of the mesh content.
+    std::unordered_multimap<size_t, const ModelVolume*> unique_volumes;
+    size_t shared = 0;
+
+    for (ModelObject* object : model.objects)
+        for (ModelVolume* volume : object->volumes) {
+            const TriangleMesh& mesh = volume->mesh();
+            if (mesh.empty())
+                continue;
+
+            size_t hash  = mesh_content_hash(mesh);
+            auto   range = unique_volumes.equal_range(hash);
+            auto   it    = std::find_if(range.first, range.second, [&mesh](const auto& kvp) {
+                const TriangleMesh& other = kvp.second->mesh();
+                return &other == &mesh ||
+                       (other.its.vertices == mesh.its.vertices && other.its.indices == mesh.its.indices &&
+                        // The repair statistics are shown to the user per volume.
+                        other.stats().repaired_errors == mesh.stats().repaired_errors);
+            });
+
+            if (it == range.second)
+                unique_volumes.emplace(hash, volume);
+            else if (&it->second->mesh() != &mesh) {
+                volume->share_mesh(*it->second);
+                ++ shared;
+            }
+        }
+
+    if (shared > 0)
+        BOOST_LOG_TRIVIAL(debug) << "share_identical_meshes: " << shared << " volumes share a mesh with another volume";
+
+    return shared;
+}
+
 }
@@ -57,6 +57,11 @@ namespace ModelProcessing
 
     void    split(ModelObject* object, std::vector<ModelObject*>* new_objects);
     void    merge(ModelObject* object);
+
+    // Let the volumes with equal meshes reference a single TriangleMesh, for example the copies of a part
+    // loaded from a project file. The meshes are immutable, they are copied only when modified in place.
+    // Return the number of volumes which released their own mesh.
+    size_t  share_identical_meshes(Model& model);
 }
 
 } // namespace Slic3r::ModelProcessing
@@ -63,6 +63,8 @@ const constexpr double MM_SEGMENTATION_MAX_PROJECTION_DISTANCE_SCALED = scaled<d
 const constexpr double MM_SEGMENTATION_MAX_SNAP_DISTANCE_SCALED       = scaled<double>(0.01);
 const constexpr double MM_SEGMENTATION_SNAP_ANGLE_THRESHOLD           = PI / 12.;
 const constexpr double MM_SEGMENTATION_SNAP_ANGLE_MAX_DISTANCE_SCALED = scaled<double>(0.1);
+// Number of layers whose sliced ColorPolygons are kept in memory at once during the segmentation.
+const constexpr size_t MM_SEGMENTATION_LAYERS_PER_BATCH               = 256;
 
 enum VD_ANNOTATION : Voronoi::VD::cell_type::color_type {
     VERTEX_ON_CONTOUR = 1,
@@ -881,9 +883,12 @@ static inline std::vector<std::vector<ExPolygons>> segmentation_top_and_bottom_l
     if (max_top_layers > 0 || max_bottom_layers > 0) {
         for (const ModelVolume *mv : print_object.model_object()->volumes)
             if (mv->is_model_part()) {
-                const Transform3d volume_trafo = object_trafo * mv->get_matrix();
+                const Transform3d                       volume_trafo      = object_trafo * mv->get_matrix();
+                const std::vector<indexed_triangle_set> painted_per_state = extract_facets_info(*mv).facets_annotation.get_facets_strict_per_state(*mv, num_facets_states);
+                // The painted patches contain just their own vertices, test the whole volume.
+                const bool                              volume_sinking    = !zs.empty() && is_volume_sinking(mv->mesh().its, volume_trafo);
                 for (size_t extruder_idx = 0; extruder_idx < num_facets_states; ++extruder_idx) {
-                    const indexed_triangle_set painted = extract_facets_info(*mv).facets_annotation.get_facets_strict(*mv, TriangleStateType(extruder_idx));
+                    const indexed_triangle_set &painted = painted_per_state[extruder_idx];
 
                     if constexpr (MM_SEGMENTATION_DEBUG_TOP_BOTTOM) {
                         its_write_obj(painted, debug_out_path("mm-painted-patch-%d.obj", extruder_idx).c_str());
@@ -891,7 +896,7 @@ static inline std::vector<std::vector<ExPolygons>> segmentation_top_and_bottom_l
 
                     if (! painted.indices.empty()) {
                         std::vector<Polygons> top, bottom;
-                        if (!zs.empty() && is_volume_sinking(painted, volume_trafo)) {
+                        if (volume_sinking) {
                             std::vector<float> zs_sinking = {0.f};
                             Slic3r::append(zs_sinking, zs);
                             slice_mesh_slabs(painted, zs_sinking, volume_trafo, max_top_layers > 0 ? &top : nullptr, max_bottom_layers > 0 ? &bottom : nullptr, throw_on_cancel_callback);
@@ -1995,11 +2000,21 @@ static void update_color_changes_using_color_projection_ranges(ColorProjectionEx
     }
 }
 
-static std::vector<ColorPolygons> slice_model_volume_with_color(const ModelVolume                                              &model_volume,
-                                                               const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
-                                                               const std::vector<float>                                        &layer_zs,
-                                                               const PrintObject                                               &print_object,
-                                                               const size_t                                                     num_facets_states)
+// Mesh of a model volume with the painted colors, extracted once and sliced batch by batch.
+struct ModelVolumeMeshWithColor
+{
+    indexed_triangle_set_with_color mesh;
+    MeshSlicingParams               slicing_params;
+    // Facets of the mesh sliced by each batch of layers.
+    std::vector<std::vector<int>>   facets_per_batch;
+    // Extruder replacing the default painted color (TriangleStateType::NONE), or -1 if it is kept.
+    int                             default_color_replacement = -1;
+};
+
+static ModelVolumeMeshWithColor extract_model_volume_mesh_with_color(const ModelVolume                                              &model_volume,
+                                                                     const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
+                                                                     const std::vector<float>                                        &layer_zs,
+                                                                     const PrintObject                                               &print_object)
 {
     const ModelVolumeFacetsInfo facets_info = extract_facets_info(model_volume);
 
@@ -2012,17 +2027,29 @@ static std::vector<ColorPolygons> slice_model_volume_with_color(const ModelVolum
         return facets_info.facets_annotation.get_all_facets_strict_with_colors(model_volume);
     };
 
-    const indexed_triangle_set_with_color mesh_with_color = extract_mesh_with_color();
-    const Transform3d                     trafo           = print_object.trafo_centered() * model_volume.get_matrix();
-    const MeshSlicingParams               slicing_params{trafo};
+    ModelVolumeMeshWithColor out;
+    out.mesh                 = extract_mesh_with_color();
+    out.slicing_params.trafo = print_object.trafo_centered() * model_volume.get_matrix();
+    out.facets_per_batch     = facets_per_slicing_batch(out.mesh, layer_zs, MM_SEGMENTATION_LAYERS_PER_BATCH, out.slicing_params);
+
+    if (const int volume_extruder_id = model_volume.extruder_id(); facets_info.replace_default_extruder && facets_info.is_painted && volume_extruder_id > 0)
+        out.default_color_replacement = volume_extruder_id;
 
-    std::vector<ColorPolygons> color_polygons_per_layer = slice_mesh(mesh_with_color, layer_zs, slicing_params);
+    return out;
+}
+
+static std::vector<ColorPolygons> slice_model_volume_with_color(const ModelVolumeMeshWithColor &volume_mesh,
+                                                               const size_t                    batch_idx,
+                                                               const std::vector<float>       &batch_zs,
+                                                               const size_t                    num_facets_states)
+{
+    std::vector<ColorPolygons> color_polygons_per_layer = slice_mesh(volume_mesh.mesh, volume_mesh.facets_per_batch[batch_idx], batch_zs, volume_mesh.slicing_params);
 
     // Replace default painted color (TriangleStateType::NONE) with volume extruder.
-    if (const int volume_extruder_id = model_volume.extruder_id(); facets_info.replace_default_extruder && facets_info.is_painted && volume_extruder_id > 0) {
+    if (volume_mesh.default_color_replacement > 0) {
         for (ColorPolygons &color_polygons : color_polygons_per_layer) {
             for (ColorPolygon &color_polygon : color_polygons) {
-                std::replace(color_polygon.colors.begin(), color_polygon.colors.end(), static_cast<uint8_t>(TriangleStateType::NONE), static_cast<uint8_t>(volume_extruder_id));
+                std::replace(color_polygon.colors.begin(), color_polygon.colors.end(), static_cast<uint8_t>(TriangleStateType::NONE), static_cast<uint8_t>(volume_mesh.default_color_replacement));
             }
         }
     }
@@ -2124,116 +2151,71 @@ static size_t dominant_state_by_area(const std::vector<ExPolygons>& segments_by_
     return dominant_state;
 }
 
-std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject                                               &print_object,
-                                                              const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
-                                                              const size_t                                                     num_facets_states,
-                                                              const float                                                      segmentation_max_width,
-                                                              const float                                                      segmentation_interlocking_depth,
-                                                              const bool                                                       segmentation_interlocking_beam,
-                                                              const IncludeTopAndBottomLayers                                  include_top_and_bottom_layers,
-                                                              const std::function<void()>                                     &throw_on_cancel_callback)
+// Merge all regions of a layer and remove small holes.
+static ExPolygons preprocess_layer_slices(const Layer &layer)
 {
-    const size_t                                   num_layers    = print_object.layers().size();
-    const SpanOfConstPtrs<Layer>                   layers        = print_object.layers();
-
-    std::vector<ExPolygons>                input_expolygons(num_layers);
-    std::vector<ColorProjectionExPolygons> input_expolygons_projection_lines_layers(num_layers);
-    std::vector<std::vector<ColorLines>>   color_polygons_lines_layers(num_layers);
-
-    // Merge all regions and remove small holes
-    BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Slices preprocessing in parallel - Begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&layers, &input_expolygons, &input_expolygons_projection_lines_layers, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
-        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
-            throw_on_cancel_callback();
-
-            ExPolygons ex_polygons;
-            for (LayerRegion *region : layers[layer_idx]->regions()) {
-                for (const Surface &surface : region->slices()) {
-                    Slic3r::append(ex_polygons, offset_ex(surface.expolygon, float(10 * SCALED_EPSILON)));
-                }
-            }
-
-            // All expolygons are expanded by SCALED_EPSILON, merged, and then shrunk again by SCALED_EPSILON
-            // to ensure that very close polygons will be merged.
-            ex_polygons = union_ex(ex_polygons);
-            // Remove all expolygons and holes with an area less than 0.1mm^2
-            remove_small_and_small_holes(ex_polygons, Slic3r::sqr(POLYGON_FILTER_MIN_AREA_SCALED));
-            // Occasionally, some input polygons contained self-intersections that caused problems with Voronoi diagrams
-            // and consequently with the extraction of colored segments by function extract_colored_segments.
-            // Calling simplify_polygons removes these self-intersections.
-            // Also, occasionally input polygons contained several points very close together (distance between points is 1 or so).
-            // Such close points sometimes caused that the Voronoi diagram has self-intersecting edges around these vertices.
-            // This consequently leads to issues with the extraction of colored segments by function extract_colored_segments.
-            // Calling expolygons_simplify fixed these issues.
-            input_expolygons[layer_idx]                         = remove_duplicates(expolygons_simplify(offset_ex(ex_polygons, -10.f * float(SCALED_EPSILON)), 5 * SCALED_EPSILON), scaled<coord_t>(0.01), PI / 6);
-            input_expolygons_projection_lines_layers[layer_idx] = create_color_projection_expolygons(input_expolygons[layer_idx]);
-
-            if constexpr (MM_SEGMENTATION_DEBUG_INPUT) {
-                export_processed_input_expolygons_to_svg(debug_out_path("mm-input-%d.svg", layer_idx), layers[layer_idx]->regions(), input_expolygons[layer_idx]);
-            }
+    ExPolygons ex_polygons;
+    for (const LayerRegion *region : layer.regions()) {
+        for (const Surface &surface : region->slices()) {
+            Slic3r::append(ex_polygons, offset_ex(surface.expolygon, float(10 * SCALED_EPSILON)));
         }
-    }); // end of parallel_for
-    BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Slices preprocessing in parallel - End";
-
-    BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Slicing painted triangles - Begin";
-    const std::vector<float> layer_zs = get_print_object_layers_zs(layers);
-    for (const ModelVolume *mv : print_object.model_object()->volumes) {
-        std::vector<ColorPolygons> color_polygons_per_layer = slice_model_volume_with_color(*mv, extract_facets_info, layer_zs, print_object, num_facets_states);
-
-        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&color_polygons_per_layer, &color_polygons_lines_layers, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
-            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
-                throw_on_cancel_callback();
+    }
 
-                ColorPolygons &raw_color_polygons = color_polygons_per_layer[layer_idx];
-                filter_out_small_color_polygons(raw_color_polygons, POLYGON_FILTER_MIN_AREA_SCALED, POLYGON_FILTER_MIN_OFFSET_SCALED);
+    // All expolygons are expanded by SCALED_EPSILON, merged, and then shrunk again by SCALED_EPSILON
+    // to ensure that very close polygons will be merged.
+    ex_polygons = union_ex(ex_polygons);
+    // Remove all expolygons and holes with an area less than 0.1mm^2
+    remove_small_and_small_holes(ex_polygons, Slic3r::sqr(POLYGON_FILTER_MIN_AREA_SCALED));
+    // Occasionally, some input polygons contained self-intersections that caused problems with Voronoi diagrams
+    // and consequently with the extraction of colored segments by function extract_colored_segments.
+    // Calling simplify_polygons removes these self-intersections.
+    // Also, occasionally input polygons contained several points very close together (distance between points is 1 or so).
+    // Such close points sometimes caused that the Voronoi diagram has self-intersecting edges around these vertices.
+    // This consequently leads to issues with the extraction of colored segments by function extract_colored_segments.
+    // Calling expolygons_simplify fixed these issues.
+    return remove_duplicates(expolygons_simplify(offset_ex(ex_polygons, -10.f * float(SCALED_EPSILON)), 5 * SCALED_EPSILON), scaled<coord_t>(0.01), PI / 6);
+}
 
-                if (raw_color_polygons.empty())
-                    continue;
+// Filter ColorPolygons sliced from a single volume at a single layer and append them as ColorLines.
+static void append_filtered_color_lines(ColorPolygons &raw_color_polygons, std::vector<ColorLines> &color_polygons_lines)
+{
+    filter_out_small_color_polygons(raw_color_polygons, POLYGON_FILTER_MIN_AREA_SCALED, POLYGON_FILTER_MIN_OFFSET_SCALED);
 
-                // Convert ColorPolygons into the vector of ColorPoints to perform several filtrations that are performed on points.
-                color_polygons_lines_layers[layer_idx].reserve(color_polygons_lines_layers[layer_idx].size() + raw_color_polygons.size());
-                for (const ColorPoints &color_polygon_points : color_polygons_to_color_points(raw_color_polygons)) {
-                    ColorPoints color_polygon_points_filtered;
-                    color_polygon_points_filtered.reserve(color_polygon_points.size());
+    if (raw_color_polygons.empty())
+        return;
 
-                    douglas_peucker(color_polygon_points.begin(), color_polygon_points.end(), std::back_inserter(color_polygon_points_filtered), POLYGON_COLOR_FILTER_TOLERANCE_SCALED, POLYGON_COLOR_FILTER_DISTANCE_SCALED);
+    // Convert ColorPolygons into the vector of ColorPoints to perform several filtrations that are performed on points.
+    color_polygons_lines.reserve(color_polygons_lines.size() + raw_color_polygons.size());
+    for (const ColorPoints &color_polygon_points : color_polygons_to_color_points(raw_color_polygons)) {
+        ColorPoints color_polygon_points_filtered;
+        color_polygon_points_filtered.reserve(color_polygon_points.size());
 
-                    if (color_polygon_points_filtered.size() < 3)
-                        continue;
+        douglas_peucker(color_polygon_points.begin(), color_polygon_points.end(), std::back_inserter(color_polygon_points_filtered), POLYGON_COLOR_FILTER_TOLERANCE_SCALED, POLYGON_COLOR_FILTER_DISTANCE_SCALED);
 
-                    filter_color_of_small_segments(color_polygon_points_filtered, POLYGON_COLOR_FILTER_DISTANCE_SCALED);
-                    assert(is_valid_color_polygon_points(color_polygon_points_filtered));
+        if (color_polygon_points_filtered.size() < 3)
+            continue;
 
-                    color_polygons_lines_layers[layer_idx].emplace_back(color_points_to_color_lines(color_polygon_points_filtered));
-                }
-            }
-        }); // end of parallel_for
-    }
-    BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Slicing painted triangles - End";
+        filter_color_of_small_segments(color_polygon_points_filtered, POLYGON_COLOR_FILTER_DISTANCE_SCALED);
+        assert(is_valid_color_polygon_points(color_polygon_points_filtered));
 
-    if constexpr (MM_SEGMENTATION_DEBUG_FILTERED_COLOR_LINES) {
-        for (size_t layer_idx = 0; layer_idx < print_object.layers().size(); ++layer_idx) {
-            export_color_polygons_lines_to_svg(debug_out_path("mm-filtered-color-line-%d.svg", layer_idx), color_polygons_lines_layers[layer_idx], input_expolygons[layer_idx]);
-        }
+        color_polygons_lines.emplace_back(color_points_to_color_lines(color_polygon_points_filtered));
     }
+}
 
-    // Project sliced ColorPolygons on sliced layers (input_expolygons).
-    BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Projection of painted triangles - Begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&color_polygons_lines_layers, &input_expolygons_projection_lines_layers, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
-        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
-            throw_on_cancel_callback();
-
-            // For each ColorLine, find the nearest ColorProjectionLines and project the ColorLine on each ColorProjectionLine.
-            const AABBTreeLines::LinesDistancer<ColorProjectionLineWrapper> color_projection_lines_distancer{create_color_projection_lines_mapping(input_expolygons_projection_lines_layers[layer_idx])};
-            project_color_lines_on_color_projection_lines(color_polygons_lines_layers[layer_idx], color_projection_lines_distancer);
-
-            // For each ColorProjectionLine, find the nearest ColorLines and project them on the ColorProjectionLine.
-            const AABBTreeLines::LinesDistancer<ColorLine> color_lines_distancer{flatten_color_lines(color_polygons_lines_layers[layer_idx])};
-            project_color_projection_expolygons_on_color_lines(input_expolygons_projection_lines_layers[layer_idx], color_lines_distancer);
-        }
-    }); // end of parallel_for
-    BOOST_LOG_TRIVIAL(debug) << "MM segmentation - Projection of painted triangles - End";
+std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject                                               &print_object,
+                                                              const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
+                                                              const size_t                                                     num_facets_states,
+                                                              const float                                                      segmentation_max_width,
+                                                              const float                                                      segmentation_interlocking_depth,
+                                                              const bool                                                       segmentation_interlocking_beam,
+                                                              const IncludeTopAndBottomLayers                                  include_top_and_bottom_layers,
+                                                              const std::function<void()>                                     &throw_on_cancel_callback)
+{
+    const size_t                                   num_layers    = print_object.layers().size();
+    const SpanOfConstPtrs<Layer>                   layers        = print_object.layers();
 
+    const std::vector<float>              layer_zs = get_print_object_layers_zs(layers);
+    std::vector<ExPolygons>               input_expolygons(num_layers);
     std::vector<std::vector<ExPolygons>>  segmented_regions(num_layers);
     segmented_regions.assign(num_layers, std::vector<ExPolygons>(num_facets_states));
 
@@ -2248,79 +2230,135 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
         dominant_color_per_expolygon.resize(num_layers);
     }
 
+    // The layers are processed in batches of MM_SEGMENTATION_LAYERS_PER_BATCH, so the sliced ColorPolygons
+    // are kept in memory only for the layers of the current batch and not for the whole object.
+    // Within a batch, the slicer sweeps the painted triangles of each volume just once, emitting the colored segments into all layers of the batch.
+    // Then a single pass over the layers of the batch takes each layer from its slices up to its segmented regions.
+    // The ColorLines and ColorProjectionLines exist just for the layer being processed,
+    // and the sliced ColorPolygons of the layer are released as soon as they are converted into ColorLines.
     // Be aware that after the projection of the ColorPolygons and its postprocessing isn't
     // ensured that consistency of the color_prev. So, only color_next can be used.
+    // The painted mesh of each volume is extracted just once and its facets are sorted into the batches they are sliced by,
+    // so each batch slices only the facets crossing its layers.
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Layers segmentation in parallel - Begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&input_expolygons_projection_lines_layers, &segmented_regions, &input_expolygons, &num_facets_states, &dominant_color_per_expolygon, should_cut_segmented_layers, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
-        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+    std::vector<ModelVolumeMeshWithColor> volume_meshes;
+    volume_meshes.reserve(print_object.model_object()->volumes.size());
+    for (const ModelVolume *mv : print_object.model_object()->volumes) {
+        volume_meshes.emplace_back(extract_model_volume_mesh_with_color(*mv, extract_facets_info, layer_zs, print_object));
+        throw_on_cancel_callback();
+    }
+
+    for (size_t batch_begin = 0; batch_begin < num_layers; batch_begin += MM_SEGMENTATION_LAYERS_PER_BATCH) {
+        const size_t             batch_end = std::min(batch_begin + MM_SEGMENTATION_LAYERS_PER_BATCH, num_layers);
+        const size_t             batch_idx = batch_begin / MM_SEGMENTATION_LAYERS_PER_BATCH;
+        const std::vector<float> batch_zs(layer_zs.begin() + batch_begin, layer_zs.begin() + batch_end);
+
+        std::vector<std::vector<ColorPolygons>> color_polygons_per_volume;
+        color_polygons_per_volume.reserve(volume_meshes.size());
+        for (const ModelVolumeMeshWithColor &volume_mesh : volume_meshes) {
+            color_polygons_per_volume.emplace_back(slice_model_volume_with_color(volume_mesh, batch_idx, batch_zs, num_facets_states));
             throw_on_cancel_callback();
-            if (should_cut_segmented_layers) {
-                dominant_color_per_expolygon[layer_idx].assign(
-                    input_expolygons[layer_idx].size(),
-                    0
-                );
-            }
+        }
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(batch_begin, batch_end), [&layers, &color_polygons_per_volume, batch_begin, &segmented_regions, &input_expolygons, &num_facets_states, &dominant_color_per_expolygon, should_cut_segmented_layers, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+                throw_on_cancel_callback();
 
-            ColorProjectionExPolygons &input_expolygons_projection_lines = input_expolygons_projection_lines_layers[layer_idx];
-            for (ColorProjectionExPolygon &input_expolygon_projection_lines : input_expolygons_projection_lines) {
-                const size_t expolygon_idx = &input_expolygon_projection_lines - input_expolygons_projection_lines.data();
+                input_expolygons[layer_idx] = preprocess_layer_slices(*layers[layer_idx]);
+                ColorProjectionExPolygons input_expolygons_projection_lines = create_color_projection_expolygons(input_expolygons[layer_idx]);
 
-                if constexpr (MM_SEGMENTATION_DEBUG_COLOR_RANGES) {
-                    export_color_projection_lines_color_ranges_to_svg(debug_out_path("mm-color-ranges-%d-%d.svg", layer_idx, expolygon_idx), input_expolygon_projection_lines, input_expolygons[layer_idx]);
+                if constexpr (MM_SEGMENTATION_DEBUG_INPUT) {
+                    export_processed_input_expolygons_to_svg(debug_out_path("mm-input-%d.svg", layer_idx), layers[layer_idx]->regions(), input_expolygons[layer_idx]);
                 }
 
-                update_color_changes_using_color_projection_ranges(input_expolygon_projection_lines);
-                filter_projected_color_points_on_expolygon(input_expolygon_projection_lines);
+                std::vector<ColorLines> color_polygons_lines;
+                for (std::vector<ColorPolygons> &color_polygons_per_layer : color_polygons_per_volume) {
+                    ColorPolygons raw_color_polygons = std::move(color_polygons_per_layer[layer_idx - batch_begin]);
+                    append_filtered_color_lines(raw_color_polygons, color_polygons_lines);
+                }
 
-                std::vector<ColorPoints> color_polygons_points = convert_color_expolygon_projection_lines_to_color_points(input_expolygon_projection_lines);
-                if (color_polygons_points.empty())
-                    continue;
+                if constexpr (MM_SEGMENTATION_DEBUG_FILTERED_COLOR_LINES) {
+                    export_color_polygons_lines_to_svg(debug_out_path("mm-filtered-color-line-%d.svg", layer_idx), color_polygons_lines, input_expolygons[layer_idx]);
+                }
 
-                snap_projected_color_points_to_nearest_angles(color_polygons_points);
+                // Project sliced ColorPolygons on sliced layers (input_expolygons).
+                {
+                    // For each ColorLine, find the nearest ColorProjectionLines and project the ColorLine on each ColorProjectionLine.
+                    const AABBTreeLines::LinesDistancer<ColorProjectionLineWrapper> color_projection_lines_distancer{create_color_projection_lines_mapping(input_expolygons_projection_lines)};
+                    project_color_lines_on_color_projection_lines(color_polygons_lines, color_projection_lines_distancer);
 
-                if constexpr (MM_SEGMENTATION_DEBUG_COLORIZED_POLYGONS) {
-                    export_color_polygons_points_to_svg(debug_out_path("mm-projected-color_polygon-%d-%d.svg", layer_idx, expolygon_idx), color_polygons_points, input_expolygons[layer_idx]);
+                    // For each ColorProjectionLine, find the nearest ColorLines and project them on the ColorProjectionLine.
+                    const AABBTreeLines::LinesDistancer<ColorLine> color_lines_distancer{flatten_color_lines(color_polygons_lines)};
+                    project_color_projection_expolygons_on_color_lines(input_expolygons_projection_lines, color_lines_distancer);
                 }
 
-                const std::vector<ColoredLines> colored_polygons = color_points_to_colored_lines(color_polygons_points);
-                assert(!colored_polygons.empty());
-                if (has_polygons_only_one_color(colored_polygons)) {
-                    // When the whole ExPolygon is painted using the same color, it is not needed to construct a Voronoi diagram for the segmentation of this ExPolygon.
-                    assert(!colored_polygons.front().empty());
-                    const ExPolygon& expolygon = input_expolygons[layer_idx][expolygon_idx];
-                    const size_t expolygon_color =
-                        static_cast<size_t>(colored_polygons.front().front().color);
+                if (should_cut_segmented_layers) {
+                    dominant_color_per_expolygon[layer_idx].assign(
+                        input_expolygons[layer_idx].size(),
+                        0
+                    );
+                }
 
-                    segmented_regions[layer_idx][expolygon_color].emplace_back(expolygon);
+                for (ColorProjectionExPolygon &input_expolygon_projection_lines : input_expolygons_projection_lines) {
+                    const size_t expolygon_idx = &input_expolygon_projection_lines - input_expolygons_projection_lines.data();
 
-                    // Color 0 is the default extruder, dropped after merging, so only real extruders are stored.
-                    if (should_cut_segmented_layers && expolygon_color > 0) {
-                        dominant_color_per_expolygon[layer_idx][expolygon_idx] = expolygon_color;
+                    if constexpr (MM_SEGMENTATION_DEBUG_COLOR_RANGES) {
+                        export_color_projection_lines_color_ranges_to_svg(debug_out_path("mm-color-ranges-%d-%d.svg", layer_idx, expolygon_idx), input_expolygon_projection_lines, input_expolygons[layer_idx]);
                     }
-                } else {
-                    std::vector<ExPolygons> colored_segments_by_states =
-                        extract_colored_segments(colored_polygons, num_facets_states, layer_idx);
-                    const size_t dominant_color =
-                        dominant_state_by_area(colored_segments_by_states);
 
-                    for (size_t state_idx = 0; state_idx < num_facets_states; ++state_idx) {
-                        if (colored_segments_by_states[state_idx].empty())
-                            continue;
+                    update_color_changes_using_color_projection_ranges(input_expolygon_projection_lines);
+                    filter_projected_color_points_on_expolygon(input_expolygon_projection_lines);
+
+                    std::vector<ColorPoints> color_polygons_points = convert_color_expolygon_projection_lines_to_color_points(input_expolygon_projection_lines);
+                    if (color_polygons_points.empty())
+                        continue;
+
+                    snap_projected_color_points_to_nearest_angles(color_polygons_points);
 
-                        Slic3r::append(segmented_regions[layer_idx][state_idx], std::move(colored_segments_by_states[state_idx]));
+                    if constexpr (MM_SEGMENTATION_DEBUG_COLORIZED_POLYGONS) {
+                        export_color_polygons_points_to_svg(debug_out_path("mm-projected-color_polygon-%d-%d.svg", layer_idx, expolygon_idx), color_polygons_points, input_expolygons[layer_idx]);
                     }
 
-                    if (should_cut_segmented_layers && dominant_color > 0) {
-                        dominant_color_per_expolygon[layer_idx][expolygon_idx] = dominant_color;
+                    const std::vector<ColoredLines> colored_polygons = color_points_to_colored_lines(color_polygons_points);
+                    assert(!colored_polygons.empty());
+                    if (has_polygons_only_one_color(colored_polygons)) {
+                        // When the whole ExPolygon is painted using the same color, it is not needed to construct a Voronoi diagram for the segmentation of this ExPolygon.
+                        assert(!colored_polygons.front().empty());
+                        const ExPolygon& expolygon = input_expolygons[layer_idx][expolygon_idx];
+                        const size_t expolygon_color =
+                            static_cast<size_t>(colored_polygons.front().front().color);
+
+                        segmented_regions[layer_idx][expolygon_color].emplace_back(expolygon);
+
+                        // Color 0 is the default extruder, dropped after merging, so only real extruders are stored.
+                        if (should_cut_segmented_layers && expolygon_color > 0) {
+                            dominant_color_per_expolygon[layer_idx][expolygon_idx] = expolygon_color;
+                        }
+                    } else {
+                        std::vector<ExPolygons> colored_segments_by_states =
+                            extract_colored_segments(colored_polygons, num_facets_states, layer_idx);
+                        const size_t dominant_color =
+                            dominant_state_by_area(colored_segments_by_states);
+
+                        for (size_t state_idx = 0; state_idx < num_facets_states; ++state_idx) {
+                            if (colored_segments_by_states[state_idx].empty())
+                                continue;
+
+                            Slic3r::append(segmented_regions[layer_idx][state_idx], std::move(colored_segments_by_states[state_idx]));
+                        }
+
+                        if (should_cut_segmented_layers && dominant_color > 0) {
+                            dominant_color_per_expolygon[layer_idx][expolygon_idx] = dominant_color;
+                        }
                     }
                 }
-            }
 
-            if constexpr (MM_SEGMENTATION_DEBUG_REGIONS) {
-                export_regions_to_svg(debug_out_path("mm-regions-non-merged-%d.svg", layer_idx), segmented_regions[layer_idx], input_expolygons[layer_idx]);
+                if constexpr (MM_SEGMENTATION_DEBUG_REGIONS) {
+                    export_regions_to_svg(debug_out_path("mm-regions-non-merged-%d.svg", layer_idx), segmented_regions[layer_idx], input_expolygons[layer_idx]);
+                }
             }
-        }
-    }); // end of parallel_for
+        }); // end of parallel_for
+    }
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Layers segmentation in parallel - End";
     throw_on_cancel_callback();
 
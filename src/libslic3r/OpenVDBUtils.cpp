@@ -26,6 +26,7 @@
 #include <openvdb/tools/Composite.h>
 #include <openvdb/tools/LevelSetRebuild.h>
 #include <openvdb/tools/FastSweeping.h>
+#include <openvdb/tools/Clip.h>
 #include <algorithm>
 #include <optional>
 #include <utility>
@@ -323,4 +324,31 @@ bool is_grid_empty(const VoxelGrid &grid)
     return grid.grid.empty();
 }
 
+BoundingBoxf3 active_voxel_bounding_box(const VoxelGrid &grid)
+{
+    openvdb::CoordBBox ibb = grid.grid.evalActiveVoxelBoundingBox();
+    if (ibb.empty())
+        return {};
+
+    openvdb::BBoxd wbb = grid.grid.transform().indexToWorld(ibb);
+
+    return BoundingBoxf3{Vec3d{wbb.min().x(), wbb.min().y(), wbb.min().z()},
+                         Vec3d{wbb.max().x(), wbb.max().y(), wbb.max().z()}};
+}
+
+VoxelGridPtr clip_grid(const VoxelGrid &grid, const BoundingBoxf3 &bb)
+{
+    openvdb::BBoxd wbb{openvdb::Vec3d{bb.min.x(), bb.min.y(), bb.min.z()},
+                       openvdb::Vec3d{bb.max.x(), bb.max.y(), bb.max.z()}};
+
+    auto new_grid = openvdb::tools::clip(grid.grid, wbb);
+
+    auto ret = make_voxelgrid(std::move(*new_grid));
+
+    // Copies voxel_scale metadata, if it exists.
+    ret->grid.insertMeta(*grid.grid.deepCopyMeta());
+
+    return ret;
+}
+
 } // namespace Slic3r
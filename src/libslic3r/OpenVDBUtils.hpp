@@ -11,6 +11,7 @@
 
 #include "admesh/stl.h"
 #include "libslic3r/Point.hpp"
+#include "libslic3r/BoundingBox.hpp"
 
 namespace Slic3r {
 
@@ -89,6 +90,13 @@ void grid_intersection(VoxelGrid &grid, VoxelGrid &arg);
 
 bool is_grid_empty(const VoxelGrid &grid);
 
+// Bounding box of the active voxels in world coordinates.
+BoundingBoxf3 active_voxel_bounding_box(const VoxelGrid &grid);
+
+// Copy of the grid keeping only the voxels inside the given world space box,
+// the rest is set to the background value.
+VoxelGridPtr clip_grid(const VoxelGrid &grid, const BoundingBoxf3 &bb);
+
 } // namespace Slic3r
 
 #endif // OPENVDBUTILS_HPP
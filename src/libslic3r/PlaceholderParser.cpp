@@ -12,6 +12,8 @@
 #include <ctime>
 #include <iomanip>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <algorithm>
 #include <cmath>
 #include <iterator>
@@ -810,6 +812,8 @@ namespace client
         // If false, the macro_processor will evaluate a full macro.
         // If true, the macro processor will evaluate just a boolean condition using the full expressive power of the macro processor.
         bool                     just_boolean_expression = false;
+        // If the template is parsed by parts, the whole template, so that the errors are reported relative to it.
+        const std::string       *full_template          = nullptr;
         std::string              error_message;
 
         // Table to translate symbol tag to a human readable error message.
@@ -1580,8 +1584,10 @@ namespace client
             boost::throw_exception(qi::expectation_failure(it_range.begin(), it_range.end(), spirit::info(std::string("*") + msg)));
         }
 
-        static void process_error_message(const MyContext *context, const boost::spirit::info &info, const Iterator &it_begin, const Iterator &it_end, const Iterator &it_error)
+        static void process_error_message(const MyContext *context, const boost::spirit::info &info, const Iterator &it_parse_begin, const Iterator &it_parse_end, const Iterator &it_error)
         {
+            const Iterator it_begin = context->full_template ? context->full_template->begin() : it_parse_begin;
+            const Iterator it_end   = context->full_template ? context->full_template->end()   : it_parse_end;
             std::string &msg = const_cast<MyContext*>(context)->error_message;
             std::string  first(it_begin, it_error);
             std::string  last(it_error, it_end);
@@ -2348,10 +2354,227 @@ namespace client
 
 static const client::macro_processor g_macro_processor_instance;
 
+// A template split into runs of free-form text copied to the output verbatim, legacy [variable] expansions
+// and the rest, which is left to the macro_processor grammar.
+struct TemplateSegment
+{
+    enum Type {
+        Text,
+        // begin / end delimit the variable name.
+        LegacyVariable,
+        Macro,
+    };
+    Type    type;
+    size_t  begin;
+    size_t  end;
+};
+using TemplateSegments = std::vector<TemplateSegment>;
+
+static bool is_ascii_space(const char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+static bool is_identifier_start(const char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+static bool is_identifier_char(const char c) { return is_identifier_start(c) || (c >= '0' && c <= '9'); }
+
+// Find the end of a {} macro block starting at begin, including an {if}...{endif} block spanning multiple {} pairs.
+// Returns std::string::npos if the end could not be determined, leaving the rest of the template to the grammar.
+static size_t scan_macro_block(const std::string &templ, size_t begin)
+{
+    assert(templ[begin] == '{');
+    int  if_depth = 0;
+    bool code     = true;
+    // Last non-white character of the code to tell a division from a regular expression.
+    char last     = '{';
+    for (size_t i = begin + 1; i < templ.size();) {
+        const char c = templ[i];
+        if (! code) {
+            // Text block of an {if}.
+            if (c == '{') {
+                code = true;
+                last = c;
+            }
+            ++ i;
+        } else if (c == '"' || (c == '/' && ! (is_identifier_char(last) || last == '.' || last == ')' || last == ']' || last == '"'))) {
+            // String literal or regular expression.
+            for (++ i; i < templ.size() && templ[i] != c; ++ i)
+                if (templ[i] == '\\')
+                    ++ i;
+            if (i >= templ.size())
+                return std::string::npos;
+            last = templ[i ++];
+        } else if (is_identifier_char(c)) {
+            size_t j = i;
+            while (j < templ.size() && is_identifier_char(templ[j]))
+                ++ j;
+            const std::string_view token(templ.data() + i, j - i);
+            if (token == "if")
+                ++ if_depth;
+            else if (token == "endif" && -- if_depth < 0)
+                return std::string::npos;
+            last = templ[j - 1];
+            i    = j;
+        } else if (c == '}') {
+            ++ i;
+            if (if_depth == 0)
+                return i;
+            code = false;
+        } else if (c == '{') {
+            return std::string::npos;
+        } else {
+            if (! is_ascii_space(c))
+                last = c;
+            ++ i;
+        }
+    }
+    return std::string::npos;
+}
+
+// Find the end of a legacy [variable] or [vector_variable[index_variable]] expansion starting at begin.
+static size_t scan_legacy_variable(const std::string &templ, size_t begin)
+{
+    assert(templ[begin] == '[');
+    int depth = 0;
+    for (size_t i = begin; i < templ.size(); ++ i) {
+        const char c = templ[i];
+        if (c == '[')
+            ++ depth;
+        else if (c == ']' && -- depth == 0)
+            return i + 1;
+        else if (c == '{' || c == '}')
+            break;
+    }
+    return std::string::npos;
+}
+
+static TemplateSegments compile_template(const std::string &templ)
+{
+    TemplateSegments segments;
+    size_t           i = 0;
+    // The grammar skips white spaces at the start of the template, refusing a non-ASCII7 character there.
+    while (i < templ.size() && is_ascii_space(templ[i]))
+        ++ i;
+    if (i < templ.size() && (unsigned char)templ[i] >= 0x80)
+        return { { TemplateSegment::Macro, 0, templ.size() } };
+
+    while (i < templ.size()) {
+        const char c   = templ[i];
+        size_t     end = std::string::npos;
+        if (c == '{') {
+            if (end = scan_macro_block(templ, i); end != std::string::npos)
+                segments.push_back({ TemplateSegment::Macro, i, end });
+        } else if (c == '[') {
+            if (end = scan_legacy_variable(templ, i); end != std::string::npos) {
+                // Shortcut the plain [variable] expansion.
+                size_t id_begin = i + 1;
+                while (is_ascii_space(templ[id_begin]))
+                    ++ id_begin;
+                size_t id_end = id_begin;
+                if (is_identifier_start(templ[id_begin]))
+                    while (is_identifier_char(templ[id_end]))
+                        ++ id_end;
+                size_t j = id_end;
+                while (is_ascii_space(templ[j]))
+                    ++ j;
+                if (id_end > id_begin && j + 1 == end &&
+                    ! g_macro_processor_instance.keywords.find(templ.substr(id_begin, id_end - id_begin)))
+                    segments.push_back({ TemplateSegment::LegacyVariable, id_begin, id_end });
+                else
+                    segments.push_back({ TemplateSegment::Macro, i, end });
+            }
+        } else {
+            // Free-form text up to a first brace, validated the same way as by the grammar.
+            client::Iterator     it     = templ.begin() + i;
+            spirit::unused_type  unused;
+            try {
+                while (it != templ.end() && *it != '[' && *it != '{')
+                    client::utf8_char_parser().parse(it, templ.end(), unused, unused, unused);
+                end = it - templ.begin();
+                segments.push_back({ TemplateSegment::Text, i, end });
+            } catch (const qi::expectation_failure<client::Iterator> &) {
+                // Let the grammar report the invalid UTF-8 sequence.
+            }
+        }
+        if (end == std::string::npos) {
+            segments.push_back({ TemplateSegment::Macro, i, templ.size() });
+            break;
+        }
+        i = end;
+    }
+
+    // Each invocation of the grammar has its overhead, thus the short runs of text and the legacy variables
+    // between two macro blocks are left to the grammar, so that the macro blocks are parsed at once.
+    TemplateSegments merged;
+    size_t           last_macro = std::string::npos;
+    for (const TemplateSegment &segment : segments) {
+        if (segment.type == TemplateSegment::Macro && last_macro != std::string::npos) {
+            merged.resize(last_macro + 1);
+            merged.back().end = segment.end;
+        } else {
+            merged.push_back(segment);
+            if (segment.type == TemplateSegment::Macro)
+                last_macro = merged.size() - 1;
+            else if (segment.type == TemplateSegment::Text && segment.end - segment.begin >= 256)
+                last_macro = std::string::npos;
+        }
+    }
+    return merged;
+}
+
+// Templates are evaluated repeatedly, for example the layer change G-code at each layer.
+// They are split into segments just once, then only the macro blocks are evaluated by the grammar.
+static std::shared_ptr<const TemplateSegments> compiled_template(const std::string &templ)
+{
+    static std::mutex                                                                 mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const TemplateSegments>>   cache;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto it = cache.find(templ); it != cache.end())
+            return it->second;
+    }
+    auto segments = std::make_shared<const TemplateSegments>(compile_template(templ));
+    std::lock_guard<std::mutex> lock(mutex);
+    // Don't let the cache grow without bounds in case the templates are generated.
+    if (cache.size() >= 256)
+        cache.clear();
+    cache.emplace(templ, segments);
+    return segments;
+}
+
 static std::string process_macro(const std::string &templ, client::MyContext &context)
 {
     std::string output;
-    phrase_parse(templ.begin(), templ.end(), g_macro_processor_instance(&context), client::skipper{}, output);
+    if (context.just_boolean_expression) {
+        phrase_parse(templ.begin(), templ.end(), g_macro_processor_instance(&context), client::skipper{}, output);
+    } else {
+        std::shared_ptr<const TemplateSegments> segments = compiled_template(templ);
+        context.full_template = &templ;
+        for (const TemplateSegment &segment : *segments) {
+            client::Iterator begin = templ.begin() + segment.begin;
+            client::Iterator end   = templ.begin() + segment.end;
+            switch (segment.type) {
+            case TemplateSegment::Text:
+                output.append(begin, end);
+                break;
+            case TemplateSegment::LegacyVariable:
+                try {
+                    client::IteratorRange opt_key(begin, end);
+                    std::string           value;
+                    client::MyContext::legacy_variable_expansion(&context, opt_key, value);
+                    output += value;
+                } catch (const qi::expectation_failure<client::Iterator> &ex) {
+                    client::MyContext::process_error_message(&context, ex.what_, templ.begin(), templ.end(), ex.first);
+                }
+                break;
+            case TemplateSegment::Macro:
+            {
+                std::string value;
+                phrase_parse(begin, end, g_macro_processor_instance(&context), client::skipper{}, value);
+                output += value;
+                break;
+            }
+            }
+            if (! context.error_message.empty())
+                break;
+        }
+    }
 	if (! context.error_message.empty()) {
         if (context.error_message.back() != '\n' && context.error_message.back() != '\r')
             context.error_message += '\n';
@@ -63,6 +63,10 @@ namespace FillAdaptive {
     using OctreePtr = std::unique_ptr<Octree, OctreeDeleter>;
 }; // namespace FillAdaptive
 
+namespace ModelInfo {
+    class VisibilityCache;
+}; // namespace ModelInfo
+
 namespace FillLightning {
     class Generator;
     struct GeneratorDeleter;
@@ -389,6 +393,11 @@ public:
     // Helpers to project custom facets on slices
     void project_and_append_custom_facets(bool seam, TriangleStateType type, std::vector<Polygons>& expolys) const;
 
+    // Mesh visibility used by the aligned seam placer, kept between G-code exports until the object geometry changes.
+    ModelInfo::VisibilityCache& seam_visibility_cache() const { return *m_seam_visibility_cache; }
+    // State of the last support spots search, kept to resume the next search from the first changed layer.
+    const SupportSpotsGenerator::StabilityCache& support_spots_cache() const { return *m_support_spots_cache; }
+
 private:
     // to be called from Print only.
     friend class Print;
@@ -475,6 +484,12 @@ private:
 
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
     FillLightning::GeneratorPtr m_lightning_generator;
+
+    // Filled in lazily by the G-code export, validated against the meshes and transformations it was calculated from.
+    std::shared_ptr<ModelInfo::VisibilityCache> m_seam_visibility_cache;
+
+    // Filled in by generate_support_spots(), validated against the layers and parameters it was calculated from.
+    SupportSpotsGenerator::StabilityCachePtr m_support_spots_cache;
 };
 
 
@@ -4933,6 +4933,33 @@ void PrintConfigDef::init_sla_params()
     def->mode = comExpert;
     def->set_default_value(new ConfigOptionFloat(0.001));
 
+    def = this->add("sla_archive_compression", coInt);
+    def->label = L("Layer image compression");
+    def->tooltip = L("Compression level of the layer images written into the archive, "
+                     "from 0 (no compression) to 9 (smallest file). Lower levels make the export "
+                     "faster at the cost of a bigger archive.");
+    def->min = 0;
+    def->max = 9;
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionInt(6));
+
+    def = this->add("sla_slices_compression", coBool);
+    def->label = L("Compress slices in memory");
+    def->tooltip = L("Keep the sliced layers of the objects and supports compressed in memory. "
+                     "This saves memory for big jobs at the cost of some processing time.");
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionBool(false));
+
+    def = this->add("sla_slices_memory_limit", coInt);
+    def->label = L("Slices memory limit");
+    def->tooltip = L("Memory for the sliced layers of each object. The layers above the limit are "
+                     "written to a temporary file and read back for rasterization. "
+                     "Set zero to keep all the layers in memory.");
+    def->sidetext = L("MB");
+    def->min = 0;
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionInt(0));
+
     // Declare retract values for material profile, overriding the print and printer profiles.
     for (const char* opt_key : {
         // float
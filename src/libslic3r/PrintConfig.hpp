@@ -1379,6 +1379,9 @@ PRINT_CONFIG_CLASS_DEFINE(
     ((ConfigOptionFloat,                      max_initial_exposure_time))
     ((ConfigOptionString,                     sla_archive_format))
     ((ConfigOptionFloat,                      sla_output_precision))
+    ((ConfigOptionInt,                        sla_archive_compression))
+    ((ConfigOptionBool,                       sla_slices_compression))
+    ((ConfigOptionInt,                        sla_slices_memory_limit))
     ((ConfigOptionString,                     printer_model))
 )
 
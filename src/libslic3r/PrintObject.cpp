@@ -33,6 +33,7 @@
 #include "ExPolygon.hpp"
 #include "Flow.hpp"
 #include "libslic3r/GCode/ExtrusionProcessor.hpp"
+#include "libslic3r/GCode/ModelVisibility.hpp"
 #include "Line.hpp"
 #include "Polygon.hpp"
 #include "Polyline.hpp"
@@ -109,7 +110,9 @@ namespace Slic3r {
 // Constructor is called from the main thread, therefore all Model / ModelObject / ModelIntance data are valid.
 PrintObject::PrintObject(Print* print, ModelObject* model_object, const Transform3d& trafo, PrintInstances&& instances) :
     PrintObjectBaseWithState(print, model_object),
-    m_trafo(trafo)
+    m_trafo(trafo),
+    m_seam_visibility_cache(std::make_shared<ModelInfo::VisibilityCache>()),
+    m_support_spots_cache(SupportSpotsGenerator::make_stability_cache())
 {
     // Compute centering offet to be applied to our meshes so that we work with smaller coordinates
     // requiring less bits to represent Clipper coordinates.
@@ -502,7 +505,8 @@ void PrintObject::generate_support_spots()
                                                  float(this->print()->m_config.perimeter_acceleration.getFloat()),
                                                  this->config().raft_layers.getInt(), this->config().brim_type.value,
                                                  float(this->config().brim_width.getFloat())};
-            auto [supp_points, partial_objects] = SupportSpotsGenerator::full_search(this, cancel_func, params);
+            // Only the layers above the first one changed since the last search are checked again.
+            auto [supp_points, partial_objects] = SupportSpotsGenerator::full_search(this, cancel_func, params, *m_support_spots_cache);
             Transform3d po_transform            = this->trafo_centered();
             if (this->layer_count() > 0) {
                 po_transform = Geometry::translation_transform(Vec3d{0, 0, this->layers().front()->bottom_z()}) * po_transform;
@@ -6,7 +6,11 @@
 
 #include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/task_arena.h>
+#include <atomic>
+#include <numeric>
 #include <tuple>
+#include <unordered_map>
 #include <optional>
 #include <algorithm>
 #include <array>
@@ -131,8 +135,10 @@ namespace QuadricEdgeCollapse {
     // calculate error for vertex and quadrics, triangle quadrics and triangle vertex give zero, only pozitive number
     double vertex_error(const SymMat &q, const Vec3d &vertex);
     SymMat create_quadric(const Triangle &t, const Vec3d& n, const Vertices &vertices);
+    // Vertices which must stay in place, e.g. on borders of a cluster of the mesh
+    using Locked = std::vector<bool>;
     std::tuple<TriangleInfos, VertexInfos, EdgeInfos, Errors> 
-    init(const indexed_triangle_set &its, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn);
+    init(const indexed_triangle_set &its, const Locked *locked, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn);
     std::optional<uint32_t> find_triangle_index1(uint32_t vi, const VertexInfo& v_info,
         uint32_t ti, const EdgeInfos& e_infos, const Indices& indices);
     void reorder_edges(EdgeInfos &e_infos, const VertexInfo &v_info, uint32_t ti0, uint32_t ti1);
@@ -143,13 +149,22 @@ namespace QuadricEdgeCollapse {
     bool create_no_volume(uint32_t vi0, uint32_t vi1, uint32_t ti0, uint32_t ti1,
         const VertexInfo &v_info0, const VertexInfo &v_info1, const EdgeInfos &e_infos, const Indices &indices);
     // find edge with smallest error in triangle
-    Vec3d calculate_3errors(const Triangle &t, const Vertices &vertices, const VertexInfos &v_infos);
-    Error calculate_error(uint32_t ti, const Triangle& t,const Vertices &vertices, const VertexInfos& v_infos, unsigned char& min_index);
+    // edges with a locked vertex get infinite error
+    Vec3d calculate_3errors(const Triangle &t, const Vertices &vertices, const VertexInfos &v_infos, const Locked *locked);
+    Error calculate_error(uint32_t ti, const Triangle& t,const Vertices &vertices, const VertexInfos& v_infos, const Locked *locked, unsigned char& min_index);
     void remove_triangle(EdgeInfos &e_infos, VertexInfo &v_info, uint32_t ti);
     void change_neighbors(EdgeInfos &e_infos, VertexInfos &v_infos, uint32_t ti0, uint32_t ti1,
                           uint32_t vi0, uint32_t vi1, uint32_t vi_top0,
                           const Triangle &t1, CopyEdgeInfos& infos, EdgeInfos &e_infos1);
     void compact(const VertexInfos &v_infos, const TriangleInfos &t_infos, const EdgeInfos &e_infos, indexed_triangle_set &its);
+    // Reduce triangles of its, returns the error of the last collapsed edge
+    float collapse(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error,
+                   const Locked *locked, ThrowOnCancel &throw_on_cancel, StatusFn &status_fn);
+    // Split triangles into spatially compact clusters of similar size
+    std::vector<std::vector<uint32_t>> create_clusters(const indexed_triangle_set &its, size_t count);
+    // Simplify clusters in parallel with locked borders and merge them back into its
+    float collapse_clusters(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error,
+                            size_t cluster_count, ThrowOnCancel &throw_on_cancel, StatusFn &status_fn);
 
 #ifdef EXPENSIVE_DEBUG_CHECKS
     void store_surround(const char *obj_filename, size_t triangle_index, int depth, const indexed_triangle_set &its,
@@ -169,6 +184,10 @@ namespace QuadricEdgeCollapse {
     const int status_set_offsets = 10;
     const int status_calc_errors = 30;
     const int status_create_refs = 10;
+    // partitioning into clusters simplified in parallel
+    const size_t min_triangle_count_for_clusters = 200000;
+    const size_t min_cluster_triangle_count = 50000;
+    const int status_clusters_size = 70; // in percents, the rest is for the final pass
     } // namespace QuadricEdgeCollapse
 
 using namespace QuadricEdgeCollapse;
@@ -178,7 +197,8 @@ void Slic3r::its_quadric_edge_collapse(
     uint32_t                  triangle_count,
     float *                   max_error,
     std::function<void(void)> throw_on_cancel,
-    std::function<void(int)>  status_fn)
+    std::function<void(int)>  status_fn,
+    float                     quality)
 {
     // check input
     if (triangle_count >= its.indices.size()) return;
@@ -187,6 +207,44 @@ void Slic3r::its_quadric_edge_collapse(
     if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
     if (status_fn == nullptr) status_fn = [](int) {};
 
+    // count of clusters is power of 2, to be split evenly by median cuts
+    size_t cluster_count = 1;
+    if (quality < 1.f && its.indices.size() >= min_triangle_count_for_clusters) {
+        size_t max_count = std::min(4 * size_t(tbb::this_task_arena::max_concurrency()),
+                                    its.indices.size() / min_cluster_triangle_count);
+        while (2 * cluster_count <= max_count) cluster_count *= 2;
+    }
+
+    float last_collapsed_error = 0.f;
+    if (cluster_count > 1) {
+        // clusters reduce their share of (1 - quality) part of the reduction
+        uint32_t reduce = static_cast<uint32_t>((1.f - std::max(quality, 0.f)) * (its.indices.size() - triangle_count));
+        StatusFn clusters_status_fn = [&](int percent) {
+            status_fn(percent * status_clusters_size / 100);
+        };
+        last_collapsed_error = collapse_clusters(its, its.indices.size() - reduce, maximal_error,
+                                                 cluster_count, throw_on_cancel, clusters_status_fn);
+        throw_on_cancel();
+    }
+
+    StatusFn final_status_fn = [&](int percent) {
+        int offset = (cluster_count > 1) ? status_clusters_size : 0;
+        status_fn(offset + percent * (100 - offset) / 100);
+    };
+    if (triangle_count < its.indices.size())
+        last_collapsed_error = std::max(last_collapsed_error,
+            collapse(its, triangle_count, maximal_error, nullptr, throw_on_cancel, final_status_fn));
+
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+float QuadricEdgeCollapse::collapse(indexed_triangle_set &its,
+                                    uint32_t              triangle_count,
+                                    float                 maximal_error,
+                                    const Locked *        locked,
+                                    ThrowOnCancel &       throw_on_cancel,
+                                    StatusFn &            status_fn)
+{
     StatusFn init_status_fn = [&](int percent) {
         float n_percent = percent * status_init_size / 100.f;
         status_fn(static_cast<int>(std::round(n_percent)));
@@ -196,7 +254,7 @@ void Slic3r::its_quadric_edge_collapse(
     VertexInfos   v_infos;
     EdgeInfos     e_infos;
     Errors        errors;
-    std::tie(t_infos, v_infos, e_infos, errors) = init(its, throw_on_cancel, init_status_fn);
+    std::tie(t_infos, v_infos, e_infos, errors) = init(its, locked, throw_on_cancel, init_status_fn);
     throw_on_cancel();
     status_fn(status_init_size);
 
@@ -278,7 +336,7 @@ void Slic3r::its_quadric_edge_collapse(
             is_flipped(new_vertex0, ti0, ti1, v_info0, t_infos, e_infos, its) ||
             is_flipped(new_vertex0, ti0, ti1, v_info1, t_infos, e_infos, its)) {
             // try other triangle's edge
-            Vec3d errors = calculate_3errors(t0, its.vertices, v_infos);
+            Vec3d errors = calculate_3errors(t0, its.vertices, v_infos, locked);
             Vec3i ord = (errors[0] < errors[1]) ? 
                 ((errors[0] < errors[2])? 
                     ((errors[1] < errors[2]) ? Vec3i(0, 1, 2) : Vec3i(0, 2, 1)) :
@@ -342,7 +400,7 @@ void Slic3r::its_quadric_edge_collapse(
             size_t priority_queue_index = ti_2_mpqi[ti];
             TriangleInfo& t_info = t_infos[ti];
             t_info.n = create_normal(its.indices[ti], its.vertices).cast<float>(); // recalc normals
-            mpq[priority_queue_index] = calculate_error(ti, its.indices[ti], its.vertices, v_infos, t_info.min_index);
+            mpq[priority_queue_index] = calculate_error(ti, its.indices[ti], its.vertices, v_infos, locked, t_info.min_index);
             mpq.update(priority_queue_index);
         }
 
@@ -359,7 +417,186 @@ void Slic3r::its_quadric_edge_collapse(
 
     // compact triangle
     compact(v_infos, t_infos, e_infos, its);
-    if (max_error != nullptr) *max_error = last_collapsed_error;
+    return last_collapsed_error;
+}
+
+std::vector<std::vector<uint32_t>> QuadricEdgeCollapse::create_clusters(
+    const indexed_triangle_set &its, size_t count)
+{
+    std::vector<Vec3f> centers(its.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            const Triangle &t = its.indices[i];
+            centers[i] = (its.vertices[t[0]] + its.vertices[t[1]] + its.vertices[t[2]]) / 3.f;
+        }
+    }); // END parallel for
+
+    std::vector<uint32_t> order(its.indices.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    // median cut of each range along the longest side of its bounding box
+    std::vector<std::pair<size_t, size_t>> ranges = {{0, order.size()}};
+    while (ranges.size() < count) {
+        std::vector<std::pair<size_t, size_t>> halves(2 * ranges.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, ranges.size(), 1),
+        [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t ri = range.begin(); ri < range.end(); ++ri) {
+                auto [from, to] = ranges[ri];
+                Vec3f mn = centers[order[from]], mx = mn;
+                for (size_t i = from; i < to; ++i) {
+                    mn = mn.cwiseMin(centers[order[i]]);
+                    mx = mx.cwiseMax(centers[order[i]]);
+                }
+                Vec3f::Index axis;
+                (mx - mn).maxCoeff(&axis);
+                size_t mid = (from + to) / 2;
+                std::nth_element(order.begin() + from, order.begin() + mid, order.begin() + to,
+                    [&centers, axis](uint32_t t1, uint32_t t2) { return centers[t1][axis] < centers[t2][axis]; });
+                halves[2 * ri]     = {from, mid};
+                halves[2 * ri + 1] = {mid, to};
+            }
+        }); // END parallel for
+        ranges = std::move(halves);
+    }
+
+    std::vector<std::vector<uint32_t>> clusters;
+    clusters.reserve(ranges.size());
+    for (auto [from, to] : ranges)
+        clusters.emplace_back(order.begin() + from, order.begin() + to);
+    return clusters;
+}
+
+float QuadricEdgeCollapse::collapse_clusters(indexed_triangle_set &its,
+                                             uint32_t              triangle_count,
+                                             float                 maximal_error,
+                                             size_t                cluster_count,
+                                             ThrowOnCancel &       throw_on_cancel,
+                                             StatusFn &            status_fn)
+{
+    std::vector<std::vector<uint32_t>> clusters = create_clusters(its, cluster_count);
+    throw_on_cancel();
+
+    // vertex shared by more clusters is locked, it connects the clusters back together
+    const uint32_t unused = std::numeric_limits<uint32_t>::max();
+    const uint32_t shared = unused - 1;
+    std::vector<uint32_t> owners(its.vertices.size(), unused);
+    for (uint32_t ci = 0; ci < clusters.size(); ++ci)
+        for (uint32_t ti : clusters[ci])
+            for (size_t j = 0; j < 3; ++j) {
+                uint32_t &owner = owners[its.indices[ti][j]];
+                if (owner == unused) owner = ci;
+                else if (owner != ci) owner = shared;
+            }
+
+    struct Cluster {
+        indexed_triangle_set its;
+        std::vector<uint32_t> shared_vertices; // global indices of first local vertices
+        float error = 0.f;
+    };
+    std::vector<Cluster> results(clusters.size());
+    // index into cluster for vertices owned by one cluster, each written by its owner only
+    std::vector<uint32_t> local_indices(its.vertices.size(), unused);
+
+    float reduce_ratio = 1.f - triangle_count / static_cast<float>(its.indices.size());
+    std::atomic<int> done{0};
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, clusters.size(), 1),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t ci = range.begin(); ci < range.end(); ++ci) {
+            const std::vector<uint32_t> &triangles = clusters[ci];
+            Cluster &cluster = results[ci];
+            indexed_triangle_set &cits = cluster.its;
+
+            // shared vertices first, compact keeps them in place as they are never removed
+            std::unordered_map<uint32_t, uint32_t> shared_indices;
+            for (uint32_t ti : triangles)
+                for (size_t j = 0; j < 3; ++j) {
+                    uint32_t vi = its.indices[ti][j];
+                    if (owners[vi] == shared && shared_indices.emplace(vi, cluster.shared_vertices.size()).second)
+                        cluster.shared_vertices.emplace_back(vi);
+                }
+            cits.vertices.reserve(cluster.shared_vertices.size() + triangles.size() / 2 + 2);
+            for (uint32_t vi : cluster.shared_vertices)
+                cits.vertices.emplace_back(its.vertices[vi]);
+
+            cits.indices.reserve(triangles.size());
+            for (uint32_t ti : triangles) {
+                Triangle t = its.indices[ti];
+                for (size_t j = 0; j < 3; ++j) {
+                    int &vi = t[j];
+                    if (owners[vi] == shared) {
+                        vi = shared_indices[vi];
+                        continue;
+                    }
+                    uint32_t &local = local_indices[vi];
+                    if (local == unused) {
+                        local = cits.vertices.size();
+                        cits.vertices.emplace_back(its.vertices[vi]);
+                    }
+                    vi = local;
+                }
+                cits.indices.emplace_back(t);
+            }
+
+            Locked locked(cits.vertices.size(), false);
+            std::fill(locked.begin(), locked.begin() + cluster.shared_vertices.size(), true);
+
+            uint32_t cluster_triangle_count = static_cast<uint32_t>(
+                std::round(cits.indices.size() * (1.f - reduce_ratio)));
+            StatusFn no_status = [](int) {};
+            if (cluster_triangle_count < cits.indices.size())
+                cluster.error = collapse(cits, cluster_triangle_count, maximal_error, &locked, throw_on_cancel, no_status);
+
+            status_fn(100 * (++done) / static_cast<int>(clusters.size()));
+        }
+    }); // END parallel for
+    clusters = {};
+    local_indices = {};
+
+    // merge: shared vertices, then not shared vertices of each cluster
+    indexed_triangle_set merged;
+    std::vector<uint32_t> &shared_indices = owners; // reuse memory, only shared vertices are set
+    for (const Cluster &cluster : results)
+        for (uint32_t vi : cluster.shared_vertices)
+            if (shared_indices[vi] == shared) {
+                shared_indices[vi] = merged.vertices.size();
+                merged.vertices.emplace_back(its.vertices[vi]);
+            }
+
+    std::vector<size_t> vertex_offsets(results.size()), triangle_offsets(results.size());
+    size_t vertex_count = merged.vertices.size(), merged_triangle_count = 0;
+    for (size_t ci = 0; ci < results.size(); ++ci) {
+        vertex_offsets[ci] = vertex_count;
+        triangle_offsets[ci] = merged_triangle_count;
+        vertex_count += results[ci].its.vertices.size() - results[ci].shared_vertices.size();
+        merged_triangle_count += results[ci].its.indices.size();
+    }
+    merged.vertices.resize(vertex_count);
+    merged.indices.resize(merged_triangle_count);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, results.size(), 1),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t ci = range.begin(); ci < range.end(); ++ci) {
+            const Cluster &cluster = results[ci];
+            uint32_t shared_count = cluster.shared_vertices.size();
+            std::copy(cluster.its.vertices.begin() + shared_count, cluster.its.vertices.end(),
+                      merged.vertices.begin() + vertex_offsets[ci]);
+            for (size_t i = 0; i < cluster.its.indices.size(); ++i) {
+                Triangle t = cluster.its.indices[i];
+                for (size_t j = 0; j < 3; ++j) {
+                    uint32_t vi = t[j];
+                    t[j] = (vi < shared_count) ? shared_indices[cluster.shared_vertices[vi]] :
+                                                 vertex_offsets[ci] + (vi - shared_count);
+                }
+                merged.indices[triangle_offsets[ci] + i] = t;
+            }
+        }
+    }); // END parallel for
+
+    float error = 0.f;
+    for (const Cluster &cluster : results) error = std::max(error, cluster.error);
+    its = std::move(merged);
+    return error;
 }
 
 Vec3d QuadricEdgeCollapse::create_normal(const Triangle &triangle,
@@ -454,7 +691,7 @@ SymMat QuadricEdgeCollapse::create_quadric(const Triangle &t,
 }
 
 std::tuple<TriangleInfos, VertexInfos, EdgeInfos, Errors> 
-QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn)
+QuadricEdgeCollapse::init(const indexed_triangle_set &its, const Locked *locked, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn)
 {
     int status_offset = 0;
     TriangleInfos t_infos(its.indices.size());
@@ -516,7 +753,7 @@ QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_
         for (size_t i = range.begin(); i < range.end(); ++i) {
             const Triangle &t      = its.indices[i];
             TriangleInfo &  t_info = t_infos[i];
-            errors[i] = calculate_error(i, t, its.vertices, v_infos, t_info.min_index);
+            errors[i] = calculate_error(i, t, its.vertices, v_infos, locked, t_info.min_index);
             if (i % 1000000 == 0) {
                 throw_on_cancel();
                 status_fn(status_offset + (i * status_calc_errors) / its.indices.size());
@@ -716,13 +953,18 @@ bool QuadricEdgeCollapse::create_no_volume(
 
 Vec3d QuadricEdgeCollapse::calculate_3errors(const Triangle &   t,
                                              const Vertices &   vertices,
-                                             const VertexInfos &v_infos)
+                                             const VertexInfos &v_infos,
+                                             const Locked *     locked)
 {
     Vec3d error;
     for (size_t j = 0; j < 3; ++j) {
         size_t   j2  = (j == 2) ? 0 : (j + 1);
         uint32_t vi0 = t[j];
         uint32_t vi1 = t[j2];
+        if (locked != nullptr && ((*locked)[vi0] || (*locked)[vi1])) {
+            error[j] = std::numeric_limits<double>::infinity();
+            continue;
+        }
         SymMat   q(v_infos[vi0].q); // copy
         q += v_infos[vi1].q;
         error[j] = calculate_error(vi0, vi1, q, vertices);
@@ -734,9 +976,10 @@ Error QuadricEdgeCollapse::calculate_error(uint32_t           ti,
                                            const Triangle &   t,
                                            const Vertices &   vertices,
                                            const VertexInfos &v_infos,
+                                           const Locked *     locked,
                                            unsigned char &    min_index)
 {
-    Vec3d error = calculate_3errors(t, vertices, v_infos);
+    Vec3d error = calculate_3errors(t, vertices, v_infos, locked);
     // select min error
     min_index = (error[0] < error[1]) ? ((error[0] < error[2]) ? 0 : 2) :
                                         ((error[1] < error[2]) ? 1 : 2);
@@ -27,14 +27,21 @@ namespace Slic3r {
 /// <param name="max_error">Maximal Quadric for reduce.
 /// When nullptr then max float is used
 /// Output: Last used ErrorValue to collapse edge</param>
-/// <param name="throw_on_cancel">Could stop process of calculation.</param>
-/// <param name="statusfn">Give a feed back to user about progress. Values 1 - 100</param>
+/// <param name="throw_on_cancel">Could stop process of calculation.
+/// With quality lower than 1 it is called concurrently from worker threads.</param>
+/// <param name="statusfn">Give a feed back to user about progress. Values 1 - 100
+/// With quality lower than 1 it is called concurrently from worker threads.</param>
+/// <param name="quality">Part of the reduction made over the whole mesh, 0 - 1.
+/// Big meshes are first split into spatial clusters, which are reduced in parallel
+/// with their borders locked, the rest of the reduction is made over the whole mesh
+/// including the seams. Value 1 keeps the whole reduction serial and exact.</param>
 void its_quadric_edge_collapse(
     indexed_triangle_set &    its,
     uint32_t                  triangle_count  = 0,
     float *                   max_error       = nullptr,
     std::function<void(void)> throw_on_cancel = nullptr,
-    std::function<void(int)>  statusfn        = nullptr);
+    std::function<void(int)>  statusfn        = nullptr,
+    float                     quality         = 1.f);
 
 } // namespace Slic3r
 #endif // slic3r_quadric_edge_collapse_hpp_
@@ -4,6 +4,7 @@
 ///|/
 #include <libslic3r/SLA/ConcaveHull.hpp>
 #include <libslic3r/SLA/SpatIndex.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
 #include <cmath>
 #include <iterator>
 #include <limits>
@@ -72,30 +73,29 @@ void ConcaveHull::add_connector_rectangles(const Points &centroids,
     unsigned  idx = 0;
     for(const Point &ct : centroids) ctrindex.insert(to_vec3(ct), idx++);
 
-    m_polys.reserve(m_polys.size() + centroids.size());
-
-    idx = 0;
-    for (const Point &c : centroids) {
+    // Distances to the nearest neighbours, the index is only read here.
+    std::vector<double> dists(centroids.size(), double(max_dist));
+    execution::for_each(ex_tbb, size_t(0), centroids.size(), [&](size_t i) {
         thr();
-
-        double dx = c.x() - cc.x(), dy = c.y() - cc.y();
-        double l  = std::sqrt(dx * dx + dy * dy);
-        double nx = dx / l, ny = dy / l;
-
-        const Point &ct = centroids[idx];
-
+        const Point &ct = centroids[i];
         std::vector<PointIndexEl> result = ctrindex.nearest(to_vec3(ct), 2);
-
-        double dist = max_dist;
         for (const PointIndexEl &el : result)
-            if (el.second != idx) {
-                dist = Line(to_vec2(el.first), ct).length();
+            if (el.second != i) {
+                dists[i] = Line(to_vec2(el.first), ct).length();
                 break;
             }
+    }, 64 /* gransize */);
+
+    m_polys.reserve(m_polys.size() + centroids.size());
+
+    for (size_t i = 0; i < centroids.size(); ++i) {
+        const Point &c = centroids[i];
 
-        idx++;
+        double dx = c.x() - cc.x(), dy = c.y() - cc.y();
+        double l  = std::sqrt(dx * dx + dy * dy);
+        double nx = dx / l, ny = dy / l;
 
-        if (dist >= max_dist) return;
+        if (dists[i] >= max_dist) return;
 
         Polygon r;
         r.points.reserve(3);
@@ -247,7 +247,9 @@ public:
 
     void interconnect_pillars();
 
-    inline void merge_result() { m_builder.merged_mesh(); }
+    // The mesh of the tree is built on demand for preview and export,
+    // slicing and the pad use the primitives directly.
+    inline void merge_result() {}
 
     static bool execute(SupportTreeBuilder & builder, const SupportableMesh &sm);
 };
@@ -10,6 +10,7 @@
 #include <libslic3r/AABBMesh.hpp>
 #include <libslic3r/ClipperUtils.hpp>
 #include <libslic3r/Execution/ExecutionSeq.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
 #include <libslic3r/Model.hpp>
 #include <libslic3r/MeshBoolean.hpp>
 #include <boost/log/trivial.hpp>
@@ -78,6 +79,29 @@ VoxelGrid &get_grid(Interior &interior)
     return *interior.gridptr;
 }
 
+// Height of the Z slabs in voxels in which the interior is computed. The
+// offsetting widens the band of the level set to the whole wall thickness,
+// which is what the memory is spent on for big models.
+static constexpr double INTERIOR_SLAB_VOXELS = 256.;
+
+// Do the offsetting of the model grid, see generate_interior().
+static VoxelGridPtr offset_interior_grid(const VoxelGrid &vgrid,
+                                         double           offset,
+                                         double           D,
+                                         float            in_range,
+                                         float            out_range,
+                                         float            narrowb)
+{
+    auto gridptr = dilate_grid(vgrid, out_range, in_range);
+
+    if (D > EPSILON) {
+        gridptr = redistance_grid(*gridptr, -(offset + D), narrowb, narrowb);
+        gridptr = dilate_grid(*gridptr, 1.1 * std::ceil(D), 0.f);
+    }
+
+    return gridptr;
+}
+
 InteriorPtr generate_interior(const VoxelGrid       &vgrid,
                               const HollowingConfig &hc,
                               const JobController   &ctl)
@@ -92,17 +116,65 @@ InteriorPtr generate_interior(const VoxelGrid       &vgrid,
     if (ctl.stopcondition()) return {};
     else ctl.statuscb(0, _u8L("Hollowing"));
 
-    auto gridptr = dilate_grid(vgrid, out_range, in_range);
+    // The value of the offset grid at any point only depends on the model
+    // within in_range from it. Thus the model can be cut into Z slabs which
+    // are offset independently (in parallel) if each slab sees the model
+    // with a margin above and below. Only the narrow band around the interior
+    // of each slab is then merged into the resulting grid, which is meshed
+    // in one go, so there is no stitching of the meshes.
+    const BoundingBoxf3 bb = active_voxel_bounding_box(vgrid);
+    const double voxel  = 1. / voxsc;
+    const double margin = 2. * (offset + D) + 4. * voxel;
+    const double slab_h = std::max(INTERIOR_SLAB_VOXELS * voxel, 2. * margin);
+    const size_t slab_cnt = bb.defined ? size_t(std::ceil(bb.size().z() / slab_h)) : 0;
 
-    if (ctl.stopcondition()) return {};
-    else ctl.statuscb(30, _u8L("Hollowing"));
+    VoxelGridPtr gridptr;
+    if (slab_cnt < 2) {
+        gridptr = offset_interior_grid(vgrid, offset, D, in_range, out_range, narrowb);
+    } else {
+        std::mutex merge_mtx;
+        size_t slabs_done = 0;
 
-    double iso_surface = D;
-    if (D > EPSILON) {
-        gridptr = redistance_grid(*gridptr, -(offset + D), narrowb, narrowb);
+        execution::for_each(ex_tbb, size_t(0), slab_cnt, [&](size_t i) {
+            if (ctl.stopcondition())
+                return;
 
-        gridptr = dilate_grid(*gridptr, 1.1 * std::ceil(iso_surface), 0.f);
+            // Slabs overlap by a voxel so that no gap is left between them.
+            BoundingBoxf3 slab_bb = bb;
+            slab_bb.min -= Vec3d::Constant(margin);
+            slab_bb.max += Vec3d::Constant(margin);
+            if (i > 0)
+                slab_bb.min.z() = bb.min.z() + i * slab_h - voxel;
+            if (i + 1 < slab_cnt)
+                slab_bb.max.z() = bb.min.z() + (i + 1) * slab_h + voxel;
+
+            BoundingBoxf3 input_bb = slab_bb;
+            input_bb.min.z() -= margin;
+            input_bb.max.z() += margin;
+
+            VoxelGridPtr slab = offset_interior_grid(*clip_grid(vgrid, input_bb),
+                                                     offset, D, in_range,
+                                                     out_range, narrowb);
+            slab = clip_grid(*slab, slab_bb);
+
+            // The slab is merged and released right away, so besides the
+            // merged grid only the slabs being offset by the workers are
+            // alive at a time.
+            std::lock_guard lk(merge_mtx);
+            if (gridptr)
+                grid_union(*gridptr, *slab);
+            else
+                gridptr = std::move(slab);
+
+            ++slabs_done;
+            ctl.statuscb(int(70 * slabs_done / slab_cnt), _u8L("Hollowing"));
+        }, 1);
+
+        if (ctl.stopcondition()) return {};
+    }
 
+    double iso_surface = D;
+    if (D > EPSILON) {
         out_range = iso_surface;
         in_range  = narrowb / voxsc;
     } else {
@@ -6,6 +6,7 @@
 #include <libslic3r/SLA/SpatIndex.hpp>
 //#include <libslic3r/SLA/Contour3D.hpp>
 #include <libslic3r/TriangleMeshSlicer.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
 #include <boost/log/trivial.hpp>
 #include <algorithm>
 #include <utility>
@@ -52,6 +53,27 @@ inline indexed_triangle_set straight_walls(const Polygon &plate,
     return wall_strip(plate, hi_z, lo_z); //walls(plate, plate, lo_z, hi_z);
 }
 
+// Merge the meshes in their order, so the result does not depend on which
+// thread created which part.
+indexed_triangle_set merge_ordered(std::vector<indexed_triangle_set> &&parts)
+{
+    size_t nvertices = 0, nfaces = 0;
+    for (const indexed_triangle_set &part : parts) {
+        nvertices += part.vertices.size();
+        nfaces += part.indices.size();
+    }
+
+    indexed_triangle_set ret;
+    ret.vertices.reserve(nvertices);
+    ret.indices.reserve(nfaces);
+    for (indexed_triangle_set &part : parts) {
+        its_merge(ret, part);
+        part = {};
+    }
+
+    return ret;
+}
+
 // Function to cut tiny connector cavities for a given polygon. The input poly
 // will be offsetted by "padding" and small rectangle shaped cavities will be
 // inserted along the perimeter in every "stride" distance. The stick rectangles
@@ -130,10 +152,11 @@ template<class...Args>
 ExPolygons breakstick_holes(const ExPolygons &input, Args...args)
 {
     ExPolygons ret = input;
-    for (ExPolygon &p : ret) {
+    execution::for_each(ex_tbb, size_t(0), ret.size(), [&ret, args...](size_t i) {
+        ExPolygon &p = ret[i];
         breakstick_holes(p.contour.points, args...);
         for (auto &h : p.holes) breakstick_holes(h.points, args...);
-    }
+    });
 
     return ret;
 }
@@ -209,8 +232,9 @@ public:
         m_index.insert(get_extents(ep), unsigned(m_index.size()));
     }
 
-    // Check an arbitrary polygon for intersection with the indexed polygons
-    bool intersects(const ExPolygon &poly)
+    // Check an arbitrary polygon for intersection with the indexed polygons.
+    // Safe to call concurrently.
+    bool intersects(const ExPolygon &poly) const
     {
         // Create a suitable query bounding box.
         auto bb = poly.contour.bounding_box();
@@ -231,7 +255,7 @@ public:
 struct DummyIntersector
 {
     inline void add(const ExPolygon &) {}
-    inline bool intersects(const ExPolygon &) { return true; }
+    inline bool intersects(const ExPolygon &) const { return true; }
 };
 
 template<class _Intersector>
@@ -308,9 +332,15 @@ private:
     // To remove parts of the pad skeleton which do not host any supports
     void remove_redundant_parts(ExPolygons &parts)
     {
+        std::vector<char> redundant(parts.size(), false);
+        execution::for_each(ex_tbb, size_t(0), parts.size(), [this, &parts, &redundant](size_t i) {
+            redundant[i] = !m_intersector.intersects(parts[i]);
+        });
+
+        size_t i = 0;
         auto endit = std::remove_if(parts.begin(), parts.end(),
-                                    [this](const ExPolygon &p) {
-                                        return !m_intersector.intersects(p);
+                                    [&redundant, &i](const ExPolygon &) {
+                                        return redundant[i++];
                                     });
 
         parts.erase(endit, parts.end());
@@ -386,53 +416,49 @@ bool add_cavity(indexed_triangle_set &pad,
     return true;
 }
 
-indexed_triangle_set create_outer_pad_geometry(const ExPolygons & skeleton,
-                                               const PadConfig3D &cfg,
-                                               ThrowOnCancel      thr)
+indexed_triangle_set create_outer_pad_part(const ExPolygon &  pad_part,
+                                           const PadConfig3D &cfg,
+                                           ThrowOnCancel      thr)
 {
     indexed_triangle_set ret;
 
-    for (const ExPolygon &pad_part : skeleton) {
-        ExPolygon top_poly{pad_part};
-        ExPolygon bottom_poly =
-            offset_contour_only(pad_part, -scaled(cfg.bottom_offset()));
+    ExPolygon top_poly{pad_part};
+    ExPolygon bottom_poly =
+        offset_contour_only(pad_part, -scaled(cfg.bottom_offset()));
 
-        if (bottom_poly.empty()) continue;
-        thr();
-        
-        double z_min = -cfg.height, z_max = 0;
-        its_merge(ret, walls(top_poly.contour, bottom_poly.contour, z_max, z_min));
+    if (bottom_poly.empty()) return ret;
+    thr();
 
-        if (cfg.wing_height > 0. && add_cavity(ret, top_poly, cfg, thr))
-            z_max = -cfg.wing_height;
+    double z_min = -cfg.height, z_max = 0;
+    its_merge(ret, walls(top_poly.contour, bottom_poly.contour, z_max, z_min));
 
-        for (auto &h : bottom_poly.holes)
-            its_merge(ret, straight_walls(h, z_max, z_min));
-        
-        its_merge(ret, triangulate_expolygon_3d(bottom_poly, z_min, NORMALS_DOWN));
-        its_merge(ret, triangulate_expolygon_3d(top_poly, NORMALS_UP));
-    }
+    if (cfg.wing_height > 0. && add_cavity(ret, top_poly, cfg, thr))
+        z_max = -cfg.wing_height;
+
+    for (auto &h : bottom_poly.holes)
+        its_merge(ret, straight_walls(h, z_max, z_min));
+
+    its_merge(ret, triangulate_expolygon_3d(bottom_poly, z_min, NORMALS_DOWN));
+    its_merge(ret, triangulate_expolygon_3d(top_poly, NORMALS_UP));
 
     return ret;
 }
 
-indexed_triangle_set create_inner_pad_geometry(const ExPolygons & skeleton,
-                                               const PadConfig3D &cfg,
-                                               ThrowOnCancel      thr)
+indexed_triangle_set create_inner_pad_part(const ExPolygon &  pad_part,
+                                           const PadConfig3D &cfg,
+                                           ThrowOnCancel      thr)
 {
     indexed_triangle_set ret;
 
     double z_max = 0., z_min = -cfg.height;
-    for (const ExPolygon &pad_part : skeleton) {
-        thr();
-        its_merge(ret, straight_walls(pad_part.contour, z_max, z_min));
+    thr();
+    its_merge(ret, straight_walls(pad_part.contour, z_max, z_min));
 
-        for (auto &h : pad_part.holes)
-            its_merge(ret, straight_walls(h, z_max, z_min));
-    
-        its_merge(ret, triangulate_expolygon_3d(pad_part, z_min, NORMALS_DOWN));
-        its_merge(ret, triangulate_expolygon_3d(pad_part, z_max, NORMALS_UP));
-    }
+    for (auto &h : pad_part.holes)
+        its_merge(ret, straight_walls(h, z_max, z_min));
+
+    its_merge(ret, triangulate_expolygon_3d(pad_part, z_min, NORMALS_DOWN));
+    its_merge(ret, triangulate_expolygon_3d(pad_part, z_max, NORMALS_UP));
 
     return ret;
 }
@@ -448,11 +474,18 @@ indexed_triangle_set create_pad_geometry(const PadSkeleton &skelet,
     svg.Close();
 #endif
 
+    // The parts of the skeleton are triangulated independently, the outer
+    // ones first, then the inner ones.
     PadConfig3D cfg3d(cfg);
-    auto pg = create_outer_pad_geometry(skelet.outer, cfg3d, thr);
-    its_merge(pg, create_inner_pad_geometry(skelet.inner, cfg3d, thr));
-
-    return pg;
+    const size_t nouter = skelet.outer.size();
+    std::vector<indexed_triangle_set> parts(nouter + skelet.inner.size());
+    execution::for_each(ex_tbb, size_t(0), parts.size(), [&](size_t i) {
+        parts[i] = i < nouter ?
+                       create_outer_pad_part(skelet.outer[i], cfg3d, thr) :
+                       create_inner_pad_part(skelet.inner[i - nouter], cfg3d, thr);
+    });
+
+    return merge_ordered(std::move(parts));
 }
 
 indexed_triangle_set create_pad_geometry(const ExPolygons &supp_bp,
@@ -482,25 +515,45 @@ void pad_blueprint(const indexed_triangle_set &mesh,
 {
     if (mesh.empty()) return;
 
-    std::vector<ExPolygons> out = slice_mesh_ex(mesh, heights, thrfn);
+    pad_blueprint(slice_mesh_ex(mesh, heights, thrfn), output);
+}
 
-    size_t count = 0;
-    for(auto& o : out) count += o.size();
+void pad_blueprint(std::vector<ExPolygons> &&out, ExPolygons &output)
+{
+    // Simplify every polygon in parallel and collect the results in the
+    // input order.
+    auto simplify_all = [](const std::vector<const ExPolygon *> &src) {
+        std::vector<ExPolygons> simplified(src.size());
+        execution::for_each(ex_tbb, size_t(0), src.size(), [&src, &simplified](size_t i) {
+            simplified[i] = src[i]->simplify(scaled<double>(0.1));
+        }, 64 /* gransize */);
+
+        size_t count = 0;
+        for (const ExPolygons &s : simplified) count += s.size();
+
+        auto ret = reserve_vector<ExPolygon>(count);
+        for (ExPolygons &s : simplified)
+            for (ExPolygon &ep : s) ret.emplace_back(std::move(ep));
+
+        return ret;
+    };
+
+    std::vector<const ExPolygon *> src;
+    for (const ExPolygons &o : out)
+        for (const ExPolygon &e : o) src.emplace_back(&e);
 
     // Unification is expensive, a simplify also speeds up the pad generation
-    auto tmp = reserve_vector<ExPolygon>(count);
-    for(ExPolygons& o : out)
-        for(ExPolygon& e : o) {
-            auto&& exss = e.simplify(scaled<double>(0.1));
-            for(ExPolygon& ep : exss) tmp.emplace_back(std::move(ep));
-        }
+    ExPolygons tmp = simplify_all(src);
+    out = {};
 
     ExPolygons utmp = union_ex(tmp);
+    tmp = {};
 
-    for(auto& o : utmp) {
-        auto&& smp = o.simplify(scaled<double>(0.1));
-        output.insert(output.end(), smp.begin(), smp.end());
-    }
+    src.clear();
+    for (const ExPolygon &e : utmp) src.emplace_back(&e);
+
+    ExPolygons smp = simplify_all(src);
+    output.insert(output.end(), std::make_move_iterator(smp.begin()), std::make_move_iterator(smp.end()));
 }
 
 void pad_blueprint(const indexed_triangle_set &mesh,
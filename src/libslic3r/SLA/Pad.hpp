@@ -35,6 +35,9 @@ void pad_blueprint(
     const std::vector<float> &,     // Exact Z levels to sample
     ThrowOnCancel thrfn = [] {}); // Function that throws if cancel was requested
 
+// Same as above, with the slices of the input already calculated.
+void pad_blueprint(std::vector<ExPolygons> &&slices, ExPolygons &output);
+
 void pad_blueprint(
     const indexed_triangle_set &mesh,
     ExPolygons &                output,
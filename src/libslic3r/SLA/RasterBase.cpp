@@ -8,36 +8,237 @@
 
 #include <libslic3r/SLA/RasterBase.hpp>
 #include <libslic3r/SLA/AGGRaster.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
 // minz image write:
 #include <miniz.h>
 #include <algorithm>
 #include <cmath>
 #include <iterator>
 #include <cstdlib>
+#include <cstring>
 
 #include "agg/agg_gamma_functions.h"
 
 namespace Slic3r { namespace sla {
 
+namespace {
+
+// Uncompressed bytes of a strip which is deflated independently of the others.
+// Strips lose the back references across their boundaries, which costs next
+// to nothing at this size (the deflate window is 32 kB).
+constexpr size_t PNG_STRIP_BYTES = 512 * 1024;
+
+enum PNGFilter : std::uint8_t { pfNone = 0, pfSub = 1, pfUp = 2 };
+
+// Filter one row of the image into dst (which starts with the filter type
+// byte). Only None, Sub and Up are considered: SLA masks consist of black
+// rows, long runs of equal pixels (Sub) and repeated rows (Up). The filter
+// leaving the fewest non-zero bytes wins, which is cheap to evaluate and
+// is what matters for such images.
+void png_filter_row(const std::uint8_t *row,
+                    const std::uint8_t *prev_row,
+                    size_t              row_bytes,
+                    size_t              bpp,
+                    std::uint8_t       *dst)
+{
+    std::uint8_t *out = dst + 1;
+
+    if (prev_row && std::memcmp(row, prev_row, row_bytes) == 0) {
+        dst[0] = pfUp;
+        std::memset(out, 0, row_bytes);
+        return;
+    }
+
+    size_t bytes_none = 0;
+    for (size_t i = 0; i < row_bytes; ++i)
+        bytes_none += row[i] != 0;
+
+    if (bytes_none == 0) {
+        dst[0] = pfNone;
+        std::memset(out, 0, row_bytes);
+        return;
+    }
+
+    // The first pixel has no left neighbour, Sub keeps it as it is.
+    const size_t first = std::min(bpp, row_bytes);
+
+    size_t bytes_sub = first - size_t(std::count(row, row + first, std::uint8_t(0)));
+    for (size_t i = first; i < row_bytes; ++i)
+        bytes_sub += row[i] != row[i - bpp];
+
+    size_t bytes_up = bytes_none;
+    if (prev_row) {
+        bytes_up = 0;
+        for (size_t i = 0; i < row_bytes; ++i)
+            bytes_up += row[i] != prev_row[i];
+    }
+
+    if (bytes_none <= bytes_sub && bytes_none <= bytes_up) {
+        dst[0] = pfNone;
+        std::memcpy(out, row, row_bytes);
+    } else if (bytes_sub <= bytes_up) {
+        dst[0] = pfSub;
+        std::memcpy(out, row, first);
+        for (size_t i = first; i < row_bytes; ++i)
+            out[i] = std::uint8_t(row[i] - row[i - bpp]);
+    } else {
+        dst[0] = pfUp;
+        for (size_t i = 0; i < row_bytes; ++i)
+            out[i] = std::uint8_t(row[i] - prev_row[i]);
+    }
+}
+
+// Raw deflate of one strip. All the strips but the last one end with a sync
+// flush, which byte-aligns the output, so the strips can be concatenated.
+bool deflate_strip(const std::uint8_t  *data,
+                   size_t               len,
+                   int                  level,
+                   bool                 last,
+                   std::vector<uint8_t> &out)
+{
+    if (level == 0) {
+        // Stored blocks are byte-aligned by definition. Writing them directly
+        // is much faster than letting miniz do it.
+        static constexpr size_t MAX_STORED = 0xFFFF;
+        out.reserve(len + 5 * (len / MAX_STORED + 1));
+        size_t pos = 0;
+        do {
+            size_t        n      = std::min(len - pos, MAX_STORED);
+            std::uint16_t nlen   = std::uint16_t(n);
+            bool          bfinal = last && pos + n == len;
+            out.insert(out.end(), {std::uint8_t(bfinal ? 1 : 0),
+                                   std::uint8_t(nlen), std::uint8_t(nlen >> 8),
+                                   std::uint8_t(~nlen), std::uint8_t(std::uint16_t(~nlen) >> 8)});
+            out.insert(out.end(), data + pos, data + pos + n);
+            pos += n;
+        } while (pos < len);
+
+        return true;
+    }
+
+    auto put_buf = [](const void *buf, int buf_len, void *user) -> mz_bool {
+        auto  dst = static_cast<std::vector<uint8_t> *>(user);
+        auto *b   = static_cast<const std::uint8_t *>(buf);
+        dst->insert(dst->end(), b, b + buf_len);
+        return MZ_TRUE;
+    };
+
+    out.reserve(len / 16);
+
+    // The compressor state is too big for the stack.
+    auto comp  = std::make_unique<tdefl_compressor>();
+    int  flags = int(tdefl_create_comp_flags_from_zip_params(level, -MZ_DEFAULT_WINDOW_BITS,
+                                                             MZ_DEFAULT_STRATEGY));
+
+    return tdefl_init(comp.get(), put_buf, &out, flags) == TDEFL_STATUS_OKAY &&
+           tdefl_compress_buffer(comp.get(), data, len,
+                                 last ? TDEFL_FINISH : TDEFL_SYNC_FLUSH) ==
+               (last ? TDEFL_STATUS_DONE : TDEFL_STATUS_OKAY);
+}
+
+// Adler-32 of two concatenated blocks from the checksums of the blocks, the
+// same as adler32_combine() of zlib.
+std::uint32_t adler32_combine(std::uint32_t adler1, std::uint32_t adler2, size_t len2)
+{
+    constexpr std::uint32_t BASE = 65521;
+
+    std::uint32_t rem  = std::uint32_t(len2 % BASE);
+    std::uint32_t sum1 = adler1 & 0xffff;
+    std::uint32_t sum2 = (rem * sum1) % BASE;
+    sum1 += (adler2 & 0xffff) + BASE - 1;
+    sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + BASE - rem;
+    if (sum1 >= BASE) sum1 -= BASE;
+    if (sum1 >= BASE) sum1 -= BASE;
+    if (sum2 >= (BASE << 1)) sum2 -= (BASE << 1);
+    if (sum2 >= BASE) sum2 -= BASE;
+
+    return sum1 | (sum2 << 16);
+}
+
+void png_put_u32(std::vector<uint8_t> &buf, std::uint32_t v)
+{
+    buf.insert(buf.end(), {std::uint8_t(v >> 24), std::uint8_t(v >> 16),
+                           std::uint8_t(v >> 8), std::uint8_t(v)});
+}
+
+void png_put_chunk(std::vector<uint8_t> &buf, const char *type, const std::vector<uint8_t> &data)
+{
+    png_put_u32(buf, std::uint32_t(data.size()));
+    size_t type_pos = buf.size();
+    buf.insert(buf.end(), type, type + 4);
+    buf.insert(buf.end(), data.begin(), data.end());
+    png_put_u32(buf, std::uint32_t(mz_crc32(MZ_CRC32_INIT, buf.data() + type_pos, buf.size() - type_pos)));
+}
+
+} // namespace
+
 EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
                                            size_t      num_components)
 {
-    std::vector<uint8_t> buf;
-    size_t s = 0;
-    
-    void *rawdata = tdefl_write_image_to_png_file_in_memory(
-        ptr, int(w), int(h), int(num_components), &s);
-    
+    // PNG color types for 1 to 4 channels: gray, gray + alpha, RGB, RGBA.
+    static constexpr std::uint8_t color_types[] = {0, 4, 2, 6};
+
     // On error, data() will return an empty vector. No other info can be
     // retrieved from miniz anyway...
-    if (rawdata == nullptr) return EncodedRaster({}, "png");
-    
-    auto pptr = static_cast<std::uint8_t*>(rawdata);
-    
-    buf.reserve(s);
-    std::copy(pptr, pptr + s, std::back_inserter(buf));
-    
-    MZ_FREE(rawdata);
+    if (w == 0 || h == 0 || num_components < 1 || num_components > 4)
+        return EncodedRaster({}, "png");
+
+    const int    level     = std::clamp(compression_level, 0, 9);
+    const size_t row_bytes = w * num_components;
+    const size_t line      = row_bytes + 1;
+    const auto   src       = static_cast<const std::uint8_t *>(ptr);
+
+    std::vector<uint8_t> filtered(line * h);
+    execution::for_each(ex_tbb, size_t(0), h, [&](size_t row) {
+        png_filter_row(src + row * row_bytes, row > 0 ? src + (row - 1) * row_bytes : nullptr,
+                       row_bytes, num_components, filtered.data() + row * line);
+    }, execution::max_concurrency(ex_tbb));
+
+    const size_t rows_per_strip = std::max(size_t(1), PNG_STRIP_BYTES / line);
+    const size_t strip_cnt      = (h + rows_per_strip - 1) / rows_per_strip;
+
+    struct Strip { std::vector<uint8_t> data; std::uint32_t adler = 0; size_t len = 0; bool ok = false; };
+    std::vector<Strip> strips(strip_cnt);
+    execution::for_each(ex_tbb, size_t(0), strip_cnt, [&](size_t i) {
+        Strip &strip = strips[i];
+        const std::uint8_t *begin = filtered.data() + i * rows_per_strip * line;
+        strip.len   = std::min(rows_per_strip, h - i * rows_per_strip) * line;
+        strip.adler = std::uint32_t(mz_adler32(MZ_ADLER32_INIT, begin, strip.len));
+        strip.ok    = deflate_strip(begin, strip.len, level, i + 1 == strip_cnt, strip.data);
+    }, execution::max_concurrency(ex_tbb));
+
+    // zlib header: deflate with 32k window, FLEVEL as a hint of the level used,
+    // FCHECK making the 16 bit header divisible by 31.
+    std::vector<uint8_t> idat;
+    const std::uint8_t cmf = 0x78;
+    std::uint8_t flg = std::uint8_t((level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6);
+    flg = std::uint8_t(flg + (31 - (cmf * 256 + flg) % 31) % 31);
+    idat.insert(idat.end(), {cmf, flg});
+
+    std::uint32_t adler = MZ_ADLER32_INIT;
+    for (const Strip &strip : strips) {
+        if (!strip.ok)
+            return EncodedRaster({}, "png");
+        idat.insert(idat.end(), strip.data.begin(), strip.data.end());
+        adler = adler32_combine(adler, strip.adler, strip.len);
+    }
+    png_put_u32(idat, adler);
+
+    std::vector<uint8_t> ihdr;
+    png_put_u32(ihdr, std::uint32_t(w));
+    png_put_u32(ihdr, std::uint32_t(h));
+    // bit depth, color type, compression, filter method, no interlace
+    ihdr.insert(ihdr.end(), {8, color_types[num_components - 1], 0, 0, 0});
+
+    static constexpr std::uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+    std::vector<uint8_t> buf;
+    buf.reserve(std::size(signature) + idat.size() + 64);
+    buf.insert(buf.end(), std::begin(signature), std::end(signature));
+    png_put_chunk(buf, "IHDR", ihdr);
+    png_put_chunk(buf, "IDAT", idat);
+    png_put_chunk(buf, "IEND", {});
+
     return EncodedRaster(std::move(buf), "png");
 }
 
@@ -70,6 +271,21 @@ EncodedRaster PPMRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
     return EncodedRaster(std::move(buf), "ppm");
 }
 
+void RasterBase::foreach_pixel_run(const PixelRunFn &fn) const
+{
+    encode([&fn](const void *ptr, size_t w, size_t h, size_t num_components) {
+        auto px  = static_cast<const std::uint8_t *>(ptr);
+        auto end = px + w * h * num_components;
+        while (px < end) {
+            auto run_end = std::find_if(px, end, [value = *px](std::uint8_t p) { return p != value; });
+            fn(*px, size_t(run_end - px));
+            px = run_end;
+        }
+
+        return EncodedRaster{};
+    });
+}
+
 std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     const Resolution        &res,
     const PixelDim          &pxdim,
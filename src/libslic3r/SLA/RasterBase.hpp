@@ -105,9 +105,25 @@ public:
     virtual Trafo      trafo() const = 0;
     
     virtual EncodedRaster encode(RasterEncoder encoder) const = 0;
+
+    /// Receives the 8 bit grayscale pixels in row-major order as runs of
+    /// equal value.
+    using PixelRunFn = std::function<void(uint8_t value, size_t length)>;
+
+    /// Visit the pixels as runs for run-length based formats. The default
+    /// implementation scans the bitmap handed over to the encoder, thus it
+    /// reports nothing for vector rasters ignoring the encoder. Rasters
+    /// without a bitmap can provide the runs directly.
+    virtual void foreach_pixel_run(const PixelRunFn &fn) const;
 };
 
+// Rows are filtered with a heuristic tuned for mostly black masks and the
+// image is deflated in independent row strips in parallel. The strips are
+// joined into a single zlib stream, so the result is an ordinary PNG file.
 struct PNGRasterEncoder {
+    // Deflate level from 0 (no compression) to 9 (smallest), same as zlib.
+    int compression_level = 6;
+
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
 };
 
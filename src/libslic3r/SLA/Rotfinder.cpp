@@ -4,16 +4,19 @@
 ///|/
 #include <libslic3r/SLA/Rotfinder.hpp>
 #include <libslic3r/Execution/ExecutionTBB.hpp>
-#include <libslic3r/Optimize/BruteforceOptimizer.hpp>
+#include <libslic3r/Optimize/NLoptOptimizer.hpp>
 #include <libslic3r/Geometry.hpp>
 #include <limits>
 #include <thread>
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <iterator>
+#include <numeric>
+#include <optional>
 #include <vector>
-#include <cinttypes>
 #include <cstdlib>
 
 #include "libslic3r/PrintConfig.hpp"
@@ -43,32 +46,6 @@ std::array<Vec3f, 3> get_triangle_vertices(const TriangleMesh &mesh,
             mesh.its.vertices[face(2)]};
 }
 
-std::array<Vec3f, 3> get_transformed_triangle(const TriangleMesh &mesh,
-                                              const Transform3f & tr,
-                                              size_t              faceidx)
-{
-    const auto &tri = get_triangle_vertices(mesh, faceidx);
-    return {tr * tri[0], tr * tri[1], tr * tri[2]};
-}
-
-template<class T> Vec<3, T> normal(const std::array<Vec<3, T>, 3> &tri)
-{
-    Vec<3, T> U = tri[1] - tri[0];
-    Vec<3, T> V = tri[2] - tri[0];
-    return U.cross(V).normalized();
-}
-
-template<class T, class AccessFn>
-T sum_score(AccessFn &&accessfn, size_t facecount, size_t Nthreads)
-{
-    T  initv         = 0.;
-    auto   mergefn   = [](T a, T b) { return a + b; };
-    size_t grainsize = facecount / Nthreads;
-    size_t from = 0, to = facecount;
-
-    return execution::reduce(ex_tbb, from, to, initv, mergefn, accessfn, grainsize);
-}
-
 // Get area and normal of a triangle
 struct Facestats {
     Vec3f  normal;
@@ -84,37 +61,76 @@ struct Facestats {
     }
 };
 
-// Try to guess the number of support points needed to support a mesh
-double get_misalginment_score(const TriangleMesh &mesh, const Transform3f &tr)
-{
-    if (mesh.its.vertices.empty()) return NaNd;
+// Normals and areas of all the faces of a mesh, computed once and stored
+// in separate arrays. Rotating the mesh rotates the normals and keeps the
+// areas, so the score of a rotation can be computed from the rotation matrix
+// alone, without transforming the mesh.
+class MeshFacestats {
+    std::vector<float> m_nx, m_ny, m_nz, m_area, m_sqrt_area;
+    const indexed_triangle_set &m_its;
 
-    auto accessfn = [&mesh, &tr](size_t fi) {
-        Facestats fc{get_transformed_triangle(mesh, tr, fi)};
+public:
+    explicit MeshFacestats(const indexed_triangle_set &its) : m_its{its}
+    {
+        size_t facecount = its.indices.size();
+        m_nx.resize(facecount);
+        m_ny.resize(facecount);
+        m_nz.resize(facecount);
+        m_area.resize(facecount);
+        m_sqrt_area.resize(facecount);
+
+        execution::for_each(ex_tbb, size_t(0), facecount, [this, &its](size_t fi) {
+            const auto &face = its.indices[fi];
+            Facestats fc{{its.vertices[face(0)], its.vertices[face(1)], its.vertices[face(2)]}};
+            m_nx[fi]        = fc.normal.x();
+            m_ny[fi]        = fc.normal.y();
+            m_nz[fi]        = fc.normal.z();
+            m_area[fi]      = float(fc.area);
+            m_sqrt_area[fi] = float(std::sqrt(fc.area));
+        }, facecount / std::max(std::thread::hardware_concurrency(), 1u));
+    }
 
-        float score = fc.area
-                      * (std::abs(fc.normal.dot(Vec3f::UnitX()))
-                         + std::abs(fc.normal.dot(Vec3f::UnitY()))
-                         + std::abs(fc.normal.dot(Vec3f::UnitZ())));
+    size_t size() const { return m_area.size(); }
+    bool   empty() const { return m_area.empty(); }
 
-        // We should score against the alignment with the reference planes
-        return scaled<int_fast64_t>(score);
-    };
+    const indexed_triangle_set &its() const { return m_its; }
+
+    // The component of the rotated face normal along the given axis. The
+    // axis is a row of the rotation matrix.
+    float normal_along(size_t fi, const Vec3f &axis) const
+    {
+        return axis.x() * m_nx[fi] + axis.y() * m_ny[fi] + axis.z() * m_nz[fi];
+    }
+
+    float area(size_t fi) const { return m_area[fi]; }
+    float sqrt_area(size_t fi) const { return m_sqrt_area[fi]; }
+};
+
+// Try to guess the number of support points needed to support a mesh
+double get_misalginment_score(const MeshFacestats &fstats, const Matrix3f &rot)
+{
+    if (fstats.empty()) return NaNd;
+
+    const Vec3f rx = rot.row(X).transpose(), ry = rot.row(Y).transpose(),
+                rz = rot.row(Z).transpose();
 
-    size_t facecount = mesh.its.indices.size();
-    size_t Nthreads  = std::thread::hardware_concurrency();
-    double S = unscaled(sum_score<int_fast64_t>(accessfn, facecount, Nthreads));
+    // We should score against the alignment with the reference planes
+    double S = 0.;
+    for (size_t fi = 0; fi < fstats.size(); ++fi)
+        S += fstats.area(fi) * (std::abs(fstats.normal_along(fi, rx))
+                                + std::abs(fstats.normal_along(fi, ry))
+                                + std::abs(fstats.normal_along(fi, rz)));
 
-    return S / facecount;
+    return S / fstats.size();
 }
 
-// The score function for a particular face
-inline double get_supportedness_score(const Facestats &fc)
+// The score function for a particular face, given the cosine of the angle
+// between its normal and the DOWN vector.
+inline double get_supportedness_score(float cosphi, float sqrt_area)
 {
     // Simply get the angle (acos of dot product) between the face normal and
     // the DOWN vector.
-    float cosphi = fc.normal.dot(DOWN);
-    float phi = 1.f - std::acos(cosphi) / float(PI);
+    float phi = 1.f - std::acos(std::clamp(cosphi, -1.f, 1.f)) / float(PI);
 
     // Make the huge slopes more significant than the smaller slopes
     phi = phi * phi * phi;
@@ -122,68 +138,50 @@ inline double get_supportedness_score(const Facestats &fc)
     // Multiply with the square root of face area of the current face,
     // the area is less important as it grows.
     // This makes many smaller overhangs a bigger impact.
-    return std::sqrt(fc.area) * POINTS_PER_UNIT_AREA * phi;
+    return sqrt_area * POINTS_PER_UNIT_AREA * phi;
 }
 
 // Try to guess the number of support points needed to support a mesh
-double get_supportedness_score(const TriangleMesh &mesh, const Transform3f &tr)
+double get_supportedness_score(const MeshFacestats &fstats, const Matrix3f &rot)
 {
-    if (mesh.its.vertices.empty()) return NaNd;
+    if (fstats.empty()) return NaNd;
 
-    auto accessfn = [&mesh, &tr](size_t fi) {
-        Facestats fc{get_transformed_triangle(mesh, tr, fi)};
-        return scaled<int_fast64_t>(get_supportedness_score(fc));
-    };
+    const Vec3f down = rot.transpose() * DOWN;
 
-    size_t facecount = mesh.its.indices.size();
-    size_t Nthreads  = std::thread::hardware_concurrency();
-    double S = unscaled(sum_score<int_fast64_t>(accessfn, facecount, Nthreads));
+    double S = 0.;
+    for (size_t fi = 0; fi < fstats.size(); ++fi)
+        S += get_supportedness_score(fstats.normal_along(fi, down), fstats.sqrt_area(fi));
 
-    return S / facecount;
+    return S / fstats.size();
 }
 
-// Find transformed mesh ground level without copy and with parallel reduce.
-float find_ground_level(const TriangleMesh &mesh,
-                         const Transform3f & tr,
-                         size_t              threads)
+double get_supportedness_onfloor_score(const MeshFacestats &fstats,
+                                       const Matrix3f      &rot)
 {
-    size_t vsize = mesh.its.vertices.size();
+    if (fstats.empty()) return NaNd;
 
-    auto minfn = [](float a, float b) { return std::min(a, b); };
+    const indexed_triangle_set &its = fstats.its();
+    const Vec3f rz = rot.row(Z).transpose(), down = rot.transpose() * DOWN;
 
-    auto accessfn = [&mesh, &tr] (size_t vi) {
-        return (tr * mesh.its.vertices[vi]).z();
-    };
-
-    auto zmin = std::numeric_limits<float>::max();
-    size_t granularity = vsize / threads;
-    return execution::reduce(ex_tbb, size_t(0), vsize, zmin, minfn, accessfn, granularity);
-}
-
-double get_supportedness_onfloor_score(const TriangleMesh &mesh,
-                                       const Transform3f  &tr)
-{
-    if (mesh.its.vertices.empty()) return NaNd;
-
-    size_t Nthreads = std::thread::hardware_concurrency();
+    // Find the rotated mesh ground level
+    float zmin = std::numeric_limits<float>::max();
+    for (const Vec3f &v : its.vertices)
+        zmin = std::min(zmin, rz.dot(v));
 
-    float zmin = find_ground_level(mesh, tr, Nthreads);
     float zlvl = zmin + 0.1f; // Set up a slight tolerance from z level
 
-    auto accessfn = [&mesh, &tr, zlvl](size_t fi) {
-        std::array<Vec3f, 3> tri = get_transformed_triangle(mesh, tr, fi);
-        Facestats fc{tri};
-
-        if (tri[0].z() <= zlvl && tri[1].z() <= zlvl && tri[2].z() <= zlvl)
-            return -2 * fc.area * POINTS_PER_UNIT_AREA;
-
-        return get_supportedness_score(fc);
-    };
-
-    size_t facecount = mesh.its.indices.size();
-    double S = unscaled(sum_score<int_fast64_t>(accessfn, facecount, Nthreads));
+    double S = 0.;
+    for (size_t fi = 0; fi < fstats.size(); ++fi) {
+        const auto &face = its.indices[fi];
+        if (rz.dot(its.vertices[face(0)]) <= zlvl &&
+            rz.dot(its.vertices[face(1)]) <= zlvl &&
+            rz.dot(its.vertices[face(2)]) <= zlvl)
+            S += -2 * fstats.area(fi) * POINTS_PER_UNIT_AREA;
+        else
+            S += get_supportedness_score(fstats.normal_along(fi, down), fstats.sqrt_area(fi));
+    }
 
-    return S / facecount;
+    return S / fstats.size();
 }
 
 using XYRotation = std::array<double, 2>;
@@ -198,6 +196,11 @@ Transform3f to_transform3f(const XYRotation &rot)
     return rt;
 }
 
+Matrix3f to_matrix3f(const XYRotation &rot)
+{
+    return to_transform3f(rot).linear();
+}
+
 XYRotation from_transform3f(const Transform3f &tr)
 {
     Vec3d rot3 = Geometry::Transformation{tr.cast<double>()}.get_rotation();
@@ -271,7 +274,6 @@ std::array<double, N> find_min_score(Fn &&fn, It from, It to, StopCond &&stopfn)
 
     double score = std::numeric_limits<double>::max();
 
-    size_t Nthreads = std::thread::hardware_concurrency();
     size_t dist = std::distance(from, to);
     std::vector<double> scores(dist, score);
 
@@ -280,8 +282,7 @@ std::array<double, N> find_min_score(Fn &&fn, It from, It to, StopCond &&stopfn)
             if (stopfn()) return;
 
             scores[i] = fn(*(from + i));
-        },
-        dist / Nthreads);
+        });
 
     auto it = std::min_element(scores.begin(), scores.end());
 
@@ -291,18 +292,37 @@ std::array<double, N> find_min_score(Fn &&fn, It from, It to, StopCond &&stopfn)
     return ret;
 }
 
-} // namespace
+// The i-th point of the 2D Halton sequence scaled into [-PI, PI]^2. Any
+// prefix of the sequence covers the rotation space evenly, so the sampling
+// can be cut short at any point.
+XYRotation halton_rotation(size_t i)
+{
+    auto radical_inverse = [](size_t n, size_t base) {
+        double f = 1., r = 0.;
+        for (; n > 0; n /= base) {
+            f /= base;
+            r += f * (n % base);
+        }
+        return r;
+    };
 
+    return {-PI + 2 * PI * radical_inverse(i, 2),
+            -PI + 2 * PI * radical_inverse(i, 3)};
+}
 
+} // namespace
 
 template<unsigned MAX_ITER>
 struct RotfinderBoilerplate {
     static constexpr unsigned MAX_TRIES = MAX_ITER;
 
-    int status = 0, prev_status = 0;
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<int> status = 0, prev_status = 0;
     TriangleMesh mesh;
     unsigned max_tries;
     const RotOptimizeParams &params;
+    Clock::time_point start_time = Clock::now();
 
     // Assemble the mesh with the correct transformation to be used in rotation
     // optimization.
@@ -324,51 +344,160 @@ struct RotfinderBoilerplate {
         , params{p}
     {}
 
+    bool has_time_budget() const { return params.time_budget().count() > 0; }
+
+    // Fraction of the time budget spent so far, zero if there is no budget.
+    double time_spent() const
+    {
+        if (!has_time_budget())
+            return 0.;
+
+        std::chrono::duration<double> elapsed = Clock::now() - start_time;
+        return elapsed / params.time_budget();
+    }
+
+    // May be called concurrently from the parallel evaluations.
     void statusfn() {
-        int s = status * 100 / max_tries;
-        if (s != prev_status) {
-            params.statuscb()(s);
-            prev_status = s;
-        }
+        int tries = std::max(int(max_tries), 1);
+        int s = std::max(++status * 100 / tries, int(time_spent() * 100));
+        s = std::min(s, 100);
 
-        ++status;
+        int prev = prev_status.load();
+        if (s > prev && prev_status.compare_exchange_strong(prev, s))
+            params.statuscb()(s);
     }
 
-    bool stopcond() { return ! params.statuscb()(-1); }
+    bool stopcond() { return ! params.statuscb()(-1) || time_spent() >= 1.; }
 };
 
+namespace {
+
+// Search the whole XY rotation space for the minimum of objfn in two phases.
+// The space is first sampled with a low discrepancy sequence, evaluating the
+// samples in parallel. Then a local optimizer is started from each of the
+// best few distinct samples, again in parallel, and the best of the local
+// optima is returned. Half of the evaluations of bp.max_tries are used for
+// the sampling, the other half is divided among the local searches.
+//
+// With a time budget, the sampling stops after half of the budget and the
+// local searches are stopped when it runs out, so the best rotation found
+// so far is always returned in time.
+template<class Bp, class Fn>
+XYRotation find_min_rotation(Bp &bp, Fn &&objfn)
+{
+    static constexpr size_t MAX_STARTS = 8;
+
+    // Samples are evaluated in batches to check the time budget in between.
+    static constexpr size_t SAMPLE_BATCH = 64;
+
+    size_t num_samples = std::max(bp.max_tries / 2, 1u);
+    size_t max_local_iter = std::max(bp.max_tries / (2 * MAX_STARTS), size_t(10));
+
+    auto samples = reserve_vector<XYRotation>(num_samples);
+
+    // Start with the current orientation of the object
+    samples.emplace_back(XYRotation{0., 0.});
+    for (size_t i = 1; i < num_samples; ++i)
+        samples.emplace_back(halton_rotation(i));
+
+    std::vector<double> scores(num_samples, std::numeric_limits<double>::max());
+
+    auto sampling_done = [&bp] {
+        return bp.stopcond() || (bp.has_time_budget() && bp.time_spent() >= .5);
+    };
+
+    size_t evaluated = 0;
+    while (evaluated < num_samples && (evaluated == 0 || !sampling_done())) {
+        size_t to = std::min(evaluated + SAMPLE_BATCH, num_samples);
+        execution::for_each(ex_tbb, evaluated, to, [&](size_t i) {
+            if (bp.stopcond()) return;
+
+            bp.statusfn();
+            scores[i] = objfn(samples[i]);
+        });
+        evaluated = to;
+    }
+
+    std::vector<size_t> order(evaluated);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(), [&scores](size_t a, size_t b) {
+        return scores[a] < scores[b];
+    });
+
+    // The best samples which are not in the vicinity of an even better one.
+    // The vicinity is the average distance of the samples in one dimension.
+    double radius = 2 * PI / std::sqrt(double(evaluated));
+    auto starts = reserve_vector<size_t>(MAX_STARTS);
+    for (size_t i : order) {
+        if (starts.size() == MAX_STARTS || scores[i] == std::numeric_limits<double>::max())
+            break;
+
+        bool isolated = std::none_of(starts.begin(), starts.end(), [&](size_t s) {
+            return std::abs(samples[s][X] - samples[i][X]) < radius &&
+                   std::abs(samples[s][Y] - samples[i][Y]) < radius;
+        });
+
+        if (isolated)
+            starts.emplace_back(i);
+    }
+
+    if (starts.empty())
+        return samples.front();
+
+    std::vector<opt::Result<2>> results(starts.size());
+    execution::for_each(ex_tbb, size_t(0), starts.size(), [&](size_t n) {
+        const XYRotation &init = samples[starts[n]];
+        results[n].optimum = init;
+        results[n].score   = scores[starts[n]];
+
+        opt::Optimizer<opt::AlgNLoptSubplex> solver(
+            opt::StopCriteria{}.max_iterations(max_local_iter)
+                               .rel_score_diff(1e-6)
+                               .stop_condition([&bp] { return bp.stopcond(); }));
+
+        auto bounds = opt::bounds({{init[X] - radius, init[X] + radius},
+                                   {init[Y] - radius, init[Y] + radius}});
+
+        auto r = solver.to_min().optimize([&bp, &objfn](const XYRotation &rot) {
+            bp.statusfn();
+            return objfn(rot);
+        }, init, bounds);
+
+        if (r.score < results[n].score)
+            results[n] = r;
+    });
+
+    auto best = std::min_element(results.begin(), results.end(),
+                                 [](const opt::Result<2> &a, const opt::Result<2> &b) {
+                                     return a.score < b.score;
+                                 });
+
+    return best->optimum;
+}
+
+} // namespace
+
 Vec2d find_best_misalignment_rotation(const ModelObject &      mo,
                                       const RotOptimizeParams &params)
 {
     RotfinderBoilerplate<1000> bp{mo, params};
-
-    // Preparing the optimizer.
-    size_t gridsize = std::sqrt(bp.max_tries);
-    opt::Optimizer<opt::AlgBruteForce> solver(
-        opt::StopCriteria{}.max_iterations(bp.max_tries)
-                           .stop_condition([&bp] { return bp.stopcond(); }),
-        gridsize
-    );
+    MeshFacestats fstats{bp.mesh.its};
 
     // We are searching rotations around only two axes x, y. Thus the
-    // problem becomes a 2 dimensional optimization task.
-    // We can specify the bounds for a dimension in the following way:
-    auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
-
-    auto result = solver.to_max().optimize(
-        [&bp] (const XYRotation &rot)
-        {
-            bp.statusfn();
-            return get_misalginment_score(bp.mesh, to_transform3f(rot));
-        }, opt::initvals({0., 0.}), bounds);
+    // problem becomes a 2 dimensional optimization task. The misalignment
+    // is maximized.
+    XYRotation rot = find_min_rotation(bp, [&fstats](const XYRotation &rot) {
+        return -get_misalginment_score(fstats, to_matrix3f(rot));
+    });
 
-    return {result.optimum[0], result.optimum[1]};
+    return {rot[0], rot[1]};
 }
 
 Vec2d find_least_supports_rotation(const ModelObject &      mo,
                                    const RotOptimizeParams &params)
 {
     RotfinderBoilerplate<1000> bp{mo, params};
+    MeshFacestats fstats{bp.mesh.its};
 
     SLAPrintObjectConfig pocfg;
     if (params.print_config())
@@ -387,10 +516,9 @@ Vec2d find_least_supports_rotation(const ModelObject &      mo,
         // If the model can be placed on the bed directly, we only need to
         // check the 3D convex hull face rotations.
 
-        auto objfn = [&bp](const XYRotation &rot) {
+        auto objfn = [&bp, &fstats](const XYRotation &rot) {
             bp.statusfn();
-            Transform3f tr = to_transform3f(rot);
-            return get_supportedness_onfloor_score(bp.mesh, tr);
+            return get_supportedness_onfloor_score(fstats, to_matrix3f(rot));
         };
 
         rot = find_min_score<2>(objfn, inputs.begin(), inputs.end(), [&bp] {
@@ -398,48 +526,34 @@ Vec2d find_least_supports_rotation(const ModelObject &      mo,
         });
 
     } else {
-        // Preparing the optimizer.
-        size_t gridsize = std::sqrt(bp.max_tries); // 2D grid has gridsize^2 calls
-        opt::Optimizer<opt::AlgBruteForce> solver(
-            opt::StopCriteria{}.max_iterations(bp.max_tries)
-                               .stop_condition([&bp] { return bp.stopcond(); }),
-            gridsize
-        );
-
         // We are searching rotations around only two axes x, y. Thus the
         // problem becomes a 2 dimensional optimization task.
-        // We can specify the bounds for a dimension in the following way:
-        auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
-
-        auto result = solver.to_min().optimize(
-            [&bp] (const XYRotation &rot)
-            {
-                bp.statusfn();
-                return get_supportedness_score(bp.mesh, to_transform3f(rot));
-            }, opt::initvals({0., 0.}), bounds);
-
-        // Save the result
-        rot = result.optimum;
+        rot = find_min_rotation(bp, [&fstats](const XYRotation &rot) {
+            return get_supportedness_score(fstats, to_matrix3f(rot));
+        });
     }
 
     return {rot[0], rot[1]};
 }
 
-inline BoundingBoxf3 bounding_box_with_tr(const indexed_triangle_set &its,
-                                          const Transform3f &tr)
+// Height of the mesh rotated with rot, only the Z row of the rotation is used.
+inline float z_height_with_rot(const indexed_triangle_set &its,
+                               const Matrix3f &rot)
 {
     if (its.vertices.empty())
-        return {};
+        return 0.f;
 
-    Vec3f bmin = tr * its.vertices.front(), bmax = tr * its.vertices.front();
+    const Vec3f rz = rot.row(Z).transpose();
+    float zmin = std::numeric_limits<float>::max();
+    float zmax = std::numeric_limits<float>::lowest();
 
     for (const Vec3f &p : its.vertices) {
-        Vec3f pp = tr * p;
-        bmin = pp.cwiseMin(bmin);
-        bmax = pp.cwiseMax(bmax);
+        float z = rz.dot(p);
+        zmin = std::min(zmin, z);
+        zmax = std::max(zmax, z);
     }
 
-    return {bmin.cast<double>(), bmax.cast<double>()};
+    return zmax - zmin;
 }
 
 Vec2d find_min_z_height_rotation(const ModelObject &mo,
@@ -475,8 +589,7 @@ Vec2d find_min_z_height_rotation(const ModelObject &mo,
 
     auto objfn = [&bp, &chull](const XYRotation &rot) {
         bp.statusfn();
-        Transform3f tr = to_transform3f(rot);
-        return bounding_box_with_tr(chull.its, tr).size().z();
+        return z_height_with_rot(chull.its, to_matrix3f(rot));
     };
 
     XYRotation rot = find_min_score<2>(objfn, inputs.begin(), inputs.end(), [&bp] {
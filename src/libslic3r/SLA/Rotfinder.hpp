@@ -7,6 +7,7 @@
 
 #include <libslic3r/Point.hpp>
 #include <functional>
+#include <chrono>
 #include <array>
 #include <utility>
 
@@ -25,6 +26,7 @@ class RotOptimizeParams {
     float m_accuracy = 1.;
     const DynamicPrintConfig *m_print_config = nullptr;
     RotOptimizeStatusCB m_statuscb = [](int) { return true; };
+    std::chrono::milliseconds m_time_budget{0};
 
 public:
 
@@ -40,9 +42,18 @@ public:
         return *this;
     }
 
+    // Progressive mode: stop the search when the given time is spent and
+    // return the best rotation found so far. Zero means no limit.
+    RotOptimizeParams &time_budget(std::chrono::milliseconds t)
+    {
+        m_time_budget = t;
+        return *this;
+    }
+
     float accuracy() const { return m_accuracy; }
     const DynamicPrintConfig * print_config() const { return m_print_config; }
     const RotOptimizeStatusCB &statuscb() const { return m_statuscb; }
+    std::chrono::milliseconds time_budget() const { return m_time_budget; }
 };
 
 /**
@@ -50,8 +61,9 @@ public:
   *
   * @param modelobj The model object representing the 3d mesh.
   * @param accuracy The optimization accuracy from 0.0f to 1.0f. Currently,
-  * the nlopt genetic optimizer is used and the number of iterations is
-  * accuracy * 100000. This can change in the future.
+  * the rotation space is sampled and the best samples are refined by
+  * parallel local searches, the number of evaluations is accuracy * 1000.
+  * This can change in the future.
   * @param statuscb A status indicator callback called with the int
   * argument spanning from 0 to 100. May not reach 100 if the optimization finds
   * an optimum before max iterations are reached. It should return a boolean
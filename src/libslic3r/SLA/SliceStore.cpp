@@ -0,0 +1,304 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <libslic3r/SLA/SliceStore.hpp>
+
+#include <mutex>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <miniz.h>
+
+#include <libslic3r/Exception.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+
+namespace Slic3r { namespace sla {
+
+namespace {
+
+// Compression level of the layers, the encoded deltas deflate well even with
+// the fastest level.
+constexpr int DeflateLevel = 1;
+
+void write_varint(std::vector<uint8_t> &buf, uint64_t v)
+{
+    while (v >= 0x80) {
+        buf.emplace_back(uint8_t(v) | 0x80);
+        v >>= 7;
+    }
+    buf.emplace_back(uint8_t(v));
+}
+
+uint64_t read_varint(const uint8_t *&p, const uint8_t *end)
+{
+    uint64_t v = 0;
+    for (int shift = 0; p != end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        v |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return v;
+    }
+
+    throw Slic3r::RuntimeError("Corrupted SLA slice data");
+}
+
+uint64_t zigzag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+int64_t  unzigzag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+void encode(std::vector<uint8_t> &buf, const Polygon &poly)
+{
+    write_varint(buf, poly.points.size());
+    Point prev(0, 0);
+    for (const Point &p : poly.points) {
+        write_varint(buf, zigzag(int64_t(p.x()) - int64_t(prev.x())));
+        write_varint(buf, zigzag(int64_t(p.y()) - int64_t(prev.y())));
+        prev = p;
+    }
+}
+
+std::vector<uint8_t> encode(const ExPolygons &slice)
+{
+    size_t npoints = 0;
+    for (const ExPolygon &expoly : slice)
+        npoints += expoly.num_contours() + count_points(expoly);
+
+    // Most of the deltas of fine slices fit into two bytes per coordinate.
+    std::vector<uint8_t> buf;
+    buf.reserve(8 + 4 * npoints);
+
+    write_varint(buf, slice.size());
+    for (const ExPolygon &expoly : slice) {
+        write_varint(buf, expoly.holes.size());
+        encode(buf, expoly.contour);
+        for (const Polygon &hole : expoly.holes)
+            encode(buf, hole);
+    }
+
+    return buf;
+}
+
+void decode(const uint8_t *&p, const uint8_t *end, Polygon &poly)
+{
+    size_t n = read_varint(p, end);
+    poly.points.reserve(n);
+    Point prev(0, 0);
+    for (size_t i = 0; i < n; ++i) {
+        coord_t x = coord_t(int64_t(prev.x()) + unzigzag(read_varint(p, end)));
+        coord_t y = coord_t(int64_t(prev.y()) + unzigzag(read_varint(p, end)));
+        prev = poly.points.emplace_back(x, y);
+    }
+}
+
+ExPolygons decode(const uint8_t *p, const uint8_t *end)
+{
+    ExPolygons slice(read_varint(p, end));
+    for (ExPolygon &expoly : slice) {
+        expoly.holes.resize(read_varint(p, end));
+        decode(p, end, expoly.contour);
+        for (Polygon &hole : expoly.holes)
+            decode(p, end, hole);
+    }
+
+    return slice;
+}
+
+std::vector<uint8_t> deflate_layer(const std::vector<uint8_t> &src)
+{
+    mz_ulong len = mz_compressBound(mz_ulong(src.size()));
+    std::vector<uint8_t> out(len);
+    if (mz_compress2(out.data(), &len, src.data(), mz_ulong(src.size()), DeflateLevel) != MZ_OK)
+        throw Slic3r::RuntimeError("Failed to compress SLA slice data");
+
+    out.resize(len);
+    out.shrink_to_fit();
+    return out;
+}
+
+std::vector<uint8_t> inflate_layer(const std::vector<uint8_t> &src, uint64_t size)
+{
+    std::vector<uint8_t> out(size);
+    mz_ulong len = mz_ulong(size);
+    if (mz_uncompress(out.data(), &len, src.data(), mz_ulong(src.size())) != MZ_OK || len != size)
+        throw Slic3r::RuntimeError("Corrupted SLA slice data");
+
+    return out;
+}
+
+} // namespace
+
+class SliceStore::SpillFile
+{
+    boost::filesystem::path  m_path;
+    boost::nowide::fstream   m_stream;
+    uint64_t                 m_size = 0;
+    mutable std::mutex       m_mutex;
+
+public:
+    SpillFile()
+        : m_path{boost::filesystem::temp_directory_path() /
+                 boost::filesystem::unique_path("prusaslicer-sla-slices-%%%%-%%%%-%%%%.bin")}
+    {
+        m_stream.open(m_path.string(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!m_stream)
+            throw Slic3r::FileIOError("Failed to create a temporary file for SLA slices: " + m_path.string());
+    }
+
+    ~SpillFile()
+    {
+        m_stream.close();
+        boost::system::error_code ec;
+        boost::filesystem::remove(m_path, ec);
+        if (ec)
+            BOOST_LOG_TRIVIAL(warning) << "Failed to remove " << m_path.string() << ": " << ec.message();
+    }
+
+    uint64_t size() const { return m_size; }
+
+    uint64_t write(const std::vector<uint8_t> &data)
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        uint64_t offset = m_size;
+        m_stream.seekp(std::streamoff(offset));
+        m_stream.write(reinterpret_cast<const char *>(data.data()), std::streamsize(data.size()));
+        if (!m_stream)
+            throw Slic3r::FileIOError("Failed to write SLA slices to " + m_path.string());
+
+        m_size += data.size();
+        return offset;
+    }
+
+    std::vector<uint8_t> read(uint64_t offset, uint64_t size)
+    {
+        std::vector<uint8_t> data(size);
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stream.seekg(std::streamoff(offset));
+        m_stream.read(reinterpret_cast<char *>(data.data()), std::streamsize(size));
+        if (!m_stream)
+            throw Slic3r::FileIOError("Failed to read SLA slices from " + m_path.string());
+
+        return data;
+    }
+};
+
+SliceStore::SliceStore() = default;
+SliceStore::~SliceStore() = default;
+
+void SliceStore::clear()
+{
+    m_plain  = {};
+    m_layers = {};
+    m_file.reset();
+}
+
+void SliceStore::store_again(const SliceStoreParams &params)
+{
+    if (params == m_params)
+        return;
+
+    std::vector<ExPolygons> layers = m_params.is_plain() ? std::move(m_plain) : get_all();
+    assign(std::move(layers), params);
+}
+
+void SliceStore::assign(std::vector<ExPolygons> &&layers, const SliceStoreParams &params)
+{
+    clear();
+    m_params = params;
+
+    if (m_params.is_plain()) {
+        m_plain = std::move(layers);
+        return;
+    }
+
+    m_layers.resize(layers.size());
+    execution::for_each(ex_tbb, size_t(0), layers.size(), [this, &layers](size_t i) {
+        Layer &layer = m_layers[i];
+        layer.data = encode(layers[i]);
+        layer.encoded_size = layer.data.size();
+        if (m_params.compressed)
+            layer.data = deflate_layer(layer.data);
+        else
+            layer.data.shrink_to_fit();
+
+        layers[i] = {}; // release the source early to keep the peak low
+    });
+
+    // The bottom layers stay in memory, the rest is spilled to the disk.
+    size_t resident = 0;
+    for (Layer &layer : m_layers) {
+        if (resident + layer.data.size() <= m_params.memory_limit) {
+            resident += layer.data.size();
+            continue;
+        }
+
+        if (!m_file)
+            m_file = std::make_unique<SpillFile>();
+
+        layer.file_size   = layer.data.size();
+        layer.file_offset = m_file->write(layer.data);
+        layer.spilled     = true;
+        layer.data        = {};
+    }
+
+    if (m_file)
+        BOOST_LOG_TRIVIAL(debug) << "SLA slices: " << resident << " bytes in memory, "
+                                 << m_file->size() << " bytes spilled to the disk";
+}
+
+ExPolygons SliceStore::get(size_t idx) const
+{
+    if (m_params.is_plain())
+        return m_plain[idx];
+
+    const Layer &layer = m_layers[idx];
+
+    std::vector<uint8_t> spilled;
+    if (layer.spilled)
+        spilled = m_file->read(layer.file_offset, layer.file_size);
+
+    const std::vector<uint8_t> &data = layer.spilled ? spilled : layer.data;
+    if (m_params.compressed) {
+        std::vector<uint8_t> encoded = inflate_layer(data, layer.encoded_size);
+        return decode(encoded.data(), encoded.data() + encoded.size());
+    }
+
+    return decode(data.data(), data.data() + data.size());
+}
+
+std::vector<ExPolygons> SliceStore::get_all() const
+{
+    if (m_params.is_plain())
+        return m_plain;
+
+    std::vector<ExPolygons> out(m_layers.size());
+    execution::for_each(ex_tbb, size_t(0), out.size(), [this, &out](size_t i) {
+        out[i] = get(i);
+    });
+
+    return out;
+}
+
+size_t SliceStore::memory_usage() const
+{
+    size_t bytes = 0;
+    if (m_params.is_plain()) {
+        for (const ExPolygons &slice : m_plain)
+            for (const ExPolygon &expoly : slice)
+                bytes += sizeof(ExPolygon) + expoly.holes.size() * sizeof(Polygon) +
+                         count_points(expoly) * sizeof(Point);
+    } else {
+        for (const Layer &layer : m_layers)
+            bytes += layer.data.size();
+    }
+
+    return bytes;
+}
+
+size_t SliceStore::spilled_size() const
+{
+    return m_file ? size_t(m_file->size()) : 0;
+}
+
+}} // namespace Slic3r::sla
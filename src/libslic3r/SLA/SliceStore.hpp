@@ -0,0 +1,106 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef SLA_SLICESTORE_HPP
+#define SLA_SLICESTORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "libslic3r/ExPolygon.hpp"
+
+namespace Slic3r { namespace sla {
+
+struct SliceStoreParams
+{
+    static constexpr size_t Unlimited = std::numeric_limits<size_t>::max();
+
+    // Keep the slices delta encoded instead of as ExPolygons. Implied by
+    // compressed and by a memory limit.
+    bool encoded = false;
+
+    // Keep the slices delta encoded and deflated instead of as ExPolygons.
+    bool compressed = false;
+
+    // Bytes of encoded slices to keep in memory. The layers above the limit
+    // are written to a temporary file and read back when requested.
+    size_t memory_limit = Unlimited;
+
+    bool is_plain() const
+    {
+        return !encoded && !compressed && memory_limit == Unlimited;
+    }
+
+    bool operator==(const SliceStoreParams &rhs) const
+    {
+        return encoded == rhs.encoded && compressed == rhs.compressed && memory_limit == rhs.memory_limit;
+    }
+    bool operator!=(const SliceStoreParams &rhs) const { return !(*this == rhs); }
+};
+
+// Storage of the 2D slices of an SLA object, one ExPolygons per layer.
+//
+// With the default parameters the slices are kept as they are. Otherwise each
+// layer is encoded as zigzag varints of the point deltas, which is several
+// times smaller than the Point vectors, and deflated if requested. The layers
+// which do not fit into the memory limit are spilled to a temporary file,
+// which is removed with the store.
+//
+// Reading the layers is thread safe.
+class SliceStore
+{
+public:
+    SliceStore();
+    ~SliceStore();
+
+    SliceStore(const SliceStore &) = delete;
+    SliceStore &operator=(const SliceStore &) = delete;
+
+    // Replaces the content of the store with the given layers.
+    void assign(std::vector<ExPolygons> &&layers, const SliceStoreParams &params = {});
+    void clear();
+
+    // Stores the content again with different parameters, the slices stay
+    // the same.
+    void store_again(const SliceStoreParams &params);
+
+    const SliceStoreParams &params() const { return m_params; }
+
+    size_t size() const { return m_params.is_plain() ? m_plain.size() : m_layers.size(); }
+    bool   empty() const { return size() == 0; }
+
+    // Layer idx decoded, reading it from the disk if it was spilled.
+    ExPolygons get(size_t idx) const;
+
+    std::vector<ExPolygons> get_all() const;
+
+    // Bytes of the slices resident in memory (estimated for the plain layers)
+    // and of the spilled ones.
+    size_t memory_usage() const;
+    size_t spilled_size() const;
+
+private:
+    struct Layer
+    {
+        std::vector<uint8_t> data;           // encoded, possibly deflated
+        uint64_t             encoded_size = 0; // size before deflating
+        uint64_t             file_offset  = 0;
+        uint64_t             file_size    = 0;
+        bool                 spilled      = false;
+    };
+
+    class SpillFile;
+
+    SliceStoreParams           m_params;
+    std::vector<ExPolygons>    m_plain;
+    std::vector<Layer>         m_layers;
+    std::unique_ptr<SpillFile> m_file;
+};
+
+}} // namespace Slic3r::sla
+
+#endif // SLA_SLICESTORE_HPP
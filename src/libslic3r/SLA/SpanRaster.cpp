@@ -0,0 +1,145 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <libslic3r/SLA/SpanRaster.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <agg/agg_scanline_p.h>
+#include <agg/agg_gamma_functions.h>
+
+namespace Slic3r { namespace sla {
+
+agg::path_storage SpanRaster::to_path(const Polygon &poly) const
+{
+    agg::path_storage path;
+
+    auto px = [this](const Point &p) { return p.x() * m_pxdim_scaled.w_mm; };
+    auto py = [this](const Point &p) { return p.y() * m_pxdim_scaled.h_mm; };
+    auto add = [this, &path, &px, &py](const Point &p, bool first) {
+        double x = m_trafo.flipXY ? py(p) : px(p);
+        double y = m_trafo.flipXY ? px(p) : py(p);
+        if (first)
+            path.move_to(x, y);
+        else
+            path.line_to(x, y);
+    };
+
+    if (poly.points.empty())
+        return path;
+
+    add(poly.points.front(), true);
+    for (auto it = std::next(poly.points.begin()); it != poly.points.end(); ++it)
+        add(*it, false);
+    add(poly.points.front(), false);
+
+    path.translate_all_paths(m_trafo.center_x * m_pxdim_scaled.w_mm,
+                             m_trafo.center_y * m_pxdim_scaled.h_mm);
+
+    if (m_trafo.mirror_x) path.flip_x(0, double(m_resolution.width_px));
+    if (m_trafo.mirror_y) path.flip_y(0, double(m_resolution.height_px));
+
+    return path;
+}
+
+void SpanRaster::draw(const ExPolygon &poly)
+{
+    m_rasterizer.add_path(to_path(poly.contour));
+    for (const Polygon &h : poly.holes)
+        m_rasterizer.add_path(to_path(h));
+}
+
+void SpanRaster::foreach_pixel_run(const PixelRunFn &fn) const
+{
+    const size_t w = m_resolution.width_px;
+    const size_t h = m_resolution.height_px;
+
+    // Pixels are reported in row-major order, pos is the first pixel not
+    // reported yet. Equal neighbouring pixels are merged into one run.
+    size_t  pos       = 0;
+    uint8_t run_value = 0;
+    size_t  run_len   = 0;
+
+    auto push = [&fn, &run_value, &run_len](uint8_t value, size_t len) {
+        if (len == 0)
+            return;
+
+        if (value == run_value) {
+            run_len += len;
+        } else {
+            if (run_len > 0)
+                fn(run_value, run_len);
+            run_value = value;
+            run_len   = len;
+        }
+    };
+
+    // Pixels [x, x + len) of the given row, either all with the value
+    // covers[0] (solid span) or each with its own cover.
+    auto push_span = [&](size_t row, int x, int len, const uint8_t *covers, bool solid) {
+        int x0 = std::max(x, 0), x1 = std::min(x + len, int(w));
+        if (x0 >= x1)
+            return;
+
+        size_t at = row * w + size_t(x0);
+        push(0, at - pos);
+        if (solid)
+            push(covers[0], size_t(x1 - x0));
+        else
+            for (int i = x0; i < x1; ++i)
+                push(covers[i - x], 1);
+
+        pos = at + size_t(x1 - x0);
+    };
+
+    if (m_rasterizer.rewind_scanlines()) {
+        agg::scanline_p8 sl;
+        sl.reset(m_rasterizer.min_x(), m_rasterizer.max_x());
+
+        while (m_rasterizer.sweep_scanline(sl)) {
+            if (sl.y() < 0 || size_t(sl.y()) >= h)
+                continue;
+
+            auto span = sl.begin();
+            for (unsigned n = sl.num_spans(); n > 0; --n, ++span) {
+                if (span->len < 0)
+                    push_span(size_t(sl.y()), span->x, -span->len, span->covers, true);
+                else
+                    push_span(size_t(sl.y()), span->x, span->len, span->covers, false);
+            }
+        }
+    }
+
+    push(0, w * h - pos);
+    if (run_len > 0)
+        fn(run_value, run_len);
+}
+
+EncodedRaster SpanRaster::encode(RasterEncoder encoder) const
+{
+    std::vector<uint8_t> buf;
+    buf.reserve(m_resolution.pixels());
+    foreach_pixel_run([&buf](uint8_t value, size_t len) { buf.insert(buf.end(), len, value); });
+
+    return encoder(buf.data(), m_resolution.width_px, m_resolution.height_px, 1);
+}
+
+std::unique_ptr<RasterBase> create_raster_grayscale_spans(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma,
+    const RasterBase::Trafo &tr)
+{
+    std::unique_ptr<RasterBase> rst;
+
+    if (gamma > 0)
+        rst = std::make_unique<SpanRaster>(res, pxdim, tr, agg::gamma_power(gamma));
+    else
+        rst = std::make_unique<SpanRaster>(res, pxdim, tr, agg::gamma_threshold(.5));
+
+    return rst;
+}
+
+}} // namespace Slic3r::sla
@@ -0,0 +1,80 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef SLA_SPANRASTER_HPP
+#define SLA_SPANRASTER_HPP
+
+#include <libslic3r/SLA/RasterBase.hpp>
+#include "libslic3r/ExPolygon.hpp"
+
+#include <agg/agg_basics.h>
+#include <agg/agg_rasterizer_scanline_aa.h>
+#include <agg/agg_path_storage.h>
+
+namespace Slic3r { namespace sla {
+
+/*
+ * Anti-aliased monochrome raster which never allocates the bitmap. The drawn
+ * polygons are only accumulated in an AGG scanline rasterizer, whose memory is
+ * proportional to the length of the contours, and the pixels are produced by
+ * sweeping the scanlines when the raster is encoded.
+ *
+ * All the polygons are filled in one pass with the non-zero rule, so the
+ * coverage of touching polygons is summed rather than blended like in
+ * AGGRaster. This only makes a difference at the shared edge pixels.
+ *
+ * Consumers of pixel runs (see RasterBase::foreach_pixel_run()) get the spans
+ * directly, bitmap encoders get a bitmap assembled on the fly.
+ */
+class SpanRaster : public RasterBase {
+    Resolution m_resolution;
+    PixelDim   m_pxdim_scaled; // used for scaled coordinate polygons
+    Trafo      m_trafo;
+
+    // Sweeping the scanlines sorts the cells, which is mutating in AGG.
+    // Drawing after the raster was encoded starts a new image.
+    mutable agg::rasterizer_scanline_aa<> m_rasterizer;
+
+    agg::path_storage to_path(const Polygon &poly) const;
+
+public:
+    template<class GammaFn>
+    SpanRaster(const Resolution &res,
+               const PixelDim   &pd,
+               const Trafo      &trafo,
+               GammaFn         &&gammafn)
+        : m_resolution(res)
+        , m_pxdim_scaled(SCALING_FACTOR, SCALING_FACTOR)
+        , m_trafo(trafo)
+    {
+        assert(pd.w_mm != 0 && pd.h_mm != 0);
+        if (pd.w_mm != 0 && pd.h_mm != 0) {
+            m_pxdim_scaled.w_mm /= pd.w_mm;
+            m_pxdim_scaled.h_mm /= pd.h_mm;
+        }
+
+        m_rasterizer.gamma(gammafn);
+        m_rasterizer.clip_box(0., 0., double(res.width_px), double(res.height_px));
+    }
+
+    Trafo trafo() const override { return m_trafo; }
+    Resolution resolution() const { return m_resolution; }
+
+    void draw(const ExPolygon &poly) override;
+
+    EncodedRaster encode(RasterEncoder encoder) const override;
+
+    void foreach_pixel_run(const PixelRunFn &fn) const override;
+};
+
+// Same as create_raster_grayscale_aa(), but the raster is a SpanRaster.
+std::unique_ptr<RasterBase> create_raster_grayscale_spans(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma = 1.0,
+    const RasterBase::Trafo &tr    = {});
+
+}} // namespace Slic3r::sla
+
+#endif // SLA_SPANRASTER_HPP
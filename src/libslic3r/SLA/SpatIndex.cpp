@@ -138,11 +138,11 @@ bool BoxIndex::remove(const BoxIndexEl& el)
 }
 
 std::vector<BoxIndexEl> BoxIndex::query(const BoundingBox &qrbb,
-                                        BoxIndex::QueryType qt)
+                                        BoxIndex::QueryType qt) const
 {
     namespace bgi = boost::geometry::index;
 
-    std::vector<BoxIndexEl> ret; ret.reserve(m_impl->m_store.size());
+    std::vector<BoxIndexEl> ret;
 
     switch (qt) {
     case qtIntersects:
@@ -89,7 +89,7 @@ public:
 
     enum QueryType { qtIntersects, qtWithin };
 
-    std::vector<BoxIndexEl> query(const BoundingBox&, QueryType qt);
+    std::vector<BoxIndexEl> query(const BoundingBox&, QueryType qt) const;
     
     // For testing
     size_t size() const;
@@ -2641,6 +2641,13 @@ void draw(SVG &svg, const SupportIslandPoints &supportIslandPoints, coord_t radi
 namespace Slic3r::sla {
 SupportIslandPoints uniform_support_island(
     const ExPolygon &island, const Points& permanent, const SampleConfig &config){
+    Geometry::VoronoiDiagram vd;
+    return uniform_support_island(island, permanent, config, vd);
+}
+
+SupportIslandPoints uniform_support_island(
+    const ExPolygon &island, const Points& permanent, const SampleConfig &config,
+    Geometry::VoronoiDiagram &vd){
     ExPolygon simplified_island = get_simplified(island, config);
 #ifdef OPTION_TO_STORE_ISLAND
     std::string path;
@@ -2668,7 +2675,7 @@ SupportIslandPoints uniform_support_island(
         return supports;
     }
 
-    Geometry::VoronoiDiagram vd;
+    vd.clear(); // keep allocated memory
     Lines lines = to_lines(simplified_island);
     vd.construct_voronoi(lines.begin(), lines.end());
     assert(vd.get_issue_type() == Geometry::VoronoiDiagram::IssueType::NO_ISSUE_DETECTED);
@@ -6,6 +6,10 @@
 #include "SupportIslandPoint.hpp"
 #include "libslic3r/SLA/SupportPointGenerator.hpp" // Peninsula
 
+namespace Slic3r::Geometry {
+class VoronoiDiagram;
+} // namespace Slic3r::Geometry
+
 namespace Slic3r::sla {
 
 /// <summary>
@@ -18,6 +22,19 @@ namespace Slic3r::sla {
 SupportIslandPoints uniform_support_island(
     const ExPolygon &island, const Points &permanent, const SampleConfig &config);
 
+/// <summary>
+/// Distribute support points across island area defined by ExPolygon.
+/// Reuse storage of Voronoi diagram from previous call (e.g. one per thread).
+/// </summary>
+/// <param name="island">Shape of island</param>
+/// <param name="permanent">Place supported by already existing supports</param>
+/// <param name="config">Configuration of support density</param>
+/// <param name="vd">Storage for Voronoi diagram of the island, content is replaced</param>
+/// <returns>Support points laying inside of the island</returns>
+SupportIslandPoints uniform_support_island(
+    const ExPolygon &island, const Points &permanent, const SampleConfig &config,
+    Geometry::VoronoiDiagram &vd);
+
 /// <summary>
 /// Distribute support points across peninsula
 /// </summary>
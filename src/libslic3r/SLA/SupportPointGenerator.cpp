@@ -11,6 +11,10 @@
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/AABBTreeLines.hpp" // closest point to layer part
 #include "libslic3r/AABBMesh.hpp" // move_on_mesh_surface Should be in another file
+#include "libslic3r/Geometry/Voronoi.hpp" // reuse memory for sampling of islands
+#include <boost/container_hash/hash.hpp> // fingerprint of island shapes
+#include <tbb/enumerable_thread_specific.h> // Voronoi diagram per thread
+#include <unordered_map>
 // SupportIslands
 #include "libslic3r/SLA/SupportIslands/UniformSupportIsland.hpp"
 #include "libslic3r/SLA/SupportIslands/SampleConfigFactory.hpp"
@@ -57,6 +61,16 @@ public:
     explicit NearPoints(LayerSupportPoints* supports_ptr)
         : m_points(supports_ptr), m_tree(m_points) {}
 
+    /// <summary>
+    /// Constructor of tree over already stored support points
+    /// </summary>
+    /// <param name="supports_ptr">Pointer on Support vector</param>
+    /// <param name="indices">Indices into support vector, consumed</param>
+    NearPoints(LayerSupportPoints *supports_ptr, std::vector<size_t> &&indices)
+        : NearPoints(supports_ptr) {
+        m_tree.build(indices); // consume indices
+    }
+
     NearPoints get_copy(){ 
         NearPoints copy(m_points.m_supports_ptr);
         copy.m_tree = m_tree.get_copy(); // copy tree
@@ -285,57 +299,32 @@ void support_part_overhangs(
 }
 
 /// <summary>
-/// Sample part as Island
+/// Add sampled island(or peninsula) points as support points
 /// Result store to grid
 /// </summary>
-/// <param name="part">Island to support</param>
+/// <param name="samples">Points sampled on island</param>
 /// <param name="near_points">OUT place to store new supports</param>
 /// <param name="part_z">z coordinate of part</param>
-/// <param name="permanent">z coordinate of part</param>
 /// <param name="cfg"></param>
-void support_island(const LayerPart &part, NearPoints& near_points, float part_z,
-    const Points &permanent, const SupportPointGeneratorConfig &cfg) {
-    SupportIslandPoints samples = uniform_support_island(*part.shape, permanent, cfg.island_configuration);
-    for (const SupportIslandPointPtr &sample : samples)
+void support_island(const Points &samples, NearPoints& near_points, float part_z,
+    const SupportPointGeneratorConfig &cfg) {
+    for (const Point &sample : samples)
         near_points.add(LayerSupportPoint{
             SupportPoint{
                 Vec3f{
-                    unscale<float>(sample->point.x()), 
-                    unscale<float>(sample->point.y()), 
+                    unscale<float>(sample.x()), 
+                    unscale<float>(sample.y()), 
                     part_z
                 },
                 /* head_front_radius */ cfg.head_diameter / 2,
                 SupportPointType::island
             },
-            /* position_on_layer */ sample->point,
+            /* position_on_layer */ sample,
             /* radius_curve_index */ 0,
             /* current_radius */ static_cast<coord_t>(scale_(cfg.support_curve.front().x()))
         });
 }
 
-void support_peninsulas(const Peninsulas& peninsulas, NearPoints& near_points, float part_z,
-    const Points &permanent, const SupportPointGeneratorConfig &cfg) {
-    for (const Peninsula& peninsula: peninsulas) {
-        SupportIslandPoints peninsula_supports =
-            uniform_support_peninsula(peninsula, permanent, cfg.island_configuration);
-        for (const SupportIslandPointPtr &support : peninsula_supports)
-            near_points.add(LayerSupportPoint{
-                SupportPoint{
-                    Vec3f{
-                        unscale<float>(support->point.x()), 
-                        unscale<float>(support->point.y()), 
-                        part_z
-                    },
-                    /* head_front_radius */ cfg.head_diameter / 2, 
-                    SupportPointType::island
-                },
-                /* position_on_layer */ support->point,
-                /* radius_curve_index */ 0,
-                /* current_radius */ static_cast<coord_t>(scale_(cfg.support_curve.front().x()))
-            });
-    }   
-}
-
 /// <summary>
 /// Copy parts shapes from link to output
 /// </summary>
@@ -1435,16 +1424,272 @@ void copy_permanent_supports(NearPoints& near_points, const PermanentSupports& s
     }
 }
 
-Points get_permanents(const PermanentSupports &supports, size_t support_index, 
-    size_t layer_index, size_t part_index) {
+Points get_permanents(const PermanentSupports &supports, size_t layer_index, size_t part_index) {
+    // supports are sorted by influence
+    auto less = [](const PartId &a, const PartId &b) {
+        return a.layer_id != b.layer_id ? a.layer_id < b.layer_id : a.part_id < b.part_id; };
+    PartId part_id{layer_index, part_index};
+    auto from = std::lower_bound(supports.begin(), supports.end(), part_id,
+        [&less](const PermanentSupport &s, const PartId &id) { return less(s.influence, id); });
+    auto to = std::upper_bound(from, supports.end(), part_id,
+        [&less](const PartId &id, const PermanentSupport &s) { return less(id, s.influence); });
     Points result;
-    while (exist_permanent_support(supports, support_index, layer_index, part_index)) {
-        result.push_back(supports[support_index].layer_position); // copy
-        ++support_index; // only local(temporary) increment
+    result.reserve(to - from);
+    for (auto it = from; it != to; ++it)
+        result.push_back(it->layer_position); // copy
+    return result;
+}
+
+/// <summary>
+/// Fingerprint of island shape which does not change by translation of the island.
+/// Coarse enough to be same for islands which differ only by rounding of coordinates.
+/// </summary>
+size_t get_translation_invariant_hash(const ExPolygon &shape) {
+    size_t seed = 0;
+    boost::hash_combine(seed, shape.contour.size());
+    for (const Polygon &hole : shape.holes)
+        boost::hash_combine(seed, hole.size());
+    Point size = get_extents(shape.contour).size();
+    const coord_t precision = scale_(0.1);
+    boost::hash_combine(seed, size.x() / precision);
+    boost::hash_combine(seed, size.y() / precision);
+    return seed;
+}
+
+/// <summary>
+/// Check whether shape b is shape a moved by translation of their first contour points
+/// </summary>
+/// <param name="tolerance">Allowed difference of point coordinates after translation</param>
+bool is_translated_shape(const ExPolygon &a, const ExPolygon &b, coord_t tolerance) {
+    if (a.contour.size() != b.contour.size() || a.holes.size() != b.holes.size() || a.contour.empty())
+        return false;
+    for (size_t i = 0; i < a.holes.size(); ++i)
+        if (a.holes[i].size() != b.holes[i].size())
+            return false;
+
+    Point offset = b.contour.front() - a.contour.front();
+    auto is_same = [&offset, tolerance](const Polygon &pa, const Polygon &pb) {
+        for (size_t i = 0; i < pa.size(); ++i) {
+            Point diff = pb[i] - pa[i] - offset;
+            if (std::abs(diff.x()) > tolerance || std::abs(diff.y()) > tolerance)
+                return false;
+        }
+        return true;
+    };
+    if (!is_same(a.contour, b.contour))
+        return false;
+    for (size_t i = 0; i < a.holes.size(); ++i)
+        if (!is_same(a.holes[i], b.holes[i]))
+            return false;
+    return true;
+}
+
+/// <summary>
+/// Sample islands and peninsulas of layer parts, independent on the order of layers.
+/// Parts are sampled in parallel, islands with the same shape(e.g. array of same objects)
+/// are sampled only once and the samples are moved to the other islands.
+/// </summary>
+/// <param name="layers">All layers</param>
+/// <param name="first_layer_id">Index of the first layer to sample</param>
+/// <param name="permanent_supports">Permanent supports influence sampling</param>
+/// <param name="config">Configuration of sampling</param>
+/// <param name="throw_on_cancel">Call in meanwhile to check cancel event</param>
+/// <returns>Samples for each part of layers from first_layer_id,
+/// empty for parts without island and peninsulas</returns>
+std::vector<std::vector<Points>> sample_islands(
+    const Layers &layers,
+    size_t first_layer_id,
+    const PermanentSupports &permanent_supports,
+    const SupportPointGeneratorConfig &config,
+    const ThrowOnCancel &throw_on_cancel
+) {
+    struct Job {
+        PartId part;
+        Points permanent;
+        size_t sampled_job; // index of the job with the same island, sampled instead
+    };
+    std::vector<Job> jobs;
+    std::vector<std::vector<Points>> result(layers.size() - first_layer_id);
+    for (size_t layer_id = first_layer_id; layer_id < layers.size(); ++layer_id) {
+        const LayerParts &parts = layers[layer_id].parts;
+        result[layer_id - first_layer_id].resize(parts.size());
+        for (const LayerPart &part : parts) {
+            if (!part.prev_parts.empty() && part.peninsulas.empty())
+                continue; // nothing to sample
+            size_t part_id = &part - &parts.front();
+            jobs.push_back(Job{PartId{layer_id, part_id}, get_permanents(permanent_supports, layer_id, part_id), jobs.size()});
+        }
+    }
+    auto get_part = [&layers](const Job &job) -> const LayerPart & {
+        return layers[job.part.layer_id].parts[job.part.part_id];
+    };
+    auto can_reuse = [&get_part](const Job &job) {
+        return get_part(job).prev_parts.empty() && job.permanent.empty();
+    };
+
+    // Find same islands, only islands without permanent supports
+    std::vector<size_t> hashes(jobs.size(), 0);
+    execution::for_each(ex_tbb, size_t(0), jobs.size(), [&](size_t job_id) {
+        if (can_reuse(jobs[job_id]))
+            hashes[job_id] = get_translation_invariant_hash(*get_part(jobs[job_id]).shape);
+    }, 64 /* gransize */);
+
+    // Error in coordinates made by slicing of the same object placed elsewhere
+    const coord_t tolerance = scale_(0.001);
+    std::unordered_map<size_t, std::vector<size_t>> same_hash_jobs;
+    for (Job &job : jobs) {
+        if (!can_reuse(job))
+            continue;
+        size_t job_id = &job - &jobs.front();
+        const ExPolygon &shape = *get_part(job).shape;
+        std::vector<size_t> &candidates = same_hash_jobs[hashes[job_id]];
+        auto it = std::find_if(candidates.begin(), candidates.end(), [&](size_t candidate) {
+            return is_translated_shape(*get_part(jobs[candidate]).shape, shape, tolerance); });
+        if (it == candidates.end())
+            candidates.push_back(job_id);
+        else
+            job.sampled_job = *it;
+    }
+
+    auto to_points = [](const SupportIslandPoints &samples, Points &points) {
+        points.reserve(points.size() + samples.size());
+        for (const SupportIslandPointPtr &sample : samples)
+            points.push_back(sample->point);
+    };
+
+    // Voronoi diagram memory is reused by islands sampled in the same thread
+    tbb::enumerable_thread_specific<Geometry::VoronoiDiagram> vds;
+    execution::for_each(ex_tbb, size_t(0), jobs.size(), 
+    [&](size_t job_id) {
+        if ((job_id % 16) == 0)
+            throw_on_cancel();
+
+        const Job &job = jobs[job_id];
+        if (job.sampled_job != job_id)
+            return; // sampled by another job
+
+        const LayerPart &part = get_part(job);
+        Points &points = result[job.part.layer_id - first_layer_id][job.part.part_id];
+        if (part.prev_parts.empty()) { // Island
+            to_points(uniform_support_island(*part.shape, job.permanent, config.island_configuration, vds.local()), points);
+            return;
+        }
+        for (const Peninsula &peninsula : part.peninsulas)
+            to_points(uniform_support_peninsula(peninsula, job.permanent, config.island_configuration), points);
+    }, 1 /* gransize */);
+
+    // Move samples to the same islands
+    for (const Job &job : jobs) {
+        if (job.sampled_job == static_cast<size_t>(&job - &jobs.front()))
+            continue;
+        const Job &sampled = jobs[job.sampled_job];
+        Point offset = get_part(job).shape->contour.front() - get_part(sampled).shape->contour.front();
+        Points points = result[sampled.part.layer_id - first_layer_id][sampled.part.part_id]; // copy
+        for (Point &p : points)
+            p += offset;
+        result[job.part.layer_id - first_layer_id][job.part.part_id] = std::move(points);
     }
     return result;
 }
 
+// Layers are stored into checkpoint of the generation with this step.
+// A checkpoint stores the grids of the previous layer and the support points changed since the previous checkpoint,
+// so its size grows with the support points generated meanwhile, not with the step.
+// Resumed generation repeats up to CHECKPOINT_LAYERS - 1 layers, which are cheap compared to sampling of the islands,
+// the sampling is done again only for parts above the checkpoint.
+constexpr size_t CHECKPOINT_LAYERS = 64;
+
+/// <summary>
+/// Check whether generation with both configurations is the same
+/// NOTE: Configuration of preparation is part of layer fingerprint
+/// </summary>
+bool is_same_config(const SupportPointGeneratorConfig &a, const SupportPointGeneratorConfig &b) {
+    const SampleConfig &sa = a.island_configuration;
+    const SampleConfig &sb = b.island_configuration;
+    return a.density_relative == b.density_relative &&
+        a.head_diameter == b.head_diameter &&
+        a.support_curve == b.support_curve &&
+        a.max_allowed_distance_sq == b.max_allowed_distance_sq &&
+        sa.thin_max_distance == sb.thin_max_distance &&
+        sa.thick_inner_max_distance == sb.thick_inner_max_distance &&
+        sa.thick_outline_max_distance == sb.thick_outline_max_distance &&
+        sa.head_radius == sb.head_radius &&
+        sa.minimal_distance_from_outline == sb.minimal_distance_from_outline &&
+        sa.maximal_distance_from_outline == sb.maximal_distance_from_outline &&
+        sa.max_length_for_one_support_point == sb.max_length_for_one_support_point &&
+        sa.max_length_for_two_support_points == sb.max_length_for_two_support_points &&
+        sa.max_length_ratio_for_two_support_points == sb.max_length_ratio_for_two_support_points &&
+        sa.thin_max_width == sb.thin_max_width &&
+        sa.thick_min_width == sb.thick_min_width &&
+        sa.min_part_length == sb.min_part_length &&
+        sa.minimal_move == sb.minimal_move &&
+        sa.count_iteration == sb.count_iteration &&
+        sa.max_align_distance == sb.max_align_distance &&
+        sa.simplification_tolerance == sb.simplification_tolerance;
+}
+
+/// <summary>
+/// Fingerprint of each layer, everything read by generation from the layer
+/// Change of the layer fingerprint means that generation from this layer up has to be recalculated
+/// </summary>
+/// <param name="layers">Prepared layers</param>
+/// <param name="permanent_supports">Permanent supports prepared for the layers</param>
+/// <returns>Fingerprint for each layer</returns>
+std::vector<LayerFingerprint> get_layer_fingerprints(
+    const Layers &layers, const PermanentSupports &permanent_supports
+) {
+    std::vector<LayerFingerprint> fingerprints(layers.size());
+    execution::for_each(ex_tbb, size_t(0), layers.size(), [&layers, &fingerprints](size_t layer_id) {
+        const Layer &layer = layers[layer_id];
+        LayerFingerprint &fingerprint = fingerprints[layer_id];
+        fingerprint.print_z = layer.print_z;
+        fingerprint.parts_count = layer.parts.size();
+        size_t &seed = fingerprint.hash;
+        for (const LayerPart &part : layer.parts) {
+            fingerprint.area += part.shape->area();
+            hash_combine_expolygon(seed, *part.shape);
+            for (const ExPolygon &shape : part.extend_shape)
+                hash_combine_expolygon(seed, shape);
+            hash_combine_points(seed, part.samples);
+            boost::hash_combine(seed, part.prev_parts.size());
+            for (const PartLink &link : part.prev_parts)
+                boost::hash_combine(seed, link - layers[layer_id - 1].parts.begin());
+            for (const Peninsula &peninsula : part.peninsulas) {
+                hash_combine_expolygon(seed, peninsula.unsuported_area);
+                for (bool is_outline : peninsula.is_outline)
+                    boost::hash_combine(seed, is_outline);
+            }
+        }
+    }, 8 /* gransize */);
+
+    // Permanent support is used since the layer of its first influence
+    for (const PermanentSupport &support : permanent_supports) {
+        size_t &seed = fingerprints[support.influence.layer_id].hash;
+        const SupportPoint &p = *support.point_it;
+        for (float v : {p.pos.x(), p.pos.y(), p.pos.z(), p.head_front_radius})
+            boost::hash_combine(seed, v);
+        for (size_t v : {support.influence.part_id, support.part.layer_id, support.part.part_id})
+            boost::hash_combine(seed, v);
+        boost::hash_combine(seed, support.layer_position.x());
+        boost::hash_combine(seed, support.layer_position.y());
+    }
+    return fingerprints;
+}
+
+/// <summary>
+/// Indices of support points used by any of grids
+/// </summary>
+/// <param name="grids">Indices for each part of layer</param>
+/// <returns>Sorted unique indices</returns>
+std::vector<size_t> get_used_indices(const std::vector<std::vector<size_t>> &grids) {
+    std::vector<size_t> result;
+    for (const std::vector<size_t> &grid : grids)
+        result.insert(result.end(), grid.begin(), grid.end());
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
 } // namespace
 
 namespace Slic3r::sla {
@@ -1467,9 +1712,15 @@ SampleConfig create_default_island_configuration(float head_diameter_in_mm) {
     return SampleConfigFactory::create(head_diameter_in_mm);
 }
 
-LayerSupportPoints generate_support_points(
+namespace {
+/// <summary>
+/// Generate support points, optionaly continue from the checkpoint of the last generation
+/// </summary>
+/// <param name="cache">State of last generation, nullptr when not used</param>
+LayerSupportPoints generate_support_points_impl(
     const SupportPointGeneratorData &data,
     const SupportPointGeneratorConfig &config,
+    SupportPointGeneratorCache *cache,
     ThrowOnCancel throw_on_cancel,
     StatusFunction statusfn
 ) {
@@ -1498,8 +1749,71 @@ LayerSupportPoints generate_support_points(
 
     // grid index == part in layer index
     NearPointss prev_grids; // same count as previous layer item size
-    for (size_t layer_id = 0; layer_id < layers.size(); ++layer_id) {
+    size_t first_layer_id = 0;
+    // Support points count and points used by grids in the last checkpoint,
+    // base for the difference stored by the next checkpoint
+    size_t checkpoint_points_count = 0;
+    std::vector<size_t> checkpoint_used_indices;
+    if (cache != nullptr) {
+        std::vector<LayerFingerprint> layer_fingerprints =
+            get_layer_fingerprints(layers, permanent_supports);
+
+        // Layers below the first changed one are generated in the same way
+        size_t first_changed = 0;
+        if (cache->config.has_value() && is_same_config(*cache->config, config))
+            first_changed = first_changed_layer(layer_fingerprints, cache->layers, 0, layer_fingerprints.size());
+
+        // Throw away checkpoints of changed layers
+        std::vector<SupportPointGeneratorCache::Checkpoint> &checkpoints = cache->checkpoints;
+        drop_checkpoints_above(checkpoints, first_changed,
+            [](const SupportPointGeneratorCache::Checkpoint &checkpoint) { return checkpoint.layer_id; });
+        cache->layers = std::move(layer_fingerprints);
+        cache->config = config;
+
+        if (!checkpoints.empty()) {
+            // continue from the last valid checkpoint, apply differences stored by all checkpoints below
+            for (const SupportPointGeneratorCache::Checkpoint &checkpoint : checkpoints) {
+                for (const auto &[index, point] : checkpoint.updated)
+                    result[index] = point;
+                result.insert(result.end(), checkpoint.appended.begin(), checkpoint.appended.end());
+            }
+            const SupportPointGeneratorCache::Checkpoint &checkpoint = checkpoints.back();
+            first_layer_id = checkpoint.layer_id;
+            permanent_index = checkpoint.permanent_index;
+            prev_grids.reserve(checkpoint.grids.size());
+            for (const std::vector<size_t> &grid : checkpoint.grids)
+                prev_grids.emplace_back(&result, std::vector<size_t>(grid));
+            checkpoint_points_count = result.size();
+            checkpoint_used_indices = get_used_indices(checkpoint.grids);
+            status = first_layer_id * increment;
+            status_int = static_cast<int>(std::round(status));
+        }
+    }
+
+    // Islands and peninsulas do not depend on support points from previous layers.
+    // Sample them in parallel before the sequential pass over layers.
+    std::vector<std::vector<Points>> samples =
+        sample_islands(layers, first_layer_id, permanent_supports, config, throw_on_cancel);
+
+    for (size_t layer_id = first_layer_id; layer_id < layers.size(); ++layer_id) {
+        if (cache != nullptr && is_checkpoint_layer(layer_id, first_layer_id, CHECKPOINT_LAYERS)) {
+            SupportPointGeneratorCache::Checkpoint checkpoint;
+            checkpoint.layer_id = layer_id;
+            checkpoint.appended.assign(result.begin() + checkpoint_points_count, result.end());
+            checkpoint.updated.reserve(checkpoint_used_indices.size());
+            for (size_t index : checkpoint_used_indices)
+                checkpoint.updated.emplace_back(index, result[index]);
+            checkpoint.grids.reserve(prev_grids.size());
+            for (const NearPoints &grid : prev_grids)
+                checkpoint.grids.push_back(grid.get_indices());
+            checkpoint.permanent_index = permanent_index;
+            checkpoint_points_count = result.size();
+            checkpoint_used_indices = get_used_indices(checkpoint.grids);
+            cache->checkpoints.push_back(std::move(checkpoint));
+        }
+
         const Layer &layer = layers[layer_id];
+        const std::vector<Points> &layer_samples = samples[layer_id - first_layer_id];
         prepare_supports_for_layer(result, layer.print_z, prev_grids, config);
 
         // grid index == part in layer index
@@ -1510,9 +1824,7 @@ LayerSupportPoints generate_support_points(
             size_t part_id = &part - &layer.parts.front();
             if (part.prev_parts.empty()) {   // Island ?
                 grids.emplace_back(&result); // only island add new grid
-                Points permanent =
-                    get_permanents(permanent_supports, permanent_index, layer_id, part_id);
-                support_island(part, grids.back(), layer.print_z, permanent, config);
+                support_island(layer_samples[part_id], grids.back(), layer.print_z, config);
                 copy_permanent_supports(
                     grids.back(), permanent_supports, permanent_index, layer.print_z, layer_id,
                     part_id, config
@@ -1526,12 +1838,8 @@ LayerSupportPoints generate_support_points(
             NearPoints near_points = create_near_points(prev_layer_parts, part, prev_grids);
             remove_supports_out_of_part(near_points, part, layer.print_z);
             assert(!near_points.get_indices().empty());
-            if (!part.peninsulas.empty()) {
-                // only get copy of points do not modify permanent_index
-                Points permanent =
-                    get_permanents(permanent_supports, permanent_index, layer_id, part_id);
-                support_peninsulas(part.peninsulas, near_points, layer.print_z, permanent, config);
-            }
+            if (!part.peninsulas.empty())
+                support_island(layer_samples[part_id], near_points, layer.print_z, config);
             copy_permanent_supports(
                 near_points, permanent_supports, permanent_index, layer.print_z, layer_id, part_id,
                 config
@@ -1559,6 +1867,27 @@ LayerSupportPoints generate_support_points(
     );
     return result;
 }
+} // namespace
+
+LayerSupportPoints generate_support_points(
+    const SupportPointGeneratorData &data,
+    const SupportPointGeneratorConfig &config,
+    ThrowOnCancel throw_on_cancel,
+    StatusFunction statusfn
+) {
+    return generate_support_points_impl(data, config, nullptr, throw_on_cancel, statusfn);
+}
+
+LayerSupportPoints generate_support_points(
+    const SupportPointGeneratorData &data,
+    const SupportPointGeneratorConfig &config,
+    SupportPointGeneratorCache &cache,
+    ThrowOnCancel throw_on_cancel,
+    StatusFunction statusfn
+) {
+    // NOTE: Canceled generation leaves only valid checkpoints in the cache
+    return generate_support_points_impl(data, config, &cache, throw_on_cancel, statusfn);
+}
 
 SupportPoints move_on_mesh_surface(
     const LayerSupportPoints &points,
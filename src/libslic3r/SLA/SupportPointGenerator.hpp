@@ -7,11 +7,13 @@
 
 #include <vector>
 #include <functional>
+#include <optional>
 
 #include <boost/container/small_vector.hpp>
 
 #include "libslic3r/Point.hpp"
 #include "libslic3r/ExPolygon.hpp"
+#include "libslic3r/LayerFingerprint.hpp"
 #include "libslic3r/SLA/SupportPoint.hpp"
 #include "libslic3r/SLA/SupportIslands/SampleConfig.hpp"
 
@@ -157,6 +159,45 @@ struct SupportPointGeneratorData
     SupportPoints permanent_supports;
 };
 
+/// <summary>
+/// Keep state of the last support point generation
+/// Used to regenerate only layers above the first changed layer
+/// e.g. after change of hollowing or drain holes
+/// </summary>
+struct SupportPointGeneratorCache
+{
+    // State of the generation before processing of a layer
+    // Stored as difference against the previous checkpoint,
+    // so memory of all checkpoints stays linear to the count of support points
+    struct Checkpoint
+    {
+        // Index of the first not processed layer
+        size_t layer_id = 0;
+
+        // Support points generated since the previous checkpoint (including permanent ones)
+        LayerSupportPoints appended;
+
+        // Support points used by grids of the previous checkpoint, in the current state.
+        // Only these could be changed meanwhile, other points are never used again.
+        std::vector<std::pair<size_t, LayerSupportPoint>> updated;
+
+        // Indices into all support points for each part of the previous layer
+        std::vector<std::vector<size_t>> grids;
+
+        // Index into permanent supports prepared for the layers
+        size_t permanent_index = 0;
+    };
+    // Sorted by layer_id
+    std::vector<Checkpoint> checkpoints;
+
+    // Fingerprint of each layer used by the last generation,
+    // contains shapes, samples and links of layer parts and influence of permanent supports
+    std::vector<LayerFingerprint> layers;
+
+    // Configuration used by the last generation, empty before the first one
+    std::optional<SupportPointGeneratorConfig> config;
+};
+
 // call during generation of support points to check cancel event
 using ThrowOnCancel = std::function<void(void)>;
 // call to say progress of generation into gui in range from 0 to 100
@@ -207,6 +248,25 @@ LayerSupportPoints generate_support_points(
     ThrowOnCancel throw_on_cancel = []() {},
     StatusFunction statusfn = [](int) {}
 );
+
+/// <summary>
+/// Generate support points on islands by configuration parameters
+/// Layers below the first layer changed since the last generation with the same cache are not processed again,
+/// their support points are restored from the cache
+/// </summary>
+/// <param name="data">Preprocessed data needed for sampling</param>
+/// <param name="config">Define density of samples</param>
+/// <param name="cache">IN/OUT state of the last generation, updated by this one</param>
+/// <param name="throw_on_cancel">Call in meanwhile to check cancel event</param>
+/// <param name="statusfn">Progress of generation into gui</param>
+/// <returns>Generated support points</returns>
+LayerSupportPoints generate_support_points(
+    const SupportPointGeneratorData &data,
+    const SupportPointGeneratorConfig &config,
+    SupportPointGeneratorCache &cache,
+    ThrowOnCancel throw_on_cancel = []() {},
+    StatusFunction statusfn = [](int) {}
+);
 } // namespace Slic3r::sla
 
 // TODO: Not sure if it is neccessary & Should be in another file
@@ -2,8 +2,10 @@
 #define SUPPORT_SLICES_CACHE_HPP
 
 #include <vector>
+#include <memory>
 #include "libslic3r/ExPolygon.hpp"
-#include "SupportTreeTypes.hpp"
+#include "SupportTreeSlicer.hpp"
+#include "SliceStore.hpp"
 #include "libslic3r/SLAPrint.hpp"
 
 namespace Slic3r {
@@ -15,14 +17,15 @@ class SupportSlicesCache {
 public:
     SupportSlicesCache() = default;
     SupportSlicesCache(
-        SupportTreeOutput&& support_tree_output,
+        std::shared_ptr<const SupportTreeSlicer> support_tree,
         std::vector<ExPolygons>&& pad_slices,
         const std::vector<float>& heights,
         const std::vector<Slic3r::SliceRecord>& slice_records,
         int faded_layers,
         double elefant_foot_min_width,
         double elefant_foot_compensation,
-        double absolute_correction
+        double absolute_correction,
+        const SliceStoreParams& store_params = {}
     );
 
     ExPolygons calculate_support_slice(size_t idx) const;
@@ -30,9 +33,12 @@ public:
     bool empty() const { return m_heights.empty(); }
     double area() const;
 
+    // Stores the precalculated bottom slices again with other parameters.
+    void store_again(const SliceStoreParams &params) { m_support_slices_bottom.store_again(params); }
+
 private:
-    std::vector<ExPolygons> m_support_slices_bottom;
-    SupportTreeOutput m_support_tree_output;
+    SliceStore m_support_slices_bottom;
+    std::shared_ptr<const SupportTreeSlicer> m_support_tree;
     std::vector<float> m_heights;
     double m_absolute_correction;
 };
@@ -9,6 +9,7 @@
 
 #include <libslic3r/SLA/SupportTree.hpp>
 #include <libslic3r/SLA/SupportTreeBuilder.hpp>
+#include <libslic3r/SLA/SupportTreeSlicer.hpp>
 #include <libslic3r/SLA/DefaultSupportTree.hpp>
 #include <libslic3r/SLA/BranchingTreeSLA.hpp>
 #include <libslic3r/MTUtils.hpp>
@@ -28,8 +29,8 @@
 
 namespace Slic3r { namespace sla {
 
-std::pair<indexed_triangle_set, SupportTreeOutput> create_support_tree(
-    const SupportableMesh &sm, const JobController   &ctl)
+SupportTreeOutput create_support_tree(const SupportableMesh &sm,
+                                      const JobController   &ctl)
 {
     auto builder = make_unique<SupportTreeBuilder>(ctl);
 
@@ -60,17 +61,13 @@ std::pair<indexed_triangle_set, SupportTreeOutput> create_support_tree(
                                 << duration<double>{stop - start}.count()
                                 << " seconds";
     }
-    std::pair<indexed_triangle_set, sla::SupportTreeOutput> its_and_output;
-    // Mesh must be retrieved before output!
-    its_and_output.first = builder->retrieve_mesh(MeshType::Support);
-    its_and_output.second = builder->retrieve_output(); 
-
-    return its_and_output;
+    // The mesh is not built here, see merged_mesh(const SupportTreeOutput&)
+    return builder->retrieve_output();
 }
 
-indexed_triangle_set create_pad(const SupportableMesh      &sm,
-                                const indexed_triangle_set &support_mesh,
-                                const JobController        &ctl)
+indexed_triangle_set create_pad(const SupportableMesh   &sm,
+                                const SupportTreeSlicer &support_tree,
+                                const JobController     &ctl)
 {
     constexpr float PadSamplingLH = 0.1f;
 
@@ -91,7 +88,7 @@ indexed_triangle_set create_pad(const SupportableMesh      &sm,
     }
 
     ExPolygons sup_contours;
-    pad_blueprint(support_mesh, sup_contours, heights, ctl.cancelfn);
+    pad_blueprint(support_tree.slice(heights, ctl.cancelfn), sup_contours);
 
     indexed_triangle_set out;
     create_pad(sup_contours, model_contours, out, sm.pad_cfg);
@@ -104,52 +101,21 @@ indexed_triangle_set create_pad(const SupportableMesh      &sm,
     return out;
 }
 
-std::vector<ExPolygons> slice(const indexed_triangle_set &sup_mesh,
-                              const indexed_triangle_set &pad_mesh,
-                              const std::vector<float>   &grid,
-                              float                       cr,
-                              const JobController        &ctl)
+std::vector<ExPolygons> slice_pad(const indexed_triangle_set &pad_mesh,
+                                  const std::vector<float>   &grid,
+                                  float                       cr,
+                                  const JobController        &ctl)
 {
-    using Slices = std::vector<ExPolygons>;
-
-    auto slices = reserve_vector<Slices>(2);
-
-    if (!sup_mesh.empty()) {
-        slices.emplace_back();
-        slices.back() = slice_mesh_ex(sup_mesh, grid, cr, ctl.cancelfn);
-    }
+    if (pad_mesh.empty())
+        return {};
 
-    if (!pad_mesh.empty()) {
-        slices.emplace_back();
+    auto bb     = bounding_box(pad_mesh);
+    auto maxzit = std::upper_bound(grid.begin(), grid.end(), bb.max.z());
 
-        auto bb     = bounding_box(pad_mesh);
-        auto maxzit = std::upper_bound(grid.begin(), grid.end(), bb.max.z());
-
-        auto cap     = grid.end() - maxzit;
-        auto padgrid = reserve_vector<float>(size_t(cap > 0 ? cap : 0));
-        std::copy(grid.begin(), maxzit, std::back_inserter(padgrid));
-
-        slices.back() = slice_mesh_ex(pad_mesh, padgrid, cr, ctl.cancelfn);
-    }
-
-    size_t len = grid.size();
-    for (const Slices &slv : slices)
-        len = std::min(len, slv.size());
-
-    // Either the support or the pad or both has to be non empty
-    if (slices.empty()) return {};
-
-    Slices &mrg = slices.front();
-
-    for (auto it = std::next(slices.begin()); it != slices.end(); ++it) {
-        for (size_t i = 0; i < len; ++i) {
-            Slices &slv = *it;
-            std::copy(slv[i].begin(), slv[i].end(), std::back_inserter(mrg[i]));
-            slv[i] = {}; // clear and delete
-        }
-    }
+    auto padgrid = reserve_vector<float>(size_t(maxzit - grid.begin()));
+    std::copy(grid.begin(), maxzit, std::back_inserter(padgrid));
 
-    return mrg;
+    return slice_mesh_ex(pad_mesh, padgrid, cr, ctl.cancelfn);
 }
 
 }} // namespace Slic3r::sla
@@ -149,18 +149,24 @@ inline double ground_level(const SupportableMesh &sm)
     return lvl;
 }
 
-std::pair<indexed_triangle_set, SupportTreeOutput> create_support_tree(const SupportableMesh &mesh,
-                                         const JobController   &ctl);
-
-indexed_triangle_set create_pad(const SupportableMesh      &model_mesh,
-                                const indexed_triangle_set &support_mesh,
-                                const JobController        &ctl);
-
-std::vector<ExPolygons> slice(const indexed_triangle_set &support_mesh,
-                              const indexed_triangle_set &pad_mesh,
-                              const std::vector<float>   &grid,
-                              float                       closing_radius,
-                              const JobController        &ctl);
+// The support tree as parametric primitives. Its mesh is only needed for
+// preview and export, it can be built by merged_mesh(const SupportTreeOutput&).
+SupportTreeOutput create_support_tree(const SupportableMesh &mesh,
+                                      const JobController   &ctl);
+
+class SupportTreeSlicer;
+
+// The support tree is sliced analytically for the pad, its mesh is not needed.
+indexed_triangle_set create_pad(const SupportableMesh   &model_mesh,
+                                const SupportTreeSlicer &support_tree,
+                                const JobController     &ctl);
+
+// Only the pad is sliced from its mesh, the support tree is always sliced
+// analytically by SupportTreeSlicer. The slices end at the top of the pad.
+std::vector<ExPolygons> slice_pad(const indexed_triangle_set &pad_mesh,
+                                  const std::vector<float>   &grid,
+                                  float                       closing_radius,
+                                  const JobController        &ctl);
 
 } // namespace sla
 } // namespace Slic3r
@@ -73,63 +73,84 @@ void SupportTreeBuilder::add_pillar_base(long pid, double baseheight, double rad
     m_meshcache_valid = false;
 }
 
-const indexed_triangle_set &SupportTreeBuilder::merged_mesh(size_t steps) const
+// Merges the meshes of the support tree primitives. Returns an empty mesh if
+// stopped meanwhile.
+static indexed_triangle_set merge_primitive_meshes(
+    const std::vector<Head>       &heads,
+    const std::vector<Pillar>     &pillars,
+    const std::vector<Pedestal>   &pedestals,
+    const std::vector<Junction>   &junctions,
+    const std::vector<Bridge>     &bridges,
+    const std::vector<Bridge>     &crossbridges,
+    const std::vector<DiffBridge> &diffbridges,
+    const std::vector<Anchor>     &anchors,
+    size_t                         steps,
+    const std::function<bool()>   &stopcondition)
 {
-    if (m_meshcache_valid) return m_meshcache;
-    
     indexed_triangle_set merged;
     
-    for (auto &head : m_heads) {
-        if (ctl().stopcondition()) break;
+    for (auto &head : heads) {
+        if (stopcondition()) break;
         if (head.is_valid()) its_merge(merged, get_mesh(head, steps));
     }
     
-    for (auto &pill : m_pillars) {
-        if (ctl().stopcondition()) break;
+    for (auto &pill : pillars) {
+        if (stopcondition()) break;
         its_merge(merged, get_mesh(pill, steps));
     }
 
-    for (auto &pedest : m_pedestals) {
-        if (ctl().stopcondition()) break;
+    for (auto &pedest : pedestals) {
+        if (stopcondition()) break;
         its_merge(merged, get_mesh(pedest, steps));
     }
     
-    for (auto &j : m_junctions) {
-        if (ctl().stopcondition()) break;
+    for (auto &j : junctions) {
+        if (stopcondition()) break;
         its_merge(merged, get_mesh(j, steps));
     }
 
-    for (auto &bs : m_bridges) {
-        if (ctl().stopcondition()) break;
+    for (auto &bs : bridges) {
+        if (stopcondition()) break;
         its_merge(merged, get_mesh(bs, steps));
     }
 
-    for (auto &bs : m_crossbridges) {
-        if (ctl().stopcondition()) break;
+    for (auto &bs : crossbridges) {
+        if (stopcondition()) break;
         its_merge(merged, get_mesh(bs, steps));
     }
 
-    for (auto &bs : m_diffbridges) {
-        if (ctl().stopcondition()) break;
+    for (auto &bs : diffbridges) {
+        if (stopcondition()) break;
         its_merge(merged, get_mesh(bs, steps));
     }
 
-    for (auto &anch : m_anchors) {
-        if (ctl().stopcondition()) break;
+    for (auto &anch : anchors) {
+        if (stopcondition()) break;
         its_merge(merged, get_mesh(anch, steps));
     }
 
-    if (ctl().stopcondition()) {
+    if (stopcondition())
         // In case of failure we have to return an empty mesh
-        m_meshcache = {};
-        return m_meshcache;
-    }
-    
-    m_meshcache = std::move(merged);
-    
+        return {};
+
     // The mesh will be passed by const-pointer to TriangleMeshSlicer,
     // which will need this.
-    its_merge_vertices(m_meshcache);
+    its_merge_vertices(merged);
+
+    return merged;
+}
+
+const indexed_triangle_set &SupportTreeBuilder::merged_mesh(size_t steps) const
+{
+    if (m_meshcache_valid) return m_meshcache;
+
+    m_meshcache = merge_primitive_meshes(m_heads, m_pillars, m_pedestals,
+                                         m_junctions, m_bridges, m_crossbridges,
+                                         m_diffbridges, m_anchors, steps,
+                                         [this] { return ctl().stopcondition(); });
+
+    if (ctl().stopcondition())
+        return m_meshcache;
     
     BoundingBoxf3 bb = bounding_box(m_meshcache);
     m_model_height   = bb.max(Z) - bb.min(Z);
@@ -138,6 +159,17 @@ const indexed_triangle_set &SupportTreeBuilder::merged_mesh(size_t steps) const
     return m_meshcache;
 }
 
+indexed_triangle_set merged_mesh(const SupportTreeOutput     &output,
+                                 const std::function<bool()> &stopcondition,
+                                 size_t                       steps)
+{
+    return merge_primitive_meshes(output.heads, output.pillars,
+                                  output.pedestals, output.junctions,
+                                  output.bridges, output.crossbridges,
+                                  output.diffbridges, output.anchors, steps,
+                                  stopcondition);
+}
+
 
 
 const indexed_triangle_set &SupportTreeBuilder::retrieve_mesh(MeshType meshtype) const
@@ -15,6 +15,7 @@
 #include <oneapi/tbb/spin_mutex.h>
 #include <stddef.h>
 #include <algorithm>
+#include <functional>
 #include <mutex>
 #include <utility>
 #include <vector>
@@ -305,6 +306,12 @@ public:
     }
 };
 
+// Mesh of the support tree retrieved from a SupportTreeBuilder, the same as
+// SupportTreeBuilder::merged_mesh() would return. Empty if stopped meanwhile.
+indexed_triangle_set merged_mesh(const SupportTreeOutput     &output,
+                                 const std::function<bool()> &stopcondition = [] { return false; },
+                                 size_t                       steps = 45);
+
 }} // namespace Slic3r::sla
 
 #endif // SUPPORTTREEBUILDER_HPP
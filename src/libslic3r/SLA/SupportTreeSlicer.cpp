@@ -338,6 +338,176 @@ std::vector<ExPolygons> slice_support_tree(
 
 
 
+namespace {
+
+using ZRange = std::pair<double, double>;
+
+ZRange z_range(const Vec3d& p1, const Vec3d& p2, double r)
+{
+    return {std::min(p1.z(), p2.z()) - r, std::max(p1.z(), p2.z()) + r};
+}
+
+ZRange z_range(const Head& head)
+{
+    // The cone of the head is enclosed by the hull of its two spheres.
+    const Vec3d c1 = head.pos + head.dir * (head.r_back_mm + 2 * head.r_pin_mm + head.width_mm - head.penetration_mm);
+    const Vec3d c2 = head.pos + head.dir * (head.r_pin_mm - head.penetration_mm);
+    return {std::min(c1.z() - head.r_back_mm, c2.z() - head.r_pin_mm),
+            std::max(c1.z() + head.r_back_mm, c2.z() + head.r_pin_mm)};
+}
+
+} // anonymous namespace
+
+
+
+SupportTreeSlicer::SupportTreeSlicer(sla::SupportTreeOutput&& output, int steps)
+    : m_output{std::move(output)}, m_steps{steps}
+{
+    // Z ranges of all the primitives, in the order of slice_support_tree_at_height().
+    std::vector<std::pair<Entry, ZRange>> ranges;
+    auto add = [&ranges](Primitive type, size_t idx, const ZRange& range) {
+        ranges.push_back({Entry{type, uint32_t(idx)}, range});
+    };
+
+    for (size_t i = 0; i < m_output.pillars.size(); ++i) {
+        const Pillar& p = m_output.pillars[i];
+        add(Primitive::Pillar, i, {p.endpt.z(), p.endpt.z() + p.height});
+    }
+    for (size_t i = 0; i < m_output.pedestals.size(); ++i) {
+        const Pedestal& p = m_output.pedestals[i];
+        add(Primitive::Pedestal, i, {p.pos.z(), p.pos.z() + p.height});
+    }
+    for (size_t i = 0; i < m_output.junctions.size(); ++i) {
+        const Junction& j = m_output.junctions[i];
+        add(Primitive::Junction, i, {j.pos.z() - j.r, j.pos.z() + j.r});
+    }
+    for (size_t i = 0; i < m_output.bridges.size(); ++i) {
+        const Bridge& b = m_output.bridges[i];
+        add(Primitive::Bridge, i, z_range(b.startp, b.endp, b.r));
+    }
+    for (size_t i = 0; i < m_output.crossbridges.size(); ++i) {
+        const Bridge& b = m_output.crossbridges[i];
+        add(Primitive::CrossBridge, i, z_range(b.startp, b.endp, b.r));
+    }
+    for (size_t i = 0; i < m_output.diffbridges.size(); ++i) {
+        const DiffBridge& b = m_output.diffbridges[i];
+        add(Primitive::DiffBridge, i, z_range(b.startp, b.endp, std::max(b.r, b.end_r)));
+    }
+    for (size_t i = 0; i < m_output.heads.size(); ++i)
+        if (m_output.heads[i].is_valid())
+            add(Primitive::Head, i, z_range(m_output.heads[i]));
+    for (size_t i = 0; i < m_output.anchors.size(); ++i)
+        if (m_output.anchors[i].is_valid())
+            add(Primitive::Anchor, i, z_range(m_output.anchors[i]));
+
+    if (ranges.empty())
+        return;
+
+    double min_z = std::numeric_limits<double>::max();
+    double max_z = std::numeric_limits<double>::lowest();
+    for (const auto& [entry, range] : ranges) {
+        min_z = std::min(min_z, range.first);
+        max_z = std::max(max_z, range.second);
+    }
+
+    // Bins of 1 mm, but not too many of them for tall objects.
+    const size_t max_bins = 4096;
+    m_min_z      = min_z;
+    m_bin_height = std::max(1., (max_z - min_z) / double(max_bins - 1));
+    m_bins.resize(size_t((max_z - min_z) / m_bin_height) + 1);
+
+    for (const auto& [entry, range] : ranges) {
+        size_t first = size_t((range.first - m_min_z) / m_bin_height);
+        size_t last  = std::min(size_t((range.second - m_min_z) / m_bin_height), m_bins.size() - 1);
+        for (size_t bin = first; bin <= last; ++bin)
+            m_bins[bin].emplace_back(entry);
+    }
+}
+
+
+
+std::optional<Polygon> SupportTreeSlicer::slice(const Entry& entry, double height) const
+{
+    switch (entry.type) {
+    case Primitive::Pillar: {
+        const Pillar& p = m_output.pillars[entry.idx];
+        return slice_vertical_cone(p.endpt, p.height, p.r_end, p.r_start, height, m_steps);
+    }
+    case Primitive::Pedestal: {
+        const Pedestal& p = m_output.pedestals[entry.idx];
+        return slice_vertical_cone(p.pos, p.height, p.r_bottom, p.r_top, height, m_steps);
+    }
+    case Primitive::Junction: {
+        const Junction& j = m_output.junctions[entry.idx];
+        return slice_sphere(j.pos, j.r, height, m_steps);
+    }
+    case Primitive::Bridge: {
+        const Bridge& b = m_output.bridges[entry.idx];
+        return slice_cylinder(b.startp, b.endp, b.r, height, m_steps);
+    }
+    case Primitive::CrossBridge: {
+        const Bridge& b = m_output.crossbridges[entry.idx];
+        return slice_cylinder(b.startp, b.endp, b.r, height, m_steps);
+    }
+    case Primitive::DiffBridge: {
+        const DiffBridge& b = m_output.diffbridges[entry.idx];
+        return slice_cone(b.startp, b.endp, b.r, b.end_r, height, m_steps);
+    }
+    case Primitive::Head:
+        return slice_head(m_output.heads[entry.idx], height, m_steps);
+    case Primitive::Anchor:
+        return slice_head(m_output.anchors[entry.idx], height, m_steps);
+    }
+
+    return std::nullopt;
+}
+
+
+
+ExPolygons SupportTreeSlicer::slice(float height) const
+{
+    ExPolygons out;
+
+    if (m_bins.empty() || height < m_min_z)
+        return out;
+
+    size_t bin = size_t((height - m_min_z) / m_bin_height);
+    if (bin >= m_bins.size())
+        return out;
+
+    for (const Entry& entry : m_bins[bin])
+        if (std::optional<Polygon> s = slice(entry, height); s)
+            out.emplace_back(std::move(*s));
+
+    return out;
+}
+
+
+
+std::vector<ExPolygons> SupportTreeSlicer::slice(const std::vector<float>& heights,
+                                                 const std::function<void()>& throw_on_cancel) const
+{
+    std::vector<ExPolygons> support_slices(heights.size());
+
+#if PARALLEL_SLICING_OF_TREE_SUPPORTS
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, heights.size()),
+    [this, &support_slices, &heights, &throw_on_cancel](const tbb::blocked_range<size_t>& range) {
+    for (size_t i = range.begin(); i != range.end(); ++i) {
+#else
+    for (size_t i = 0; i != heights.size(); ++i) {
+#endif
+        throw_on_cancel();
+        support_slices[i] = slice(heights[i]);
+    }
+#if PARALLEL_SLICING_OF_TREE_SUPPORTS
+    });
+#endif
+
+    return support_slices;
+}
+
+
+
 static double cone_side_area(double r1, double r2, double h)
 {
     return M_PI*(r1+r2) * std::sqrt(h*h - std::pow(r1-r2, 2.));
@@ -4,6 +4,9 @@
 #include "libslic3r/ExPolygon.hpp"
 #include "libslic3r/SLA/SupportTreeTypes.hpp"
 
+#include <functional>
+#include <optional>
+
 namespace Slic3r {
 namespace sla {
 
@@ -23,6 +26,50 @@ std::vector<ExPolygons> slice_support_tree(
 
 double calculate_supports_area(const sla::SupportTreeOutput& output);
 
+// Support tree kept as parametric primitives (cones, cylinders, spheres and
+// heads) which are sliced analytically. The primitives are binned by the Z
+// range they occupy, so slicing a layer only visits the few primitives that
+// can intersect it instead of the whole support forest. The slices are the
+// same as the ones of slice_support_tree_at_height().
+class SupportTreeSlicer {
+public:
+    SupportTreeSlicer() = default;
+    explicit SupportTreeSlicer(sla::SupportTreeOutput&& output,
+                               int steps = analytical_slicing_steps_default);
+
+    const sla::SupportTreeOutput& output() const { return m_output; }
+    bool empty() const { return m_bins.empty(); }
+
+    ExPolygons slice(float height) const;
+    // throw_on_cancel is called for every layer, possibly from worker threads.
+    std::vector<ExPolygons> slice(const std::vector<float>& heights,
+                                  const std::function<void()>& throw_on_cancel = [](){}) const;
+
+    double area() const { return calculate_supports_area(m_output); }
+
+private:
+    enum class Primitive : uint8_t {
+        Pillar, Pedestal, Junction, Bridge, CrossBridge, DiffBridge, Head, Anchor
+    };
+
+    struct Entry {
+        Primitive type;
+        uint32_t  idx;
+    };
+
+    std::optional<Polygon> slice(const Entry& entry, double height) const;
+
+    sla::SupportTreeOutput m_output;
+    int m_steps = analytical_slicing_steps_default;
+
+    // Entries of the primitives reaching into [m_min_z + i * m_bin_height,
+    // m_min_z + (i + 1) * m_bin_height], in the order of
+    // slice_support_tree_at_height().
+    std::vector<std::vector<Entry>> m_bins;
+    double m_min_z = 0.;
+    double m_bin_height = 1.;
+};
+
 }
 }
 #endif
\ No newline at end of file
@@ -17,6 +17,7 @@
 #include "Geometry.hpp"
 #include "Thread.hpp"
 
+#include <algorithm>
 #include <unordered_set>
 #include <numeric>
 
@@ -156,6 +157,16 @@ bool validate_pad(const indexed_triangle_set &pad, const sla::PadConfig &pcfg)
     return !pad.empty() || (pcfg.embed_object.enabled && !pcfg.embed_object.everywhere);
 }
 
+sla::SliceStoreParams slice_store_params(const SLAPrinterConfig &cfg)
+{
+    sla::SliceStoreParams params;
+    params.compressed = cfg.sla_slices_compression.getBool();
+    if (int limit_mb = cfg.sla_slices_memory_limit.getInt(); limit_mb > 0)
+        params.memory_limit = size_t(limit_mb) * 1024 * 1024;
+
+    return params;
+}
+
 void SLAPrint::clear()
 {
     std::scoped_lock<std::mutex> lock(this->state_mutex());
@@ -351,6 +362,16 @@ SLAPrint::ApplyStatus SLAPrint::apply(
     // It is also safe to change m_config now after this->invalidate_state_by_config_options() call.
     m_print_config.apply_only(config, print_diff, true);
     m_printer_config.apply_only(config, printer_diff, true);
+    // Changing the storage of the slices does not change the slices. Instead of slicing again
+    // and regenerating the supports, the finished slices are stored again with the new parameters.
+    if (std::any_of(printer_diff.begin(), printer_diff.end(), [](const t_config_option_key &opt_key) {
+            return opt_key == "sla_slices_compression" || opt_key == "sla_slices_memory_limit";
+        })) {
+        // The slices are read by the background processing, stop it.
+        this->call_cancel_callback();
+        for (SLAPrintObject *object : m_objects)
+            object->store_slices_again(slice_store_params(m_printer_config));
+    }
     // Handle changes to material config.
     m_material_config.apply_only(config, material_diff, true);
     // Handle changes to object config defaults
@@ -925,6 +946,7 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
         "display_orientation"sv,
         "sla_archive_format"sv,
         "sla_output_precision"sv,
+        "sla_archive_compression"sv,
         // tilt params
         "delay_before_exposure"sv,
         "delay_after_exposure"sv,
@@ -995,6 +1017,12 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
         "printer_model"sv,
     };
 
+    // Storage of the object and support slices. The slices do not change, they are stored again by apply().
+    static constexpr StaticSet steps_slices = {
+        "sla_slices_compression"sv,
+        "sla_slices_memory_limit"sv,
+    };
+
     std::vector<SLAPrintStep> steps;
     std::vector<SLAPrintObjectStep> osteps;
     bool invalidated = false;
@@ -1006,6 +1034,8 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
             steps.emplace_back(slapsMergeSlicesAndEval);
         } else if (steps_ignore.find(opt_key) != steps_ignore.end()) {
             // These steps have no influence on the output. Just ignore them.
+        } else if (steps_slices.find(opt_key) != steps_slices.end()) {
+            // Nothing to invalidate, see SLAPrint::apply().
         } else if (steps_full.find(opt_key) != steps_full.end()) {
             steps.emplace_back(slapsMergeSlicesAndEval);
             osteps.emplace_back(slaposObjectSlice);
@@ -1180,6 +1210,14 @@ bool SLAPrintObject::invalidate_all_steps()
     return Inherited::invalidate_all_steps() || m_print->invalidate_all_steps();
 }
 
+void SLAPrintObject::store_slices_again(const sla::SliceStoreParams &params)
+{
+    if (this->is_step_done_unguarded(slaposObjectSlice))
+        m_model_slices.store_again(params);
+    if (this->is_step_done_unguarded(slaposSliceSupports) && m_supportdata && m_supportdata->support_slices_cache)
+        m_supportdata->support_slices_cache->store_again(params);
+}
+
 double SLAPrintObject::get_elevation() const {
     if (is_zero_elevation(m_config)) return 0.;
 
@@ -1256,8 +1294,8 @@ ExPolygons SliceRecord::get_slice(SliceOrigin o) const
     if(m_po == nullptr) return EMPTY_SLICE;
 
     if (o == SliceOrigin::soModel) {
-        const std::vector<ExPolygons>& v = m_po->get_model_slices();
-        return idx >= v.size() ? EMPTY_SLICE : v[idx];
+        const sla::SliceStore& v = m_po->get_model_slices();
+        return idx >= v.size() ? EMPTY_SLICE : v.get(idx);
     } else {
         if (! m_po->m_supportdata || ! m_po->m_supportdata->support_slices_cache)
             return EMPTY_SLICE;
@@ -1270,7 +1308,7 @@ const TriangleMesh& SLAPrintObject::support_mesh() const
     if (m_config.supports_enable.getBool() &&
         is_step_done(slaposSupportTree) &&
         m_supportdata)
-        return m_supportdata->tree_mesh;
+        return m_supportdata->tree_mesh();
 
     return EMPTY_MESH;
 }
@@ -26,6 +26,9 @@
 
 #include "PrintBase.hpp"
 #include "SLA/SupportTree.hpp"
+#include "SLA/SupportTreeSlicer.hpp"
+#include "SLA/SupportTreeBuilder.hpp" // merged_mesh()
+#include "SLA/SliceStore.hpp"
 #include "SLA/SupportPointGenerator.hpp" // SupportPointGeneratorData
 #include "Point.hpp"
 #include "Format/SLAArchiveWriter.hpp"
@@ -288,7 +291,7 @@ private:
         return it;
     }
 
-    const std::vector<ExPolygons>& get_model_slices() const { return m_model_slices; }
+    const sla::SliceStore& get_model_slices() const { return m_model_slices; }
 
 public:
 
@@ -352,6 +355,8 @@ protected:
     bool                    invalidate_all_steps();
     // Invalidate steps based on a set of parameters changed.
     bool                    invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys);
+    // Store the finished object and support slices again with other storage parameters.
+    void                    store_slices_again(const sla::SliceStoreParams &params);
 
 private:
     // Object specific configuration, pulled from the configuration layer.
@@ -365,7 +370,7 @@ private:
     std::vector<Instance> 					m_instances;
 
     // Individual 2d slice polygons from lower z to higher z levels
-    std::vector<ExPolygons>                 m_model_slices;
+    sla::SliceStore                         m_model_slices;
 
     // Exact (float) height levels mapped to the slices. Each record contains
     // the index to the model and the support slice vectors.
@@ -376,6 +381,10 @@ private:
     // Precalculated data needed for interactive automatic support placement.
     sla::SupportPointGeneratorData          m_support_point_generator_data;
 
+    // State of the last automatic support placement. Used to regenerate
+    // only the layers above the first one changed e.g. by hollowing.
+    sla::SupportPointGeneratorCache         m_support_point_generator_cache;
+
     struct SupportData
     {
         sla::SupportableMesh    input; // the input
@@ -383,8 +392,12 @@ private:
         std::unique_ptr<sla::SupportSlicesCache> support_slices_cache;
 
 
-        TriangleMesh tree_mesh, pad_mesh; // cached artifacts
-        sla::SupportTreeOutput support_tree_output;
+        TriangleMesh pad_mesh; // cached artifact, for preview and export
+
+        // The parametric support tree, shared by the pad generation and the
+        // support slices cache. Both slice it analytically.
+        std::shared_ptr<const sla::SupportTreeSlicer> support_tree =
+            std::make_shared<const sla::SupportTreeSlicer>();
         
         explicit SupportData(const TriangleMesh &t);
 
@@ -392,15 +405,31 @@ private:
         
         void create_support_tree(const sla::JobController &ctl)
         {
-            auto output = sla::create_support_tree(input, ctl);
-            tree_mesh = TriangleMesh(std::move(output.first));
-            support_tree_output = std::move(output.second);
+            support_tree = std::make_shared<const sla::SupportTreeSlicer>(
+                sla::create_support_tree(input, ctl));
+            std::lock_guard<std::mutex> lk(m_tree_mesh_mutex);
+            m_tree_mesh.reset();
+        }
+
+        // Mesh of the support tree, only needed for preview and export.
+        // It is built from support_tree on the first request.
+        const TriangleMesh &tree_mesh() const
+        {
+            std::lock_guard<std::mutex> lk(m_tree_mesh_mutex);
+            if (!m_tree_mesh)
+                m_tree_mesh = std::make_unique<TriangleMesh>(
+                    sla::merged_mesh(support_tree->output()));
+            return *m_tree_mesh;
         }
 
         void create_pad(const sla::JobController &ctl)
         {
-            pad_mesh = TriangleMesh{sla::create_pad(input, tree_mesh.its, ctl)};
+            pad_mesh = TriangleMesh{sla::create_pad(input, *support_tree, ctl)};
         }
+
+    private:
+        mutable std::mutex                    m_tree_mesh_mutex;
+        mutable std::unique_ptr<TriangleMesh> m_tree_mesh;
     };
 
     std::unique_ptr<SupportData>  m_supportdata;
@@ -644,6 +673,8 @@ sla::PadConfig::EmbedObject builtin_pad_cfg(const SLAPrintObjectConfig& c);
 
 sla::PadConfig make_pad_cfg(const SLAPrintObjectConfig& c);
 
+sla::SliceStoreParams slice_store_params(const SLAPrinterConfig &cfg);
+
 bool validate_pad(const indexed_triangle_set &pad, const sla::PadConfig &pcfg);
 
 
@@ -213,7 +213,8 @@ indexed_triangle_set SLAPrint::Steps::generate_preview_vdb(
     auto grid = csg::voxelize_csgmesh(r, voxparams);
     auto m = grid ? grid_to_mesh(*grid, 0., 0.01) : indexed_triangle_set{};
     float loss_less_max_error = float(1e-6);
-    its_quadric_edge_collapse(m, 0U, &loss_less_max_error);
+    // Reduced mostly on clusters in parallel, the lossless limit holds there too.
+    its_quadric_edge_collapse(m, 0U, &loss_less_max_error, nullptr, nullptr, 0.2f);
 
     return m;
 }
@@ -421,7 +422,7 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
         if (!m.empty()) {
             // simplify mesh lossless
             float loss_less_max_error = 2*std::numeric_limits<float>::epsilon();
-            its_quadric_edge_collapse(m, 0U, &loss_less_max_error);
+            its_quadric_edge_collapse(m, 0U, &loss_less_max_error, nullptr, nullptr, 0.2f);
 
             its_compactify_vertices(m);
             its_merge_vertices(m);
@@ -505,7 +506,7 @@ template<class Cont> BoundingBoxf3 csgmesh_positive_bb(const Cont &csg)
 
 void SLAPrint::Steps::prepare_for_generate_supports(SLAPrintObject &po) {
     using namespace sla;
-    std::vector<ExPolygons> slices = po.get_model_slices(); // copy
+    std::vector<ExPolygons> slices = po.get_model_slices().get_all(); // copy
     const std::vector<float> &heights = po.m_model_height_levels;
 #ifdef USE_ISLAND_GUI_FOR_SETTINGS
     const PrepareSupportConfig &prepare_cfg = SampleConfigFactory::get_sample_config(po.config().support_head_front_diameter).prepare_config; // use configuration edited by GUI
@@ -588,25 +589,26 @@ void SLAPrint::Steps::slice_model(SLAPrintObject &po)
     auto  thr        = [this]() { m_print->throw_if_canceled(); };
     auto &slice_grid = po.m_model_height_levels;
 
-    po.m_model_slices = slice_csgmesh_ex(po.mesh_to_slice(), slice_grid, params, thr);
+    std::vector<ExPolygons> slices = slice_csgmesh_ex(po.mesh_to_slice(), slice_grid, params, thr);
 
     auto mit = slindex_it;
     for (size_t id = 0;
-         id < po.m_model_slices.size() && mit != po.m_slice_index.end();
+         id < slices.size() && mit != po.m_slice_index.end();
          id++) {
         mit->set_model_slice_idx(po, id); ++mit;
     }
 
     // We apply the printer correction offset here.
     const auto& pc = m_print->m_printer_config;
-    apply_printer_corrections(po.m_model_slices, soModel, po.m_slice_index, po.m_config.faded_layers.getInt(), pc.elefant_foot_min_width.getFloat(),
+    apply_printer_corrections(slices, soModel, po.m_slice_index, po.m_config.faded_layers.getInt(), pc.elefant_foot_min_width.getFloat(),
         pc.elefant_foot_compensation.getFloat(), pc.absolute_correction.getFloat());
 
 
 
     // Also apply Z-compensation. That is only done for model (not supports).
-    po.m_model_slices = sla::apply_zcorrection(po.m_model_slices,
-                                        m_print->m_material_config.zcorrection_layers.getInt());
+    slices = sla::apply_zcorrection(slices, m_print->m_material_config.zcorrection_layers.getInt());
+
+    po.m_model_slices.assign(std::move(slices), slice_store_params(pc));
 
     // Prepare data for the support point generator only when supports are enabled
     if (po.m_config.supports_enable.getBool())
@@ -761,7 +763,9 @@ void SLAPrint::Steps::support_points(SLAPrintObject &po)
 
     ThrowOnCancel cancel = [this]() { throw_if_canceled(); };
     StatusFunction status = statuscb;
-    LayerSupportPoints layer_support_points = generate_support_points(data, config, cancel, status);
+    // Only layers changed since the last generation (e.g. by hollowing) are processed again
+    LayerSupportPoints layer_support_points =
+        generate_support_points(data, config, po.m_support_point_generator_cache, cancel, status);
 
     // Maximal move of support point to mesh surface,
     // no more than height of layer
@@ -861,9 +865,9 @@ void SLAPrint::Steps::support_tree(SLAPrintObject &po)
     BOOST_LOG_TRIVIAL(debug) << "Processed support point count "
                              << po.m_supportdata->input.pts.size();
 
-    // Check the mesh for later troubleshooting.
-    if(po.support_mesh().empty())
-        BOOST_LOG_TRIVIAL(warning) << "Support mesh is empty";
+    // Check the support tree for later troubleshooting.
+    if(po.m_supportdata->support_tree->empty())
+        BOOST_LOG_TRIVIAL(warning) << "Support tree is empty";
 
     report_status(-1, _u8L("Visualizing supports"), rc);
 }
@@ -929,7 +933,7 @@ void SLAPrint::Steps::slice_supports(SLAPrintObject &po) {
         ctl.cancelfn = [this]() { throw_if_canceled(); };
 
         
-        std::vector<ExPolygons> pad_slices = sla::slice({}, sd->pad_mesh.its, heights,
+        std::vector<ExPolygons> pad_slices = sla::slice_pad(sd->pad_mesh.its, heights,
                        float(po.config().slice_closing_radius.value), ctl);
 
         for (size_t i = 0; i < heights.size() && i < po.m_slice_index.size(); ++i)
@@ -939,16 +943,16 @@ void SLAPrint::Steps::slice_supports(SLAPrintObject &po) {
         // containing pad and requiring elephant foot compensation. It will calculate
         // all other slices on the fly. The cache takes care of XY compensation.
         sd->support_slices_cache = std::make_unique<sla::SupportSlicesCache>(
-            std::move(sd->support_tree_output),
+            sd->support_tree,
             std::move(pad_slices),
             heights,
             po.m_slice_index,
             po.m_config.faded_layers.getInt(),
             m_print->m_printer_config.elefant_foot_min_width.getFloat(),
             m_print->m_printer_config.elefant_foot_compensation.getFloat(),
-            m_print->m_printer_config.absolute_correction.getFloat()
+            m_print->m_printer_config.absolute_correction.getFloat(),
+            slice_store_params(m_print->m_printer_config)
         );
-        sd->support_tree_output = {}; // moved from
         pad_slices = {};
     }
 
@@ -1179,6 +1183,12 @@ static SLATimeEstimateInput prepare_sla_time_estimate_input(
     };
 }
 
+// Total number of raster pixels (display pixels times layer count) up to which
+// the encoded layers are kept in memory after rasterization. Bigger prints
+// (high resolution displays, tall objects) are rasterized while the archive
+// is being written, see SLAArchiveWriter::defer_layers().
+static constexpr size_t MAX_RASTERIZED_PIXELS = size_t(8) * 1024 * 1024 * 1024;
+
 struct SLALayerInfo {
     double time{0.};
     double area{0.};
@@ -1191,7 +1201,7 @@ struct SLALayerInfo {
 
 
 // Going to parallel:
-static ExPolygons printlayerfn(const SLAPrint& print, size_t layer_idx, std::vector<SLALayerInfo>& layers_info)
+static ExPolygons printlayerfn(const SLAPrint& print, size_t layer_idx, SLALayerInfo& layer_info)
 {
     const SLAPrint::PrintLayer& layer = print.print_layers()[layer_idx];
     const auto& slicerecord_references = layer.slices();
@@ -1247,7 +1257,7 @@ static ExPolygons printlayerfn(const SLAPrint& print, size_t layer_idx, std::vec
             print.default_object_config(), layer_idx, l_height, layer_area));
 
     // Collect values for this layer.
-    layers_info[layer_idx] = SLALayerInfo{layer_time, layer_area, is_fast_layer, models_volume, supports_volume};
+    layer_info = SLALayerInfo{layer_time, layer_area, is_fast_layer, models_volume, supports_volume};
 
     return union_ex(trslices);
 };
@@ -1314,37 +1324,67 @@ void SLAPrint::Steps::rasterize()
 
     execution::SpinningMutex<ExecutionTBB> slck;
 
-    // procedure to process one height level. This will run in parallel
-    auto lvlfn =
-        [this, &slck, increment, &dstatus, &pst, &layers_info]
-        (sla::RasterBase& raster, size_t idx)
-    {
-        PrintLayer& printlayer = m_print->m_printer_input[idx];
-        if(canceled()) return;
-
-        ExPolygons polys = printlayerfn(*m_print, idx, layers_info);
-
-        for (const ExPolygon& poly : polys)
-            raster.draw(poly);
-
-        // Status indication guarded with the spinlock
-        {
-            std::lock_guard lck(slck);
-            dstatus += increment;
-            double st = std::round(dstatus);
-            if(st > pst) {
-                report_status(st, PRINT_STEP_LABELS(slapsRasterize));
-                pst = st;
-            }
+    // Status indication guarded with the spinlock
+    auto report_progress = [this, &slck, increment, &dstatus, &pst]() {
+        std::lock_guard lck(slck);
+        dstatus += increment;
+        double st = std::round(dstatus);
+        if(st > pst) {
+            report_status(st, PRINT_STEP_LABELS(slapsRasterize));
+            pst = st;
         }
     };
 
     // last minute escape
     if(canceled()) return;
 
-    // Print all the layers in parallel
-    m_print->m_archiver->draw_layers(m_print->m_printer_input.size(), lvlfn,
-                                    [this]() { return canceled(); }, ex_tbb);
+    const SLAPrinterConfig &printer_cfg = m_print->printer_config();
+    const size_t raster_pixels = size_t(std::max(printer_cfg.display_pixels_x.getInt(), 0)) *
+                                 size_t(std::max(printer_cfg.display_pixels_y.getInt(), 0));
+
+    if (raster_pixels * printer_input.size() > MAX_RASTERIZED_PIXELS) {
+        // Too much to be kept in memory once encoded. Only collect the
+        // statistics and the layer polygons now and let the archiver
+        // rasterize the layers while the archive is being written. The
+        // polygons are owned by the draw function, so the export does not
+        // depend on the state of the print anymore.
+        auto layer_polygons = std::make_shared<std::vector<ExPolygons>>(printer_input.size());
+
+        execution::for_each(ex_tbb, size_t(0), printer_input.size(),
+            [this, &layers_info, &layer_polygons, &report_progress](size_t idx) {
+                if(canceled()) return;
+                (*layer_polygons)[idx] = printlayerfn(*m_print, idx, layers_info[idx]);
+                report_progress();
+            },
+            execution::max_concurrency(ex_tbb));
+
+        if(canceled()) return;
+
+        // The archiver is owned by the print, thus it may query its cancel state.
+        m_print->m_archiver->defer_layers(printer_input.size(),
+            [layer_polygons](sla::RasterBase& raster, size_t idx) {
+                for (const ExPolygon& poly : (*layer_polygons)[idx])
+                    raster.draw(poly);
+            },
+            [print = m_print]() { return print->canceled(); });
+    } else {
+        // procedure to process one height level. This will run in parallel
+        auto lvlfn = [this, &layers_info, &report_progress](sla::RasterBase& raster, size_t idx)
+        {
+            if(canceled()) return;
+
+            ExPolygons polys = printlayerfn(*m_print, idx, layers_info[idx]);
+
+            for (const ExPolygon& poly : polys)
+                raster.draw(poly);
+
+            report_progress();
+        };
+
+        // Print all the layers in parallel
+        m_print->m_archiver->draw_layers(printer_input.size(), lvlfn,
+                                        [this]() { return canceled(); }, ex_tbb);
+    }
 
     // Write statistics collected during rasterization.
     bool is_prusa_print = SLAPrint::is_prusa_print(m_print->printer_config().printer_model);
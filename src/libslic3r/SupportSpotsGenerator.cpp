@@ -6,9 +6,10 @@
 #include "SupportSpotsGenerator.hpp"
 
 #include <boost/log/trivial.hpp>
-#include <oneapi/tbb/concurrent_vector.h>
+#include <boost/container_hash/hash.hpp>
 #include <oneapi/tbb/parallel_for.h>
 #include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/task_group.h>
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
@@ -37,11 +38,13 @@
 #include "AABBTreeLines.hpp"
 #include "KDTreeIndirect.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/LayerFingerprint.hpp"
 #include "libslic3r/ClipperUtils.hpp"
 #include "Geometry/ConvexHull.hpp"
 #include "libslic3r/ExtrusionRole.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/LayerRegion.hpp"
+#include "tcbspan/span.hpp"
 
 // #define DETAILED_DEBUG_LOGS
 // #define DEBUG_FILES
@@ -247,7 +250,8 @@ SliceConnection estimate_slice_connection(size_t slice_idx, const Layer *layer)
 };
 
 using PrecomputedSliceConnections = std::vector<std::vector<SliceConnection>>;
-PrecomputedSliceConnections precompute_slices_connections(const PrintObject *po)
+// Connections of the layers below first_layer_idx are left empty.
+PrecomputedSliceConnections precompute_slices_connections(const PrintObject *po, size_t first_layer_idx = 0)
 {
     PrecomputedSliceConnections result{};
     for (size_t lidx = 0; lidx < po->layer_count(); lidx++) {
@@ -257,7 +261,7 @@ PrecomputedSliceConnections precompute_slices_connections(const PrintObject *po)
         }
     }
 
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, po->layers().size()), [po, &result](tbb::blocked_range<size_t> r) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(first_layer_idx, po->layers().size()), [po, &result](tbb::blocked_range<size_t> r) {
         for (size_t lidx = r.begin(); lidx < r.end(); lidx++) {
             const Layer *l = po->get_layer(lidx);
             tbb::parallel_for(tbb::blocked_range<size_t>(0, l->lslices_ex.size()), [lidx, l, &result](tbb::blocked_range<size_t> r2) {
@@ -880,9 +884,22 @@ void reckon_new_support_point(ObjectPart        &part,
     }
 }
 
+// Lines of a single layer grouped by the slice they belong to. All the lines are stored in one array,
+// slice_begin[slice_idx] .. slice_begin[slice_idx + 1] is the range of lines of a slice.
+struct LinesPerSlice
+{
+    std::vector<ExtrusionLine> lines;
+    std::vector<size_t>        slice_begin;
+
+    tcb::span<const ExtrusionLine> slice(size_t slice_idx) const
+    {
+        return {lines.data() + slice_begin[slice_idx], slice_begin[slice_idx + 1] - slice_begin[slice_idx]};
+    }
+};
+
 struct LocalSupports {
-    std::vector<tbb::concurrent_vector<ExtrusionLine>> unstable_lines_per_slice;
-    std::vector<tbb::concurrent_vector<ExtrusionLine>> ext_perim_lines_per_slice;
+    LinesPerSlice unstable_lines_per_slice;
+    LinesPerSlice ext_perim_lines_per_slice;
 };
 
 struct EnitityToCheck
@@ -944,44 +961,65 @@ LocalSupports compute_local_supports(
     size_t slices_count,
     const Params& params
 ) {
-    std::vector<tbb::concurrent_vector<ExtrusionLine>> unstable_lines_per_slice(slices_count);
-    std::vector<tbb::concurrent_vector<ExtrusionLine>> ext_perim_lines_per_slice(slices_count);
-
     AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary_distancer =
         (previous_layer_boundary ? AABBTreeLines::LinesDistancer<Linef>{*previous_layer_boundary} : AABBTreeLines::LinesDistancer<Linef>{});
 
+    // Each entity is checked independently, the results are then concatenated in the order of the entities,
+    // which are already sorted by their slices. This keeps the order of lines deterministic.
+    std::vector<std::vector<ExtrusionLine>> lines_per_entity(entities_to_check.size());
+    auto check_entity = [&entities_to_check, &prev_layer_ext_perim_lines, &prev_layer_boundary_distancer, &lines_per_entity,
+                         &params](size_t entity_idx) {
+        const auto &e_to_check = entities_to_check[entity_idx];
+        std::vector<ExtrusionLine> lines = check_extrusion_entity_stability(e_to_check.e, e_to_check.region, prev_layer_ext_perim_lines,
+                                                                            prev_layer_boundary_distancer, params);
+        lines.erase(std::remove_if(lines.begin(), lines.end(), [](const ExtrusionLine &line) {
+            return ! line.support_point_generated.has_value() && ! line.is_external_perimeter();
+        }), lines.end());
+        lines_per_entity[entity_idx] = std::move(lines);
+    };
+
     if constexpr (debug_files) {
-        for (const auto &e_to_check : entities_to_check) {
-            for (const auto &line : check_extrusion_entity_stability(e_to_check.e, e_to_check.region, prev_layer_ext_perim_lines,
-                                                                     prev_layer_boundary_distancer, params)) {
+        for (size_t entity_idx = 0; entity_idx < entities_to_check.size(); ++entity_idx)
+            check_entity(entity_idx);
+    } else {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, entities_to_check.size()), [&check_entity](tbb::blocked_range<size_t> r) {
+            for (size_t entity_idx = r.begin(); entity_idx < r.end(); ++entity_idx)
+                check_entity(entity_idx);
+        });
+    }
+
+    LocalSupports result;
+    size_t unstable_count = 0;
+    size_t ext_perim_count = 0;
+    for (const std::vector<ExtrusionLine> &lines : lines_per_entity)
+        for (const ExtrusionLine &line : lines) {
+            unstable_count += line.support_point_generated.has_value();
+            ext_perim_count += line.is_external_perimeter();
+        }
+    result.unstable_lines_per_slice.lines.reserve(unstable_count);
+    result.ext_perim_lines_per_slice.lines.reserve(ext_perim_count);
+    result.unstable_lines_per_slice.slice_begin.assign(slices_count + 1, 0);
+    result.ext_perim_lines_per_slice.slice_begin.assign(slices_count + 1, 0);
+
+    size_t entity_idx = 0;
+    for (size_t slice_idx = 0; slice_idx < slices_count; ++slice_idx) {
+        result.unstable_lines_per_slice.slice_begin[slice_idx] = result.unstable_lines_per_slice.lines.size();
+        result.ext_perim_lines_per_slice.slice_begin[slice_idx] = result.ext_perim_lines_per_slice.lines.size();
+        for (; entity_idx < entities_to_check.size() && entities_to_check[entity_idx].slice_idx == slice_idx; ++entity_idx) {
+            for (const ExtrusionLine &line : lines_per_entity[entity_idx]) {
                 if (line.support_point_generated.has_value()) {
-                    unstable_lines_per_slice[e_to_check.slice_idx].push_back(line);
+                    result.unstable_lines_per_slice.lines.push_back(line);
                 }
                 if (line.is_external_perimeter()) {
-                    ext_perim_lines_per_slice[e_to_check.slice_idx].push_back(line);
+                    result.ext_perim_lines_per_slice.lines.push_back(line);
                 }
             }
         }
-    } else {
-        tbb::parallel_for(tbb::blocked_range<size_t>(0, entities_to_check.size()),
-                          [&entities_to_check, &prev_layer_ext_perim_lines, &prev_layer_boundary_distancer, &unstable_lines_per_slice,
-                           &ext_perim_lines_per_slice, &params](tbb::blocked_range<size_t> r) {
-                              for (size_t entity_idx = r.begin(); entity_idx < r.end(); ++entity_idx) {
-                                  const auto &e_to_check = entities_to_check[entity_idx];
-                                  for (const auto &line :
-                                       check_extrusion_entity_stability(e_to_check.e, e_to_check.region, prev_layer_ext_perim_lines,
-                                                                        prev_layer_boundary_distancer, params)) {
-                                      if (line.support_point_generated.has_value()) {
-                                          unstable_lines_per_slice[e_to_check.slice_idx].push_back(line);
-                                      }
-                                      if (line.is_external_perimeter()) {
-                                          ext_perim_lines_per_slice[e_to_check.slice_idx].push_back(line);
-                                      }
-                                  }
-                              }
-                          });
     }
-    return {unstable_lines_per_slice, ext_perim_lines_per_slice};
+    assert(entity_idx == entities_to_check.size());
+    result.unstable_lines_per_slice.slice_begin.back() = result.unstable_lines_per_slice.lines.size();
+    result.ext_perim_lines_per_slice.slice_begin.back() = result.ext_perim_lines_per_slice.lines.size();
+    return result;
 }
 
 struct SliceMappings
@@ -1093,13 +1131,13 @@ SliceMappings update_active_object_parts(const Layer                        *lay
     return new_slice_mappings;
 }
 
-void reckon_global_supports(const tbb::concurrent_vector<ExtrusionLine> &external_perimeter_lines,
-                            const coordf_t                               layer_bottom_z,
-                            const Params                                &params,
-                            ObjectPart                                  &part,
-                            SliceConnection                             &weakest_connection,
-                            SupportPoints                               &supp_points,
-                            SupportGridFilter                           &supports_presence_grid)
+void reckon_global_supports(const tcb::span<const ExtrusionLine> &external_perimeter_lines,
+                            const coordf_t                        layer_bottom_z,
+                            const Params                         &params,
+                            ObjectPart                           &part,
+                            SliceConnection                      &weakest_connection,
+                            SupportPoints                        &supp_points,
+                            SupportGridFilter                    &supports_presence_grid)
 {
     LD    current_slice_lines_distancer({external_perimeter_lines.begin(), external_perimeter_lines.end()});
     float unchecked_dist = params.min_distance_between_support_points + 1.0f;
@@ -1123,71 +1161,233 @@ void reckon_global_supports(const tbb::concurrent_vector<ExtrusionLine> &externa
     }
 }
 
-std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject                 *po,
-                                                          const PrecomputedSliceConnections &precomputed_slices_connections,
-                                                          const PrintTryCancel              &cancel_func,
-                                                          const Params                      &params)
+// State of the bottom-up stability pass after processing a layer. The stability of the next layer
+// only depends on this state and on the layer itself.
+struct StabilityState
 {
+    StabilityState(const PrintObject *po, const Params &params) : supports_presence_grid(po, params.min_distance_between_support_points) {}
+
     SupportPoints     supp_points{};
-    SupportGridFilter supports_presence_grid(po, params.min_distance_between_support_points);
+    SupportGridFilter supports_presence_grid;
     ActiveObjectParts active_object_parts{};
     PartialObjects    partial_objects{};
     LD                prev_layer_ext_perim_lines;
+    SliceMappings     slice_mappings;
+};
 
-    SliceMappings slice_mappings;
+void check_layer_stability(const Layer                        *layer,
+                           size_t                              layer_idx,
+                           const std::vector<SliceConnection> &precomputed_slice_connections,
+                           const Params                       &params,
+                           StabilityState                     &state)
+{
+    float bottom_z = layer->bottom_z();
 
+    state.slice_mappings = update_active_object_parts(layer, params, precomputed_slice_connections, state.slice_mappings,
+                                                      state.active_object_parts, state.partial_objects);
 
-    for (size_t layer_idx = 0; layer_idx < po->layer_count(); ++layer_idx) {
-        cancel_func();
-        const Layer *layer                 = po->get_layer(layer_idx);
-        float        bottom_z              = layer->bottom_z();
-
-        slice_mappings = update_active_object_parts(layer, params, precomputed_slices_connections[layer_idx], slice_mappings, active_object_parts, partial_objects);
-
-        std::optional<Linesf> prev_layer_boundary = layer->lower_layer != nullptr ?
-                                                        std::optional{to_unscaled_linesf(layer->lower_layer->lslices)} :
-                                                        std::nullopt;
-
-        LocalSupports local_supports{
-            compute_local_supports(gather_entities_to_check(layer), prev_layer_boundary, prev_layer_ext_perim_lines, layer->lslices_ex.size(), params)};
-
-        std::vector<ExtrusionLine> current_layer_ext_perims_lines{};
-        current_layer_ext_perims_lines.reserve(prev_layer_ext_perim_lines.get_lines().size());
-        // All object parts updated, and for each slice we have coresponding weakest connection.
-        // We can now check each slice and its corresponding weakest connection and object part for stability.
-        for (size_t slice_idx = 0; slice_idx < layer->lslices_ex.size(); ++slice_idx) {
-            ObjectPart                &part         = active_object_parts.access(slice_mappings.index_to_object_part_mapping[slice_idx]);
-            SliceConnection           &weakest_conn = slice_mappings.index_to_weakest_connection[slice_idx];
-
-            if (layer_idx > 1) {
-                for (const auto &l : local_supports.unstable_lines_per_slice[slice_idx]) {
-                    assert(l.support_point_generated.has_value());
-                    SupportPoint support_point{*l.support_point_generated, to_3d(l.b, bottom_z),
-                                               params.support_points_interface_radius};
-                    reckon_new_support_point(part, weakest_conn, supp_points, supports_presence_grid, support_point);
-                }
-            }
+    std::optional<Linesf> prev_layer_boundary = layer->lower_layer != nullptr ?
+                                                    std::optional{to_unscaled_linesf(layer->lower_layer->lslices)} :
+                                                    std::nullopt;
 
-            const tbb::concurrent_vector<ExtrusionLine> &external_perimeter_lines = local_supports.ext_perim_lines_per_slice[slice_idx];
-            if (layer_idx > 1) {
-                reckon_global_supports(external_perimeter_lines, bottom_z, params, part, weakest_conn, supp_points, supports_presence_grid);
+    LocalSupports local_supports{
+        compute_local_supports(gather_entities_to_check(layer), prev_layer_boundary, state.prev_layer_ext_perim_lines, layer->lslices_ex.size(), params)};
+
+    // All object parts updated, and for each slice we have coresponding weakest connection.
+    // We can now check each slice and its corresponding weakest connection and object part for stability.
+    for (size_t slice_idx = 0; slice_idx < layer->lslices_ex.size(); ++slice_idx) {
+        ObjectPart      &part         = state.active_object_parts.access(state.slice_mappings.index_to_object_part_mapping[slice_idx]);
+        SliceConnection &weakest_conn = state.slice_mappings.index_to_weakest_connection[slice_idx];
+
+        if (layer_idx > 1) {
+            for (const auto &l : local_supports.unstable_lines_per_slice.slice(slice_idx)) {
+                assert(l.support_point_generated.has_value());
+                SupportPoint support_point{*l.support_point_generated, to_3d(l.b, bottom_z),
+                                           params.support_points_interface_radius};
+                reckon_new_support_point(part, weakest_conn, state.supp_points, state.supports_presence_grid, support_point);
             }
+            reckon_global_supports(local_supports.ext_perim_lines_per_slice.slice(slice_idx), bottom_z, params, part, weakest_conn,
+                                   state.supp_points, state.supports_presence_grid);
+        }
+    } // slice iterations
+
+    // The external perimeter lines are already stored by slices, thus the next layer may use them directly.
+    state.prev_layer_ext_perim_lines = LD(std::move(local_supports.ext_perim_lines_per_slice.lines));
+}
+
+// Layers are stored into checkpoints of the stability check with this step. A checkpoint copies the active object parts,
+// the slice mappings and the external perimeter lines of one layer, which is cheap compared to checking the layers,
+// while the check resumed from a checkpoint repeats up to CHECKPOINT_LAYERS - 1 layers below the first changed one.
+// With 64 layers, a change of a tall object re-checks at most a few millimeters below the change.
+constexpr size_t CHECKPOINT_LAYERS = 64;
+
+// State of the stability check before processing of a layer. Support points and partial objects are only appended
+// during the check, thus the checkpoint stores just their counts, the vectors are stored once in StabilityCache.
+struct StabilityCheckpoint
+{
+    // Index of the first not processed layer
+    size_t            layer_idx{};
+    size_t            supp_points_count{};
+    size_t            partial_objects_count{};
+    ActiveObjectParts active_object_parts;
+    SliceMappings     slice_mappings;
+    // External perimeter lines of the layer below with origin_entity cleared. The origin is not accessed
+    // for the lines of the previous layer and the extrusions may be regenerated since the checkpoint was stored.
+    std::vector<ExtrusionLine> prev_layer_ext_perim_lines;
+};
+
+StabilityCheckpoint make_checkpoint(size_t layer_idx, const StabilityState &state)
+{
+    StabilityCheckpoint checkpoint{layer_idx,
+                                   state.supp_points.size(),
+                                   state.partial_objects.size(),
+                                   state.active_object_parts,
+                                   state.slice_mappings,
+                                   state.prev_layer_ext_perim_lines.get_lines()};
+    for (ExtrusionLine &line : checkpoint.prev_layer_ext_perim_lines)
+        line.origin_entity = nullptr;
+    return checkpoint;
+}
+
+static void hash_combine_flow(size_t &seed, const Flow &flow)
+{
+    boost::hash_combine(seed, flow.width());
+    boost::hash_combine(seed, flow.height());
+    boost::hash_combine(seed, flow.mm3_per_mm());
+    boost::hash_combine(seed, flow.bridge());
+}
+
+static void hash_combine_path(size_t &seed, const ExtrusionPath &path)
+{
+    // The stability check distinguishes roles by their modifiers (bridges, overhang perimeters, ...),
+    // thus all the modifiers are hashed, not just the G-code role the extrusion role maps to.
+    uint16_t role_bits = 0;
+    for (uint16_t modifier = 0; modifier < uint16_t(ExtrusionRoleModifier::Count); ++modifier)
+        if (path.role().has(ExtrusionRoleModifier(modifier)))
+            role_bits |= uint16_t(1) << modifier;
+    boost::hash_combine(seed, role_bits);
+    boost::hash_combine(seed, path.width());
+    boost::hash_combine(seed, path.height());
+    boost::hash_combine(seed, path.mm3_per_mm());
+    hash_combine_points(seed, path.polyline.points);
+}
 
-            current_layer_ext_perims_lines.insert(current_layer_ext_perims_lines.end(), external_perimeter_lines.begin(), external_perimeter_lines.end());
-        } // slice iterations
-        prev_layer_ext_perim_lines = LD(current_layer_ext_perims_lines);
+// Walks the extrusion tree in place, flattening it would copy all the extrusions of the layer.
+static void hash_combine_extrusions(size_t &seed, const ExtrusionEntity &entity)
+{
+    if (const auto *collection = dynamic_cast<const ExtrusionEntityCollection *>(&entity); collection != nullptr) {
+        for (const ExtrusionEntity *child : collection->entities)
+            hash_combine_extrusions(seed, *child);
+    } else if (const auto *path = dynamic_cast<const ExtrusionPath *>(&entity); path != nullptr) {
+        hash_combine_path(seed, *path);
+    } else if (const auto *loop = dynamic_cast<const ExtrusionLoop *>(&entity); loop != nullptr) {
+        for (const ExtrusionPath &path : loop->paths)
+            hash_combine_path(seed, path);
+    } else if (const auto *multi_path = dynamic_cast<const ExtrusionMultiPath *>(&entity); multi_path != nullptr) {
+        for (const ExtrusionPath &path : multi_path->paths)
+            hash_combine_path(seed, path);
+    }
+}
+
+// What the stability check reads from a layer: slice polygons, their links to the layer below, extrusions and flows.
+static LayerFingerprint get_layer_fingerprint(const Layer *layer)
+{
+    LayerFingerprint fingerprint{0, layer->print_z, layer->lslices_ex.size(), 0.};
+    size_t &seed = fingerprint.hash;
+    boost::hash_combine(seed, layer->id());
+    boost::hash_combine(seed, layer->height);
+    for (const LayerRegion *region : layer->regions()) {
+        for (FlowRole role : {frExternalPerimeter, frPerimeter, frInfill, frSolidInfill, frTopSolidInfill}) {
+            hash_combine_flow(seed, region->flow(role));
+            hash_combine_flow(seed, region->bridging_flow(role));
+        }
+    }
+
+    for (size_t slice_idx = 0; slice_idx < layer->lslices_ex.size(); ++slice_idx) {
+        const ExPolygon &slice_polygon = layer->lslices[slice_idx];
+        fingerprint.area += slice_polygon.area();
+        hash_combine_expolygon(seed, slice_polygon);
+
+        const LayerSlice &slice = layer->lslices_ex[slice_idx];
+        for (const LayerSlice::Link &link : slice.overlaps_below) {
+            boost::hash_combine(seed, link.slice_idx);
+            boost::hash_combine(seed, link.area);
+        }
+        for (const ExtrusionEntityCollection *collection : gather_extrusions(slice, layer))
+            hash_combine_extrusions(seed, *collection);
+    }
+    return fingerprint;
+}
+
+static void compute_layer_fingerprints(const PrintObject *po, size_t begin, size_t end, std::vector<LayerFingerprint> &fingerprints)
+{
+    tbb::parallel_for(tbb::blocked_range<size_t>(begin, end), [po, &fingerprints](tbb::blocked_range<size_t> r) {
+        for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx)
+            fingerprints[layer_idx] = get_layer_fingerprint(po->get_layer(layer_idx));
+    });
+}
+
+static bool same_params(const Params &lhs, const Params &rhs)
+{
+    return lhs.max_acceleration == rhs.max_acceleration && lhs.raft_layers_count == rhs.raft_layers_count &&
+           lhs.filament_type == rhs.filament_type && lhs.brim_type == rhs.brim_type && lhs.brim_width == rhs.brim_width;
+}
+
+struct StabilityCache
+{
+    // Parameters and object size (extents of the support presence grid) of the last search, empty if it did not finish.
+    std::optional<Params>            params;
+    Vec3crd                          object_size{Vec3crd::Zero()};
+    std::vector<LayerFingerprint>    layer_fingerprints;
+    // Results of the last search, prefixes of them are referenced by the checkpoints.
+    SupportPoints                    supp_points;
+    PartialObjects                   partial_objects;
+    // Sorted by layer_idx
+    std::vector<StabilityCheckpoint> checkpoints;
+    size_t                           resumed_layer_idx{};
+};
+
+// Checks layers from first_layer_idx up. If cache is not null, checkpoints of the state are stored into it.
+void check_layers_stability(const PrintObject                 *po,
+                            size_t                             first_layer_idx,
+                            const PrecomputedSliceConnections &precomputed_slices_connections,
+                            const PrintTryCancel              &cancel_func,
+                            const Params                      &params,
+                            StabilityState                    &state,
+                            StabilityCache                    *cache)
+{
+    for (size_t layer_idx = first_layer_idx; layer_idx < po->layer_count(); ++layer_idx) {
+        cancel_func();
+        if (cache != nullptr && is_checkpoint_layer(layer_idx, first_layer_idx, CHECKPOINT_LAYERS)) {
+            cache->checkpoints.push_back(make_checkpoint(layer_idx, state));
+        }
+        check_layer_stability(po->get_layer(layer_idx), layer_idx, precomputed_slices_connections[layer_idx], params, state);
     } // layer iterations
 
-    for (const auto& active_obj_pair : slice_mappings.index_to_object_part_mapping) {
-        auto object_part = active_object_parts.access(active_obj_pair.second);
+    for (const auto& active_obj_pair : state.slice_mappings.index_to_object_part_mapping) {
+        auto object_part = state.active_object_parts.access(active_obj_pair.second);
         if (auto object = to_partial_object(object_part)) {
-            partial_objects.push_back(std::move(*object));
+            state.partial_objects.push_back(std::move(*object));
         }
     }
+}
 
-    return {supp_points, partial_objects};
+std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject                 *po,
+                                                          const PrecomputedSliceConnections &precomputed_slices_connections,
+                                                          const PrintTryCancel              &cancel_func,
+                                                          const Params                      &params)
+{
+    StabilityState state{po, params};
+    check_layers_stability(po, 0, precomputed_slices_connections, cancel_func, params, state, nullptr);
+    return {std::move(state.supp_points), std::move(state.partial_objects)};
 }
 
+void StabilityCacheDeleter::operator()(StabilityCache *p) { delete p; }
+
+StabilityCachePtr make_stability_cache() { return StabilityCachePtr(new StabilityCache()); }
+
+size_t resumed_layer_idx(const StabilityCache &cache) { return cache.resumed_layer_idx; }
+
 #ifdef DEBUG_FILES
 void debug_export(const SupportPoints& support_points,const PartialObjects& objects, std::string file_name)
 {
@@ -1240,6 +1440,71 @@ std::tuple<SupportPoints, PartialObjects> full_search(const PrintObject *po, con
     return results;
 }
 
+std::tuple<SupportPoints, PartialObjects> full_search(const PrintObject    *po,
+                                                      const PrintTryCancel &cancel_func,
+                                                      const Params         &params,
+                                                      StabilityCache       &cache)
+{
+    // Layers below the first changed one are checked in the same way as by the last search.
+    // The fingerprints are compared by blocks of checkpoints from the bottom, so that the layers above the first changed block
+    // are not hashed before the search, their fingerprints are computed while their stability is being checked.
+    std::vector<LayerFingerprint> layer_fingerprints(po->layer_count());
+    size_t first_changed       = 0;
+    size_t fingerprinted_count = 0;
+    if (cache.params.has_value() && same_params(*cache.params, params) && cache.object_size == po->size()) {
+        while (fingerprinted_count < po->layer_count() && first_changed == fingerprinted_count) {
+            const size_t end = std::min(fingerprinted_count + CHECKPOINT_LAYERS, po->layer_count());
+            compute_layer_fingerprints(po, fingerprinted_count, end, layer_fingerprints);
+            first_changed       = first_changed_layer(layer_fingerprints, cache.layer_fingerprints, fingerprinted_count, end);
+            fingerprinted_count = end;
+        }
+    }
+    drop_checkpoints_above(cache.checkpoints, first_changed, [](const StabilityCheckpoint &checkpoint) { return checkpoint.layer_idx; });
+
+    StabilityState state{po, params};
+    size_t         first_layer_idx = 0;
+    if (! cache.checkpoints.empty()) {
+        const StabilityCheckpoint &checkpoint = cache.checkpoints.back();
+        first_layer_idx = checkpoint.layer_idx;
+        state.supp_points.assign(cache.supp_points.begin(), cache.supp_points.begin() + checkpoint.supp_points_count);
+        // Each stored support point took its position in the grid.
+        for (const SupportPoint &support_point : state.supp_points)
+            state.supports_presence_grid.take_position(support_point.position);
+        state.partial_objects.assign(cache.partial_objects.begin(), cache.partial_objects.begin() + checkpoint.partial_objects_count);
+        state.active_object_parts        = checkpoint.active_object_parts;
+        state.slice_mappings             = checkpoint.slice_mappings;
+        state.prev_layer_ext_perim_lines = LD(checkpoint.prev_layer_ext_perim_lines);
+    }
+    BOOST_LOG_TRIVIAL(debug) << "Searching support spots from layer " << first_layer_idx << " of " << po->layer_count();
+
+    // The cache becomes valid once the search is finished. If it is canceled, the next search drops all the checkpoints.
+    cache.params.reset();
+    cache.layer_fingerprints.clear();
+    cache.resumed_layer_idx = first_layer_idx;
+
+    tbb::task_group fingerprinting;
+    if (fingerprinted_count < po->layer_count()) {
+        fingerprinting.run([po, fingerprinted_count, &layer_fingerprints]() {
+            compute_layer_fingerprints(po, fingerprinted_count, po->layer_count(), layer_fingerprints);
+        });
+    }
+    try {
+        auto precomputed_slices_connections = precompute_slices_connections(po, first_layer_idx);
+        check_layers_stability(po, first_layer_idx, precomputed_slices_connections, cancel_func, params, state, &cache);
+    } catch (...) {
+        fingerprinting.wait();
+        throw;
+    }
+    fingerprinting.wait();
+
+    cache.params.emplace(params);
+    cache.object_size        = po->size();
+    cache.layer_fingerprints = std::move(layer_fingerprints);
+    cache.supp_points        = state.supp_points;
+    cache.partial_objects    = state.partial_objects;
+    return {std::move(state.supp_points), std::move(state.partial_objects)};
+}
+
 void estimate_supports_malformations(SupportLayerPtrs &layers, float flow_width, const Params &params)
 {
 #ifdef DEBUG_FILES
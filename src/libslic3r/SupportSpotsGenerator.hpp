@@ -9,6 +9,7 @@
 #include <cstddef>
 #include <vector>
 #include <algorithm>
+#include <memory>
 #include <optional>
 #include <string>
 #include <tuple>
@@ -272,6 +273,21 @@ using PartialObjects = std::vector<PartialObject>;
 // Both support points and partial objects are sorted from the lowest z to the highest
 std::tuple<SupportPoints, PartialObjects> full_search(const PrintObject *po, const PrintTryCancel& cancel_func, const Params &params);
 
+// State of the last full_search of an object, used to resume the bottom-up stability check
+// from the first layer changed since then. Defined in SupportSpotsGenerator.cpp.
+struct StabilityCache;
+struct StabilityCacheDeleter { void operator()(StabilityCache *p); };
+using  StabilityCachePtr = std::unique_ptr<StabilityCache, StabilityCacheDeleter>;
+StabilityCachePtr make_stability_cache();
+// Index of the layer the last search with the cache started from, the layers below were restored from the cache.
+size_t resumed_layer_idx(const StabilityCache &cache);
+
+// Same as above, the layers below the first layer changed since the last search with the same cache are not checked again.
+std::tuple<SupportPoints, PartialObjects> full_search(const PrintObject    *po,
+                                                      const PrintTryCancel &cancel_func,
+                                                      const Params         &params,
+                                                      StabilityCache       &cache);
+
 void estimate_supports_malformations(std::vector<SupportLayer *> &layers, float supports_flow_width, const Params &params);
 void estimate_malformations(std::vector<Layer *> &layers, const Params &params);
 
@@ -89,6 +89,11 @@ struct RepairedMeshErrors {
     }
 
     bool repaired() const { return degenerate_facets > 0 || edges_fixed > 0 || facets_removed > 0 || facets_reversed > 0 || backwards_edges > 0; }
+
+    bool operator==(const RepairedMeshErrors &rhs) const {
+        return edges_fixed == rhs.edges_fixed && degenerate_facets == rhs.degenerate_facets && facets_removed == rhs.facets_removed &&
+               facets_reversed == rhs.facets_reversed && backwards_edges == rhs.backwards_edges;
+    }
 };
 
 struct TriangleMeshStats {
@@ -2036,6 +2036,74 @@ std::vector<ColorPolygons> slice_mesh(
     return slice_mesh<AdditionalMeshInfo::Color>(mesh, zs, params, throw_on_cancel);
 }
 
+std::vector<std::vector<int>> facets_per_slicing_batch(
+    const indexed_triangle_set_with_color &mesh,
+    // Unscaled Zs
+    const std::vector<float>              &zs,
+    const size_t                           batch_size,
+    const MeshSlicingParams               &params)
+{
+    assert(batch_size > 0);
+    std::vector<std::vector<int>> out((zs.size() + batch_size - 1) / batch_size);
+
+    // Z of the vertices calculated the same way slice_make_lines() does, so that exactly the facets it slices are collected.
+    std::vector<float> vertices_z(mesh.vertices.size());
+    if (is_identity(params.trafo)) {
+        for (size_t i = 0; i < mesh.vertices.size(); ++ i)
+            vertices_z[i] = mesh.vertices[i].z();
+    } else {
+        const Transform3f tf = make_trafo_for_slicing(params.trafo);
+        for (size_t i = 0; i < mesh.vertices.size(); ++ i)
+            vertices_z[i] = (tf * mesh.vertices[i]).z();
+    }
+
+    for (size_t facet_idx = 0; facet_idx < mesh.indices.size(); ++ facet_idx) {
+        const stl_triangle_vertex_indices &indices = mesh.indices[facet_idx];
+        const float min_z = fminf(vertices_z[indices(0)], fminf(vertices_z[indices(1)], vertices_z[indices(2)]));
+        const float max_z = fmaxf(vertices_z[indices(0)], fmaxf(vertices_z[indices(1)], vertices_z[indices(2)]));
+        auto min_layer = std::lower_bound(zs.begin(), zs.end(), min_z);
+        auto max_layer = std::upper_bound(min_layer, zs.end(), max_z);
+        if (min_layer == max_layer)
+            continue;
+        const size_t first_batch = (min_layer - zs.begin()) / batch_size;
+        const size_t last_batch  = (max_layer - zs.begin() - 1) / batch_size;
+        for (size_t batch_idx = first_batch; batch_idx <= last_batch; ++ batch_idx)
+            out[batch_idx].emplace_back(int(facet_idx));
+    }
+
+    return out;
+}
+
+std::vector<ColorPolygons> slice_mesh(
+    const indexed_triangle_set_with_color &mesh,
+    const std::vector<int>                &facets,
+    // Unscaled Zs
+    const std::vector<float>              &zs,
+    const MeshSlicingParams               &params,
+    std::function<void()>                  throw_on_cancel)
+{
+    // Sub-mesh of the facets in their original order, referencing just their vertices.
+    indexed_triangle_set_with_color submesh;
+    submesh.indices.reserve(facets.size());
+    submesh.colors.reserve(facets.size());
+    std::vector<int> vertex_map(mesh.vertices.size(), -1);
+    for (const int facet_idx : facets) {
+        stl_triangle_vertex_indices indices = mesh.indices[facet_idx];
+        for (int i = 0; i < 3; ++ i) {
+            int &new_idx = vertex_map[indices(i)];
+            if (new_idx == -1) {
+                new_idx = int(submesh.vertices.size());
+                submesh.vertices.emplace_back(mesh.vertices[indices(i)]);
+            }
+            indices(i) = new_idx;
+        }
+        submesh.indices.emplace_back(indices);
+        submesh.colors.emplace_back(mesh.colors[facet_idx]);
+    }
+
+    return slice_mesh<AdditionalMeshInfo::Color>(submesh, zs, params, throw_on_cancel);
+}
+
 // Specialized version for a single slicing plane only, running on a single thread.
 template<AdditionalMeshInfo mesh_info = AdditionalMeshInfo::None>
 typename PolygonsType<mesh_info>::type slice_mesh(
@@ -86,6 +86,23 @@ std::vector<ColorPolygons>      slice_mesh(
     const MeshSlicingParams               &params,
     std::function<void()>                  throw_on_cancel = []{});
 
+// Indices of the facets sliced by any of the planes of each batch of batch_size consecutive zs, in their original order.
+// Sorting the facets into the batches once allows to slice a large mesh batch by batch without sweeping all its facets for each batch.
+std::vector<std::vector<int>>   facets_per_slicing_batch(
+    const indexed_triangle_set_with_color &mesh,
+    const std::vector<float>              &zs,
+    size_t                                 batch_size,
+    const MeshSlicingParams               &params);
+
+// Slice just the facets of the mesh, which have to contain all the facets sliced by zs (see facets_per_slicing_batch()).
+// Returns the same slices as slicing the whole mesh.
+std::vector<ColorPolygons>      slice_mesh(
+    const indexed_triangle_set_with_color &mesh,
+    const std::vector<int>                &facets,
+    const std::vector<float>              &zs,
+    const MeshSlicingParams               &params,
+    std::function<void()>                  throw_on_cancel = []{});
+
 // Specialized version for a single slicing plane only, running on a single thread.
 Polygons                        slice_mesh(
     const indexed_triangle_set       &mesh,
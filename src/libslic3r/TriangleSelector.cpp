@@ -215,14 +215,13 @@ int TriangleSelector::select_unsplit_triangle(const Vec3f &hit, int facet_idx, c
     int num_of_children = tr->number_of_split_sides() + 1;
     if (num_of_children != 1) {
         for (int i = 0; i < num_of_children; ++i) {
-            assert(i < int(tr->children.size()));
-            assert(tr->children[i] < int(m_triangles.size()));
+            assert(tr->child(i) < int(m_triangles.size()));
             // Recursion, deep first search over the children of this triangle.
             // All children of this triangle were created by splitting a single source triangle of the original mesh.
 
-            const std::array<int, 3> &t_vert = m_triangles[tr->children[i]].verts_idxs;
+            const std::array<int, 3> &t_vert = m_triangles[tr->child(i)].verts_idxs;
             if (is_point_inside_triangle(hit, m_vertices[t_vert[0]].v, m_vertices[t_vert[1]].v, m_vertices[t_vert[2]].v))
-                return this->select_unsplit_triangle(hit, tr->children[i], this->child_neighbors(*tr, neighbors, i));
+                return this->select_unsplit_triangle(hit, tr->child(i), this->child_neighbors(*tr, neighbors, i));
         }
     }
 
@@ -333,9 +332,8 @@ void TriangleSelector::seed_fill_select_triangles(const Vec3f &hit, int facet_st
         if (!visited[current_facet] && (highlight_by_angle_deg == 0.f || vec_down.dot(facet_normal) >= highlight_angle_limit)) {
             if (m_triangles[current_facet].is_split()) {
                 for (int split_triangle_idx = 0; split_triangle_idx <= m_triangles[current_facet].number_of_split_sides(); ++split_triangle_idx) {
-                    assert(split_triangle_idx < int(m_triangles[current_facet].children.size()));
-                    assert(m_triangles[current_facet].children[split_triangle_idx] < int(m_triangles.size()));
-                    if (int child = m_triangles[current_facet].children[split_triangle_idx]; !visited[child]) {
+                    assert(m_triangles[current_facet].child(split_triangle_idx) < int(m_triangles.size()));
+                    if (int child = m_triangles[current_facet].child(split_triangle_idx); !visited[child]) {
                         // Child triangle shares normal with its parent. Select it.
                         facet_queue.push(child);
                     }
@@ -421,9 +419,8 @@ void TriangleSelector::seed_fill_fill_gaps(const std::vector<int> &gap_fill_cand
 
             if (current_facet.is_split()) {
                 for (int split_triangle_idx = 0; split_triangle_idx <= current_facet.number_of_split_sides(); ++split_triangle_idx) {
-                    assert(split_triangle_idx < int(current_facet.children.size()));
-                    assert(current_facet.children[split_triangle_idx] < int(m_triangles.size()));
-                    if (int child = current_facet.children[split_triangle_idx]; !visited[child])
+                    assert(current_facet.child(split_triangle_idx) < int(m_triangles.size()));
+                    if (int child = current_facet.child(split_triangle_idx); !visited[child])
                         facet_queue.push(child);
                 }
             } else if (total_gap_area < seed_fill_gap_area) {
@@ -465,12 +462,11 @@ void TriangleSelector::precompute_all_neighbors_recursive(const int facet_idx, c
         int num_of_children = tr->number_of_split_sides() + 1;
         if (num_of_children != 1) {
             for (int i = 0; i < num_of_children; ++i) {
-                assert(i < int(tr->children.size()));
-                assert(tr->children[i] < int(m_triangles.size()));
+                assert(tr->child(i) < int(m_triangles.size()));
                 // Recursion, deep first search over the children of this triangle.
                 // All children of this triangle were created by splitting a single source triangle of the original mesh.
                 const Vec3i child_neighbors = this->child_neighbors(*tr, neighbors, i);
-                this->precompute_all_neighbors_recursive(tr->children[i], child_neighbors,
+                this->precompute_all_neighbors_recursive(tr->child(i), child_neighbors,
                                                          this->child_neighbors_propagated(*tr, neighbors_propagated, i, child_neighbors), neighbors_out,
                                                          neighbors_propagated_out);
             }
@@ -760,12 +756,12 @@ int TriangleSelector::neighbor_child(const Triangle &tr, int vertexi, int vertex
     if (tr.number_of_split_sides() == 1) {
         if (edge != next_idx_modulo(tr.special_side(), 3))
             // A child may or may not be split at this side.
-            return this->neighbor_child(m_triangles[tr.children[edge == tr.special_side() ? 0 : 1]], vertexi, vertexj, partition);
+            return this->neighbor_child(m_triangles[tr.child(edge == tr.special_side() ? 0 : 1)], vertexi, vertexj, partition);
         child_idx = partition == Partition::First ? 0 : 1;
     } else if (tr.number_of_split_sides() == 2) {
         if (edge == next_idx_modulo(tr.special_side(), 3))
             // A child may or may not be split at this side.
-            return this->neighbor_child(m_triangles[tr.children[2]], vertexi, vertexj, partition);
+            return this->neighbor_child(m_triangles[tr.child(2)], vertexi, vertexj, partition);
         child_idx = edge == tr.special_side() ?
             (partition == Partition::First ? 0 : 1) :
             (partition == Partition::First ? 2 : 0);
@@ -779,7 +775,7 @@ int TriangleSelector::neighbor_child(const Triangle &tr, int vertexi, int vertex
                  child_idx = partition == Partition::First ? 2 : 0; break;
         }
     }
-    return tr.children[child_idx];
+    return tr.child(child_idx);
 }
 
 // Return child of itriangle at a CCW oriented side (vertexi, vertexj), either first or 2nd part.
@@ -806,18 +802,18 @@ std::pair<int, int> TriangleSelector::triangle_subtriangles(const Triangle &tr,
     assert(tr.verts_idxs[next_idx_modulo(edge, 3)] == vertexj);
 
     if (tr.number_of_split_sides() == 1) {
-        return edge == next_idx_modulo(tr.special_side(), 3) ? std::make_pair(tr.children[0], tr.children[1]) :
-                                                                     std::make_pair(tr.children[edge == tr.special_side() ? 0 : 1], -1);
+        return edge == next_idx_modulo(tr.special_side(), 3) ? std::make_pair(tr.child(0), tr.child(1)) :
+                                                                     std::make_pair(tr.child(edge == tr.special_side() ? 0 : 1), -1);
     } else if (tr.number_of_split_sides() == 2) {
-        return edge == next_idx_modulo(tr.special_side(), 3) ? std::make_pair(tr.children[2], -1) :
-               edge == tr.special_side()                           ? std::make_pair(tr.children[0], tr.children[1]) :
-                                                                     std::make_pair(tr.children[2], tr.children[0]);
+        return edge == next_idx_modulo(tr.special_side(), 3) ? std::make_pair(tr.child(2), -1) :
+               edge == tr.special_side()                           ? std::make_pair(tr.child(0), tr.child(1)) :
+                                                                     std::make_pair(tr.child(2), tr.child(0));
     } else {
         assert(tr.number_of_split_sides() == 3);
         assert(tr.special_side() == 0);
-        return edge == 0 ? std::make_pair(tr.children[0], tr.children[1]) :
-               edge == 1 ? std::make_pair(tr.children[1], tr.children[2]) :
-                           std::make_pair(tr.children[2], tr.children[0]);
+        return edge == 0 ? std::make_pair(tr.child(0), tr.child(1)) :
+               edge == 1 ? std::make_pair(tr.child(1), tr.child(2)) :
+                           std::make_pair(tr.child(2), tr.child(0));
     }
 
     return std::make_pair(-1, -1);
@@ -838,21 +834,21 @@ int TriangleSelector::triangle_midpoint(const Triangle &tr, int vertexi, int ver
 
     if (tr.number_of_split_sides() == 1) {
         return edge == next_idx_modulo(tr.special_side(), 3) ?
-            m_triangles[tr.children[0]].verts_idxs[2] :
-            this->triangle_midpoint(m_triangles[tr.children[edge == tr.special_side() ? 0 : 1]], vertexi, vertexj);
+            m_triangles[tr.child(0)].verts_idxs[2] :
+            this->triangle_midpoint(m_triangles[tr.child(edge == tr.special_side() ? 0 : 1)], vertexi, vertexj);
     } else if (tr.number_of_split_sides() == 2) {
         return edge == next_idx_modulo(tr.special_side(), 3) ?
-                    this->triangle_midpoint(m_triangles[tr.children[2]], vertexi, vertexj) :
+                    this->triangle_midpoint(m_triangles[tr.child(2)], vertexi, vertexj) :
                edge == tr.special_side() ?
-                    m_triangles[tr.children[0]].verts_idxs[1] :
-                    m_triangles[tr.children[1]].verts_idxs[2];
+                    m_triangles[tr.child(0)].verts_idxs[1] :
+                    m_triangles[tr.child(1)].verts_idxs[2];
     } else {
         assert(tr.number_of_split_sides() == 3);
         assert(tr.special_side() == 0);
         return
-            (edge == 0) ? m_triangles[tr.children[0]].verts_idxs[1] :
-            (edge == 1) ? m_triangles[tr.children[1]].verts_idxs[2] :
-                          m_triangles[tr.children[2]].verts_idxs[2];
+            (edge == 0) ? m_triangles[tr.child(0)].verts_idxs[1] :
+            (edge == 1) ? m_triangles[tr.child(1)].verts_idxs[2] :
+                          m_triangles[tr.child(2)].verts_idxs[2];
     }
 }
 
@@ -920,13 +916,13 @@ Vec3i TriangleSelector::child_neighbors(const Triangle &tr, const Vec3i &neighbo
         case 0:
             out(0) = neighbors(i);
             out(1) = this->neighbor_child(neighbors(j), tr.verts_idxs[k], tr.verts_idxs[j], Partition::Second);
-            out(2) = tr.children[1];
+            out(2) = tr.child(1);
             break;
         default:
             assert(child_idx == 1);
             out(0) = this->neighbor_child(neighbors(j), tr.verts_idxs[k], tr.verts_idxs[j], Partition::First);
             out(1) = neighbors(k);
-            out(2) = tr.children[0];
+            out(2) = tr.child(0);
             break;
         }
         break;
@@ -935,20 +931,20 @@ Vec3i TriangleSelector::child_neighbors(const Triangle &tr, const Vec3i &neighbo
         switch (child_idx) {
         case 0:
             out(0) = this->neighbor_child(neighbors(i), tr.verts_idxs[j], tr.verts_idxs[i], Partition::Second);
-            out(1) = tr.children[1];
+            out(1) = tr.child(1);
             out(2) = this->neighbor_child(neighbors(k), tr.verts_idxs[i], tr.verts_idxs[k], Partition::First);
             break;
         case 1:
             assert(child_idx == 1);
             out(0) = this->neighbor_child(neighbors(i), tr.verts_idxs[j], tr.verts_idxs[i], Partition::First);
-            out(1) = tr.children[2];
-            out(2) = tr.children[0];
+            out(1) = tr.child(2);
+            out(2) = tr.child(0);
             break;
         default:
             assert(child_idx == 2);
             out(0) = neighbors(j);
             out(1) = this->neighbor_child(neighbors(k), tr.verts_idxs[i], tr.verts_idxs[k], Partition::Second);
-            out(2) = tr.children[1];
+            out(2) = tr.child(1);
             break;
         }
         break;
@@ -958,24 +954,24 @@ Vec3i TriangleSelector::child_neighbors(const Triangle &tr, const Vec3i &neighbo
         switch (child_idx) {
         case 0:
             out(0) = this->neighbor_child(neighbors(0), tr.verts_idxs[1], tr.verts_idxs[0], Partition::Second);
-            out(1) = tr.children[3];
+            out(1) = tr.child(3);
             out(2) = this->neighbor_child(neighbors(2), tr.verts_idxs[0], tr.verts_idxs[2], Partition::First);
             break;
         case 1:
             out(0) = this->neighbor_child(neighbors(0), tr.verts_idxs[1], tr.verts_idxs[0], Partition::First);
             out(1) = this->neighbor_child(neighbors(1), tr.verts_idxs[2], tr.verts_idxs[1], Partition::Second);
-            out(2) = tr.children[3];
+            out(2) = tr.child(3);
             break;
         case 2:
             out(0) = this->neighbor_child(neighbors(1), tr.verts_idxs[2], tr.verts_idxs[1], Partition::First);
             out(1) = this->neighbor_child(neighbors(2), tr.verts_idxs[0], tr.verts_idxs[2], Partition::Second);
-            out(2) = tr.children[3];
+            out(2) = tr.child(3);
             break;
         default:
             assert(child_idx == 3);
-            out(0) = tr.children[1];
-            out(1) = tr.children[2];
-            out(2) = tr.children[0];
+            out(0) = tr.child(1);
+            out(1) = tr.child(2);
+            out(2) = tr.child(0);
             break;
         }
         break;
@@ -985,7 +981,7 @@ Vec3i TriangleSelector::child_neighbors(const Triangle &tr, const Vec3i &neighbo
     }
 
     assert(this->verify_triangle_neighbors(tr, neighbors));
-    assert(this->verify_triangle_neighbors(m_triangles[tr.children[child_idx]], out));
+    assert(this->verify_triangle_neighbors(m_triangles[tr.child(child_idx)], out));
     return out;
 }
 
@@ -1102,11 +1098,10 @@ bool TriangleSelector::select_triangle_recursive(int facet_idx, const Vec3i &nei
         int num_of_children = tr->number_of_split_sides() + 1;
         if (num_of_children != 1) {
             for (int i=0; i<num_of_children; ++i) {
-                assert(i < int(tr->children.size()));
-                assert(tr->children[i] < int(m_triangles.size()));
+                assert(tr->child(i) < int(m_triangles.size()));
                 // Recursion, deep first search over the children of this triangle.
                 // All children of this triangle were created by splitting a single source triangle of the original mesh.
-                select_triangle_recursive(tr->children[i], this->child_neighbors(*tr, neighbors, i), type, triangle_splitting);
+                select_triangle_recursive(tr->child(i), this->child_neighbors(*tr, neighbors, i), type, triangle_splitting);
                 tr = &m_triangles[facet_idx]; // might have been invalidated
             }
         }
@@ -1284,8 +1279,9 @@ void TriangleSelector::undivide_triangle(int facet_idx)
     Triangle& tr = m_triangles[facet_idx];
 
     if (tr.is_split()) {
-        for (int i = 0; i <= tr.number_of_split_sides(); ++i) {
-            int       child    = tr.children[i];
+        const int num_children = tr.number_of_split_sides() + 1;
+        for (int i = 0; i < num_children; ++i) {
+            int       child    = tr.child(i);
             Triangle &child_tr = m_triangles[child];
             assert(child_tr.valid());
             undivide_triangle(child);
@@ -1302,16 +1298,17 @@ void TriangleSelector::undivide_triangle(int facet_idx)
                     assert(m_free_vertices_head >= -1 && m_free_vertices_head < int(m_vertices.size()));
                 }
             }
-            // Chain released triangles into a linked list through children[0].
             assert(child_tr.valid());
             child_tr.m_valid = false;
-            assert(m_free_triangles_head >= -1 && m_free_triangles_head < int(m_triangles.size()));
-            assert(m_free_triangles_head == -1 || ! m_triangles[m_free_triangles_head].valid());
-            child_tr.children[0] = m_free_triangles_head;
-            m_free_triangles_head = child;
-            assert(m_free_triangles_head >= -1 && m_free_triangles_head < int(m_triangles.size()));
             ++m_invalid_triangles;
         }
+        // Chain the released block of children into a linked list through first_child of its first triangle.
+        int &free_head = m_free_triangles_heads[num_children - 2];
+        assert(free_head >= -1 && free_head < int(m_triangles.size()));
+        assert(free_head == -1 || ! m_triangles[free_head].valid());
+        m_triangles[tr.first_child].first_child = free_head;
+        free_head = tr.first_child;
+        tr.first_child = -1;
         tr.set_division(0, 0); // not split
     }
 }
@@ -1334,18 +1331,18 @@ bool TriangleSelector::remove_useless_children(int facet_idx) {
     bool children_removed = false;
     for (int child_idx = 0; child_idx <= tr.number_of_split_sides(); ++child_idx) {
         assert(child_idx < int(m_triangles.size()) && m_triangles[child_idx].valid());
-        if (m_triangles[tr.children[child_idx]].is_split())
-            children_removed |= remove_useless_children(tr.children[child_idx]);
+        if (m_triangles[tr.child(child_idx)].is_split())
+            children_removed |= remove_useless_children(tr.child(child_idx));
     }
 
     // Return if a child is not leaf or two children differ in type.
     TriangleStateType first_child_type = TriangleStateType::NONE;
     for (int child_idx = 0; child_idx <= tr.number_of_split_sides(); ++child_idx) {
-        if (m_triangles[tr.children[child_idx]].is_split())
+        if (m_triangles[tr.child(child_idx)].is_split())
             return children_removed;
         if (child_idx == 0)
-            first_child_type = m_triangles[tr.children[0]].get_state();
-        else if (m_triangles[tr.children[child_idx]].get_state() != first_child_type)
+            first_child_type = m_triangles[tr.child(0)].get_state();
+        else if (m_triangles[tr.child(child_idx)].get_state() != first_child_type)
             return children_removed;
     }
 
@@ -1387,11 +1384,11 @@ void TriangleSelector::garbage_collect()
         assert(tr.valid());
 
         if (tr.is_split()) {
-            // There are children. Update their indices.
-            for (int j=0; j<=tr.number_of_split_sides(); ++j) {
-                assert(new_triangle_indices[tr.children[j]] != -1);
-                tr.children[j] = new_triangle_indices[tr.children[j]];
-            }
+            // There are children. Update their indices. The blocks of children stay contiguous,
+            // as the children of a triangle are allocated and released together.
+            assert(new_triangle_indices[tr.first_child] != -1);
+            assert(new_triangle_indices[tr.child(tr.number_of_split_sides())] == new_triangle_indices[tr.first_child] + tr.number_of_split_sides());
+            tr.first_child = new_triangle_indices[tr.first_child];
         }
 
         // Update indices into m_vertices. The original vertices are never
@@ -1405,7 +1402,7 @@ void TriangleSelector::garbage_collect()
     }
 
     m_invalid_triangles = 0;
-    m_free_triangles_head = -1;
+    m_free_triangles_heads = { -1, -1, -1 };
     m_free_vertices_head = -1;
 }
 
@@ -1420,7 +1417,7 @@ void TriangleSelector::reset()
     m_vertices.clear();
     m_triangles.clear();
     m_invalid_triangles = 0;
-    m_free_triangles_head = -1;
+    m_free_triangles_heads = { -1, -1, -1 };
     m_free_vertices_head = -1;
     m_vertices.reserve(m_mesh.its.vertices.size());
     for (const stl_vertex& vert : m_mesh.its.vertices)
@@ -1440,49 +1437,66 @@ void TriangleSelector::set_edge_limit(float edge_limit)
     m_edge_limit_sqr = Slic3r::sqr(edge_limit);
 }
 
+// Append a triangle of the source mesh, called by reset().
 int TriangleSelector::push_triangle(int a, int b, int c, int source_triangle, const TriangleStateType state) {
     for (int i : {a, b, c}) {
         assert(i >= 0 && i < int(m_vertices.size()));
         ++m_vertices[i].ref_cnt;
     }
-    int idx;
-    if (m_free_triangles_head == -1) {
-        // Allocate a new triangle.
-        assert(m_invalid_triangles == 0);
-        idx = int(m_triangles.size());
-        m_triangles.emplace_back(a, b, c, source_triangle, state);
-    } else {
-        // Reuse triangle from the free list.
-        assert(m_free_triangles_head >= -1 && m_free_triangles_head < int(m_triangles.size()));
-        assert(! m_triangles[m_free_triangles_head].valid());
-        assert(m_invalid_triangles > 0);
-        idx = m_free_triangles_head;
-        m_free_triangles_head = m_triangles[idx].children[0];
-        -- m_invalid_triangles;
-        assert(m_free_triangles_head >= -1 && m_free_triangles_head < int(m_triangles.size()));
-        assert(m_free_triangles_head == -1 || ! m_triangles[m_free_triangles_head].valid());
-        assert(m_invalid_triangles >= 0);
-        assert((m_invalid_triangles == 0) == (m_free_triangles_head == -1));
-        m_triangles[idx] = {a, b, c, source_triangle, state};
-    }
-    assert(m_triangles[idx].valid());
+    int idx = int(m_triangles.size());
+    m_triangles.emplace_back(a, b, c, source_triangle, state);
+    return idx;
+}
+
+// Allocate a contiguous block of num_children triangles, possibly reusing a released block of the same size.
+// The triangles of the block are not valid until initialized by init_child().
+int TriangleSelector::allocate_children(int num_children) {
+    assert(num_children >= 2 && num_children <= 4);
+    int &free_head = m_free_triangles_heads[num_children - 2];
+    if (free_head == -1) {
+        // Allocate new triangles.
+        if (size_t num_triangles_new = m_triangles.size() + num_children; m_triangles.capacity() < num_triangles_new)
+            m_triangles.reserve(next_highest_power_of_2(num_triangles_new));
+        int idx = int(m_triangles.size());
+        m_triangles.insert(m_triangles.end(), num_children, Triangle(-1, -1, -1, -1, TriangleStateType::NONE));
+        for (int i = 0; i < num_children; ++ i)
+            m_triangles[idx + i].m_valid = false;
+        m_invalid_triangles += num_children;
+        return idx;
+    }
+
+    // Reuse a block from the free list.
+    assert(free_head < int(m_triangles.size()));
+    assert(m_invalid_triangles >= num_children);
+    int idx = free_head;
+    free_head = m_triangles[idx].first_child;
+    assert(free_head >= -1 && free_head < int(m_triangles.size()));
+    assert(free_head == -1 || ! m_triangles[free_head].valid());
     return idx;
 }
 
+void TriangleSelector::init_child(int idx, int a, int b, int c, int source_triangle, const TriangleStateType state) {
+    for (int i : {a, b, c}) {
+        assert(i >= 0 && i < int(m_vertices.size()));
+        ++m_vertices[i].ref_cnt;
+    }
+    assert(! m_triangles[idx].valid());
+    m_triangles[idx] = {a, b, c, source_triangle, state};
+    -- m_invalid_triangles;
+    assert(m_invalid_triangles >= 0);
+}
+
 // called by deserialize() and select_patch()->select_triangle()->...select_triangle()->split_triangle()
 // Split a triangle based on Triangle::number_of_split_sides() and Triangle::special_side()
 // by allocating child triangles and midpoint vertices.
 // Midpoint vertices are possibly reused by traversing children of neighbor triangles.
 void TriangleSelector::perform_split(int facet_idx, const Vec3i &neighbors, TriangleStateType old_state) {
-    // Reserve space for the new triangles upfront, so that the reference to this triangle will not change.
-    {
-        size_t num_triangles_new = m_triangles.size() + m_triangles[facet_idx].number_of_split_sides() + 1;
-        if (m_triangles.capacity() < num_triangles_new)
-            m_triangles.reserve(next_highest_power_of_2(num_triangles_new));
-    }
+    // Allocate the new triangles upfront, so that the reference to this triangle will not change.
+    const int first_child = this->allocate_children(m_triangles[facet_idx].number_of_split_sides() + 1);
 
     Triangle &tr = m_triangles[facet_idx];
     assert(tr.is_split());
+    tr.first_child = first_child;
 
     // indices of triangle vertices
 #ifdef NDEBUG
@@ -1503,16 +1517,16 @@ void TriangleSelector::perform_split(int facet_idx, const Vec3i &neighbors, Tria
     switch (tr.number_of_split_sides()) {
     case 1:
         verts_idxs.insert(verts_idxs.begin()+2, get_alloc_vertex(next_idx_modulo(tr.special_side(), 3), 2, 1));
-        tr.children[ichild ++] = push_triangle(verts_idxs[0], verts_idxs[1], verts_idxs[2], tr.source_triangle, old_state);
-        tr.children[ichild   ] = push_triangle(verts_idxs[2], verts_idxs[3], verts_idxs[0], tr.source_triangle, old_state);
+        init_child(first_child + ichild ++, verts_idxs[0], verts_idxs[1], verts_idxs[2], tr.source_triangle, old_state);
+        init_child(first_child + ichild, verts_idxs[2], verts_idxs[3], verts_idxs[0], tr.source_triangle, old_state);
         break;
 
     case 2:
         verts_idxs.insert(verts_idxs.begin()+1, get_alloc_vertex(tr.special_side(), 1, 0));
         verts_idxs.insert(verts_idxs.begin()+4, get_alloc_vertex(prev_idx_modulo(tr.special_side(), 3), 0, 3));
-        tr.children[ichild ++] = push_triangle(verts_idxs[0], verts_idxs[1], verts_idxs[4], tr.source_triangle, old_state);
-        tr.children[ichild ++] = push_triangle(verts_idxs[1], verts_idxs[2], verts_idxs[4], tr.source_triangle, old_state);
-        tr.children[ichild   ] = push_triangle(verts_idxs[2], verts_idxs[3], verts_idxs[4], tr.source_triangle, old_state);
+        init_child(first_child + ichild ++, verts_idxs[0], verts_idxs[1], verts_idxs[4], tr.source_triangle, old_state);
+        init_child(first_child + ichild ++, verts_idxs[1], verts_idxs[2], verts_idxs[4], tr.source_triangle, old_state);
+        init_child(first_child + ichild, verts_idxs[2], verts_idxs[3], verts_idxs[4], tr.source_triangle, old_state);
         break;
 
     case 3:
@@ -1520,10 +1534,10 @@ void TriangleSelector::perform_split(int facet_idx, const Vec3i &neighbors, Tria
         verts_idxs.insert(verts_idxs.begin()+1, get_alloc_vertex(0, 1, 0));
         verts_idxs.insert(verts_idxs.begin()+3, get_alloc_vertex(1, 3, 2));
         verts_idxs.insert(verts_idxs.begin()+5, get_alloc_vertex(2, 0, 4));
-        tr.children[ichild ++] = push_triangle(verts_idxs[0], verts_idxs[1], verts_idxs[5], tr.source_triangle, old_state);
-        tr.children[ichild ++] = push_triangle(verts_idxs[1], verts_idxs[2], verts_idxs[3], tr.source_triangle, old_state);
-        tr.children[ichild ++] = push_triangle(verts_idxs[3], verts_idxs[4], verts_idxs[5], tr.source_triangle, old_state);
-        tr.children[ichild   ] = push_triangle(verts_idxs[1], verts_idxs[3], verts_idxs[5], tr.source_triangle, old_state);
+        init_child(first_child + ichild ++, verts_idxs[0], verts_idxs[1], verts_idxs[5], tr.source_triangle, old_state);
+        init_child(first_child + ichild ++, verts_idxs[1], verts_idxs[2], verts_idxs[3], tr.source_triangle, old_state);
+        init_child(first_child + ichild ++, verts_idxs[3], verts_idxs[4], verts_idxs[5], tr.source_triangle, old_state);
+        init_child(first_child + ichild, verts_idxs[1], verts_idxs[3], verts_idxs[5], tr.source_triangle, old_state);
         break;
 
     default:
@@ -1534,7 +1548,7 @@ void TriangleSelector::perform_split(int facet_idx, const Vec3i &neighbors, Tria
     assert(this->verify_triangle_neighbors(tr, neighbors));
     for (int i = 0; i <= tr.number_of_split_sides(); ++i) {
         Vec3i n = this->child_neighbors(tr, neighbors, i);
-        assert(this->verify_triangle_neighbors(m_triangles[tr.children[i]], n));
+        assert(this->verify_triangle_neighbors(m_triangles[tr.child(i)], n));
     }
 #endif // NDEBUG
 }
@@ -1648,6 +1662,42 @@ indexed_triangle_set_with_color TriangleSelector::get_all_facets_strict_with_col
     return this->get_facets_strict<AdditionalMeshInfo::Color>([](const Triangle &tr) { return true; });
 }
 
+std::vector<indexed_triangle_set> TriangleSelector::get_facets_strict_per_state(const size_t num_states) const {
+    const indexed_triangle_set_with_color all = this->get_all_facets_strict_with_colors();
+
+    // Bucket the facets by their state.
+    std::vector<std::vector<int>> facets_per_state(num_states);
+    for (int facet_idx = 0; facet_idx < int(all.indices.size()); ++facet_idx)
+        if (const size_t state = all.colors[facet_idx]; state < num_states)
+            facets_per_state[state].emplace_back(facet_idx);
+
+    std::vector<indexed_triangle_set> out(num_states);
+    std::vector<int>                  vertex_map(all.vertices.size(), -1);
+    for (size_t state = 0; state < num_states; ++state) {
+        indexed_triangle_set &its = out[state];
+        its.indices.reserve(facets_per_state[state].size());
+        for (int facet_idx : facets_per_state[state]) {
+            stl_triangle_vertex_indices indices;
+            for (int i = 0; i < 3; ++i) {
+                int j = all.indices[facet_idx](i);
+                if (vertex_map[j] == -1) {
+                    vertex_map[j] = int(its.vertices.size());
+                    its.vertices.emplace_back(all.vertices[j]);
+                }
+                indices(i) = vertex_map[j];
+            }
+            its.indices.emplace_back(indices);
+        }
+
+        // Reset just the touched part of the vertex map for the next state.
+        for (int facet_idx : facets_per_state[state])
+            for (int i = 0; i < 3; ++i)
+                vertex_map[all.indices[facet_idx](i)] = -1;
+    }
+
+    return out;
+}
+
 template<AdditionalMeshInfo facet_info>
 void TriangleSelector::get_facets_strict_recursive(
     const Triangle                              &tr,
@@ -1659,7 +1709,7 @@ void TriangleSelector::get_facets_strict_recursive(
     if (tr.is_split()) {
         for (int i = 0; i <= tr.number_of_split_sides(); ++ i)
             this->get_facets_strict_recursive<facet_info>(
-                m_triangles[tr.children[i]],
+                m_triangles[tr.child(i)],
                 this->child_neighbors(tr, neighbors, i),
                 facet_filter, out_triangles, out_colors);
     } else if (facet_filter(tr)) {
@@ -1785,12 +1835,11 @@ void TriangleSelector::get_seed_fill_contour_recursive(const int facet_idx, cons
         int num_of_children = tr->number_of_split_sides() + 1;
         if (num_of_children != 1) {
             for (int i = 0; i < num_of_children; ++i) {
-                assert(i < int(tr->children.size()));
-                assert(tr->children[i] < int(m_triangles.size()));
+                assert(tr->child(i) < int(m_triangles.size()));
                 // Recursion, deep first search over the children of this triangle.
                 // All children of this triangle were created by splitting a single source triangle of the original mesh.
                 const Vec3i child_neighbors = this->child_neighbors(*tr, neighbors, i);
-                this->get_seed_fill_contour_recursive(tr->children[i], child_neighbors,
+                this->get_seed_fill_contour_recursive(tr->child(i), child_neighbors,
                                                       this->child_neighbors_propagated(*tr, neighbors_propagated, i, child_neighbors), edges_out);
             }
         }
@@ -1865,7 +1914,7 @@ TriangleSelector::TriangleSplittingData TriangleSelector::serialize() const {
                 // Now save all children.
                 // Serialized in reverse order for compatibility with PrusaSlicer 2.3.1.
                 for (int child_idx = split_sides; child_idx >= 0; -- child_idx)
-                    this->serialize(tr.children[child_idx]);
+                    this->serialize(tr.child(child_idx));
             } else {
                 // In case this is leaf, we better save information about its state.
                 const int n = static_cast<int>(tr.get_state());
@@ -1993,14 +2042,14 @@ void TriangleSelector::deserialize(const TriangleSplittingData &data, bool needs
                 const Triangle &tr = m_triangles[last.facet_id];
                 int   child_idx = last.total_children - last.processed_children - 1;
                 Vec3i neighbors = this->child_neighbors(tr, last.neighbors, child_idx);
-                int this_idx = tr.children[child_idx];
+                int this_idx = tr.child(child_idx);
                 m_triangles[this_idx].set_division(num_of_split_sides, special_side);
                 perform_split(this_idx, neighbors, TriangleStateType::NONE);
                 parents.push_back({this_idx, neighbors, 0, num_of_children});
             } else {
                 // this triangle belongs to last split one
                 int child_idx = last.total_children - last.processed_children - 1;
-                m_triangles[m_triangles[last.facet_id].children[child_idx]].set_state(state);
+                m_triangles[m_triangles[last.facet_id].child(child_idx)].set_state(state);
                 ++last.processed_children;
             }
 
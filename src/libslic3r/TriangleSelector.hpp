@@ -383,6 +383,9 @@ public:
     indexed_triangle_set get_all_facets_strict() const;
     // Get all facets with information about the colord of the facetd. Triangulate T-joints.
     indexed_triangle_set_with_color get_all_facets_strict_with_colors() const;
+    // Get facets of the states [0, num_states), one mesh per state. Triangulate T-joints.
+    // Traverses the tree once, which is cheaper than calling get_facets_strict() for each state.
+    std::vector<indexed_triangle_set> get_facets_strict_per_state(size_t num_states) const;
 
     // Get edges around the selected area by seed fill.
     std::vector<Vec2i> get_seed_fill_contour() const;
@@ -448,8 +451,10 @@ protected:
         // Index of the source triangle at the initial (unsplit) mesh.
         int source_triangle;
 
-        // Children triangles.
-        std::array<int, 4> children;
+        // Children triangles are allocated as a contiguous block in m_triangles, see TriangleSelector::allocate_children().
+        // A released block is chained into a free list through first_child of its first triangle.
+        int first_child { -1 };
+        int child(int child_idx) const noexcept { assert(is_split() && child_idx >= 0 && child_idx <= number_of_split_sides()); return first_child + child_idx; }
 
         // Set the division type.
         void set_division(int sides_to_split, int special_side_idx);
@@ -495,7 +500,8 @@ protected:
         int ref_cnt;
     };
 
-    // Lists of vertices and triangles, both original and new
+    // Lists of vertices and triangles, both original and new.
+    // 24 bytes per triangle, children of a triangle are stored next to each other.
     std::vector<Vertex> m_vertices;
     std::vector<Triangle> m_triangles;
     const TriangleMesh &m_mesh;
@@ -526,6 +532,8 @@ private:
     bool remove_useless_children(int facet_idx); // No hidden meaning. Triangles are meant.
     bool is_facet_clipped(int facet_idx, const ClippingPlane &clp) const;
     int  push_triangle(int a, int b, int c, int source_triangle, TriangleStateType state = TriangleStateType::NONE);
+    int  allocate_children(int num_children);
+    void init_child(int idx, int a, int b, int c, int source_triangle, TriangleStateType state);
     void perform_split(int facet_idx, const Vec3i &neighbors, TriangleStateType old_state);
     Vec3i child_neighbors(const Triangle &tr, const Vec3i &neighbors, int child_idx) const;
     Vec3i child_neighbors_propagated(const Triangle &tr, const Vec3i &neighbors_propagated, int child_idx, const Vec3i &child_neighbors) const;
@@ -582,7 +590,8 @@ private:
                                const std::vector<Vec3i> &neighbors,
                                const std::vector<Vec3i> &neighbors_propagate);
 
-    int m_free_triangles_head { -1 };
+    // Heads of the free lists of released blocks of 2, 3 and 4 children.
+    std::array<int, 3> m_free_triangles_heads { -1, -1, -1 };
     int m_free_vertices_head { -1 };
 };
 
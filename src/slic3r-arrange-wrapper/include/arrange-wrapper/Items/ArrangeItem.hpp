@@ -9,8 +9,10 @@
 #include <libslic3r/ClipperUtils.hpp>
 #include <assert.h>
 #include <stddef.h>
+#include <atomic>
 #include <optional>
 #include <algorithm>
+#include <functional>
 #include <initializer_list>
 #include <memory>
 #include <string>
@@ -26,6 +28,7 @@
 #include <libslic3r/Point.hpp>
 #include <libslic3r/Polygon.hpp>
 #include <libslic3r/libslic3r.h>
+#include <libslic3r/Execution/ExecutionSeq.hpp>
 
 #include <arrange/PackingContext.hpp>
 #include <arrange/NFP/NFPArrangeItemTraits.hpp>
@@ -63,6 +66,7 @@ inline bool check_polygons_are_convex(const Polygons &pp) {
 class DecomposedShape
 {
     Polygons m_shape;
+    size_t   m_shape_hash = 0; // Hash of the untransformed contours
 
     Vec2crd m_translation{0, 0}; // The translation of the poly
     double  m_rotation{0.0};     // The rotation of the poly in radians
@@ -88,6 +92,7 @@ public:
     explicit DecomposedShape(Polygon sh)
     {
         m_shape.emplace_back(std::move(sh));
+        m_shape_hash = hash(m_shape);
         assert(check_polygons_are_convex(m_shape));
     }
 
@@ -95,13 +100,18 @@ public:
         : DecomposedShape(Polygon{pts})
     {}
 
-    explicit DecomposedShape(Polygons sh) : m_shape{std::move(sh)}
+    explicit DecomposedShape(Polygons sh)
+        : m_shape{std::move(sh)}, m_shape_hash{hash(m_shape)}
     {
         assert(check_polygons_are_convex(m_shape));
     }
 
     const Polygons &contours() const { return m_shape; }
 
+    // Equal shapes have equal hashes regardless of their transformation.
+    size_t shape_hash() const { return m_shape_hash; }
+    static size_t hash(const Polygons &contours);
+
     const Vec2crd &translation() const { return m_translation; }
     double         rotation() const { return m_rotation; }
 
@@ -310,73 +320,72 @@ template<> struct WritableDataStoreTraits_<ArrangeItem>
     }
 };
 
-template<class FixedIt, class StopCond = DefaultStopCondition>
+// The no-fit polygon of the item's envelope around one fixed item. The caches
+// of the item's envelope have to be valid if called from multiple threads.
+Polygons calculate_nfp_unnormalized(const ArrangeItem &item, const ArrangeItem &fixed);
+
+// The no-fit polygons of the item's envelope around each of the fixed items,
+// united. The fixed items are processed with the given execution policy and
+// the no-fit polygons of the shape pairs which were already seen (e.g. copies
+// of the same object) are taken from a cache, see
+// calculate_nfp_unnormalized(item, fixed). The stop condition is checked
+// before each fixed item, an empty result is returned once it is met.
+template<class FixedIt,
+         class StopCond   = DefaultStopCondition,
+         class ExecPolicy = ExecutionSeq>
 static Polygons calculate_nfp_unnormalized(const ArrangeItem    &item,
                                            const Range<FixedIt> &fixed_items,
-                                           StopCond &&stop_cond = {})
+                                           StopCond &&stop_cond = {},
+                                           const ExecPolicy &ep = {})
 {
-    size_t cap = 0;
-
-    for (const ArrangeItem &fixitem : fixed_items) {
-        const Polygons &outlines = fixitem.shape().transformed_outline();
-        cap += outlines.size();
-    }
-
-    const Polygons &item_outlines = item.envelope().transformed_outline();
-
-    auto nfps = reserve_polygons(cap * item_outlines.size());
-
-    Vec2crd ref_whole = item.envelope().reference_vertex();
-    Polygon subnfp;
-
-    for (const ArrangeItem &fixed : fixed_items) {
-        // fixed_polys should already be a set of strictly convex polygons,
-        // as ArrangeItem stores convex-decomposed polygons
-        const Polygons & fixed_polys = fixed.shape().transformed_outline();
-
-        for (const Polygon &fixed_poly : fixed_polys) {
-            Point max_fixed = Slic3r::reference_vertex(fixed_poly);
-            for (size_t mi = 0; mi < item_outlines.size(); ++mi) {
-                const Polygon &movable = item_outlines[mi];
-                const Vec2crd &mref = item.envelope().reference_vertex(mi);
-                subnfp = nfp_convex_convex_legacy(fixed_poly, movable);
+    if (stop_cond())
+        return {};
+
+    auto fixed = reserve_vector<const ArrangeItem *>(fixed_items.size());
+    for (const ArrangeItem &fixitem : fixed_items)
+        fixed.emplace_back(&fixitem);
+
+    // Fill the caches of the envelope before it is shared by the threads.
+    // Every fixed item is only touched by a single thread.
+    item.envelope().reference_vertex();
+
+    std::atomic<bool> stopped = false;
+    std::vector<Polygons> subnfps(fixed.size());
+    execution::for_each(ep, size_t(0), fixed.size(),
+                        [&item, &fixed, &subnfps, &stop_cond, &stopped](size_t i) {
+                            if (stopped)
+                                return;
+                            if (stop_cond()) {
+                                stopped = true;
+                                return;
+                            }
+                            subnfps[i] = calculate_nfp_unnormalized(item, *fixed[i]);
+                        });
+
+    if (stopped || stop_cond())
+        return {};
 
-                Vec2crd min_movable = item.envelope().min_vertex(mi);
-
-                Vec2crd dtouch = max_fixed - min_movable;
-                Vec2crd top_other = mref + dtouch;
-                Vec2crd max_nfp = Slic3r::reference_vertex(subnfp);
-                auto dnfp = top_other - max_nfp;
-
-                auto d = ref_whole - mref + dnfp;
-                subnfp.translate(d);
-                nfps.emplace_back(subnfp);
-            }
-
-            if (stop_cond())
-                break;
-
-            nfps = union_(nfps);
-        }
+    size_t cap = 0;
+    for (const Polygons &p : subnfps)
+        cap += p.size();
 
-        if (stop_cond()) {
-            nfps.clear();
-            break;
-        }
-    }
+    auto nfps = reserve_polygons(cap);
+    for (Polygons &p : subnfps)
+        append(nfps, std::move(p));
 
-    return nfps;
+    return union_(nfps);
 }
 
 template<> struct NFPArrangeItemTraits_<ArrangeItem> {
-    template<class Context, class Bed, class StopCond>
+    template<class Context, class Bed, class StopCond, class ExecPolicy>
     static ExPolygons calculate_nfp(const ArrangeItem &item,
                                     const Context &packing_context,
                                     const Bed &bed,
-                                    StopCond &&stopcond)
+                                    StopCond &&stopcond,
+                                    const ExecPolicy &ep)
     {
         auto static_items = all_items_range(packing_context);
-        Polygons nfps = arr2::calculate_nfp_unnormalized(item, static_items, stopcond);
+        Polygons nfps = arr2::calculate_nfp_unnormalized(item, static_items, stopcond, ep);
 
         ExPolygons nfp_ex;
 
@@ -82,11 +82,12 @@ public:
 
 template<> struct NFPArrangeItemTraits_<SimpleArrangeItem>
 {
-    template<class Context, class Bed, class StopCond>
+    template<class Context, class Bed, class StopCond, class ExecPolicy>
     static ExPolygons calculate_nfp(const SimpleArrangeItem &item,
                                     const Context &packing_context,
                                     const Bed &bed,
-                                    StopCond &&stop_cond)
+                                    StopCond &&stop_cond,
+                                    const ExecPolicy &)
     {
         auto fixed_items = all_items_range(packing_context);
         auto nfps = reserve_polygons(fixed_items.size());
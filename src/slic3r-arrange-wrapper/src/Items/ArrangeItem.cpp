@@ -4,6 +4,10 @@
 ///|/
 
 #include <numeric>
+#include <mutex>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
 
 #include <libslic3r/Geometry/ConvexHull.hpp>
 #include <arrange/NFP/NFPConcave_Tesselate.hpp>
@@ -16,6 +20,166 @@
 
 namespace Slic3r { namespace arr2 {
 
+namespace {
+
+// Cache of no-fit polygons of shape pairs, shared by all the arrangements.
+// Plates with many copies of the same objects need the same few pairs over
+// and over. An entry is keyed by the hashes and rotations of both shapes, the
+// contours are compared as well to rule out hash collisions.
+//
+// The no-fit polygon relative to the reference vertex of the moving shape does
+// not depend on the translation of the moving shape and moves along with the
+// fixed shape. The polygons are stored for the fixed shape at the origin.
+class NFPCache
+{
+public:
+    struct Key
+    {
+        size_t fixed_hash, movable_hash;
+        double fixed_rotation, movable_rotation;
+
+        bool operator==(const Key &o) const
+        {
+            return fixed_hash == o.fixed_hash && movable_hash == o.movable_hash &&
+                   fixed_rotation == o.fixed_rotation &&
+                   movable_rotation == o.movable_rotation;
+        }
+    };
+
+    struct Entry
+    {
+        Polygons fixed, movable, nfp;
+    };
+
+    static Key key(const DecomposedShape &fixed, const DecomposedShape &movable)
+    {
+        return {fixed.shape_hash(), movable.shape_hash(), fixed.rotation(), movable.rotation()};
+    }
+
+    std::shared_ptr<const Entry> find(const Key             &k,
+                                      const DecomposedShape &fixed,
+                                      const DecomposedShape &movable) const
+    {
+        std::lock_guard lk{m_mutex};
+        auto it = m_entries.find(k);
+        if (it == m_entries.end() || it->second->fixed != fixed.contours() ||
+            it->second->movable != movable.contours())
+            return {};
+
+        return it->second;
+    }
+
+    void insert(const Key &k, std::shared_ptr<const Entry> entry)
+    {
+        std::lock_guard lk{m_mutex};
+
+        // Dropping everything is cheap and good enough for a cache which is
+        // mostly hit by the copies of a handful of objects.
+        if (m_entries.size() >= MaxEntries)
+            m_entries.clear();
+
+        m_entries.insert_or_assign(k, std::move(entry));
+    }
+
+private:
+    static constexpr size_t MaxEntries = 1024;
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &k) const
+        {
+            size_t seed = k.fixed_hash;
+            boost::hash_combine(seed, k.movable_hash);
+            boost::hash_combine(seed, k.fixed_rotation);
+            boost::hash_combine(seed, k.movable_rotation);
+            return seed;
+        }
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<Key, std::shared_ptr<const Entry>, KeyHash> m_entries;
+};
+
+NFPCache &nfp_cache()
+{
+    static NFPCache cache;
+    return cache;
+}
+
+Polygons calculate_nfp_uncached(const DecomposedShape &envelope, const Polygons &fixed_polys)
+{
+    const Polygons &item_outlines = envelope.transformed_outline();
+    const Vec2crd  &ref_whole     = envelope.reference_vertex();
+
+    auto nfps = reserve_polygons(fixed_polys.size() * item_outlines.size());
+
+    // fixed_polys should already be a set of strictly convex polygons,
+    // as ArrangeItem stores convex-decomposed polygons
+    for (const Polygon &fixed_poly : fixed_polys) {
+        Point max_fixed = Slic3r::reference_vertex(fixed_poly);
+        for (size_t mi = 0; mi < item_outlines.size(); ++mi) {
+            const Polygon &movable = item_outlines[mi];
+            const Vec2crd &mref = envelope.reference_vertex(mi);
+            Polygon subnfp = nfp_convex_convex_legacy(fixed_poly, movable);
+
+            Vec2crd min_movable = envelope.min_vertex(mi);
+
+            Vec2crd dtouch = max_fixed - min_movable;
+            Vec2crd top_other = mref + dtouch;
+            Vec2crd max_nfp = Slic3r::reference_vertex(subnfp);
+            auto dnfp = top_other - max_nfp;
+
+            auto d = ref_whole - mref + dnfp;
+            subnfp.translate(d);
+            nfps.emplace_back(std::move(subnfp));
+        }
+    }
+
+    return union_(nfps);
+}
+
+} // namespace
+
+size_t DecomposedShape::hash(const Polygons &contours)
+{
+    size_t seed = contours.size();
+    for (const Polygon &poly : contours) {
+        boost::hash_combine(seed, poly.size());
+        for (const Point &p : poly.points) {
+            boost::hash_combine(seed, p.x());
+            boost::hash_combine(seed, p.y());
+        }
+    }
+
+    return seed;
+}
+
+Polygons calculate_nfp_unnormalized(const ArrangeItem &item, const ArrangeItem &fixed)
+{
+    const DecomposedShape &envelope = item.envelope();
+    const DecomposedShape &shape    = fixed.shape();
+
+    NFPCache::Key key = NFPCache::key(shape, envelope);
+    std::shared_ptr<const NFPCache::Entry> entry = nfp_cache().find(key, shape, envelope);
+
+    if (!entry) {
+        DecomposedShape origin_shape = shape;
+        origin_shape.translation(Vec2crd::Zero());
+
+        entry = std::make_shared<NFPCache::Entry>(
+            NFPCache::Entry{shape.contours(), envelope.contours(),
+                            calculate_nfp_uncached(envelope, origin_shape.transformed_outline())});
+
+        nfp_cache().insert(key, entry);
+    }
+
+    Polygons nfp = entry->nfp;
+    for (Polygon &p : nfp)
+        p.translate(shape.translation());
+
+    return nfp;
+}
+
 const Polygons &DecomposedShape::transformed_outline() const
 {
     constexpr auto sc = scaled<double>(1.) * scaled<double>(1.);
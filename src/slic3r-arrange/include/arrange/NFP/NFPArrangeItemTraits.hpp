@@ -10,6 +10,8 @@
 #include <libslic3r/ExPolygon.hpp>
 #include <libslic3r/BoundingBox.hpp>
 
+#include <libslic3r/Execution/ExecutionSeq.hpp>
+
 #include <arrange/ArrangeBase.hpp>
 
 
@@ -19,11 +21,13 @@ namespace Slic3r { namespace arr2 {
 // to be usable with PackStrategyNFP.
 template<class ArrItem, class En = void> struct NFPArrangeItemTraits_
 {
-    template<class Context, class Bed, class StopCond = DefaultStopCondition>
+    template<class Context, class Bed, class StopCond = DefaultStopCondition,
+             class ExecPolicy = ExecutionSeq>
     static ExPolygons calculate_nfp(const ArrItem &item,
                                     const Context &packing_context,
                                     const Bed &bed,
-                                    StopCond stop_condition = {})
+                                    StopCond stop_condition = {},
+                                    const ExecPolicy &ep = {})
     {
         static_assert(always_false<ArrItem>::value,
                       "NFP unimplemented for this item type.");
@@ -94,17 +98,22 @@ template<class ArrItem, class En = void> struct NFPArrangeItemTraits_
 template<class T>
 using NFPArrangeItemTraits = NFPArrangeItemTraits_<StripCVRef<T>>;
 
+// The execution policy may be used by the item type to compute the no-fit
+// polygons around the fixed items in parallel.
 template<class ArrItem,
          class Context,
          class Bed,
-         class StopCond = DefaultStopCondition>
+         class StopCond = DefaultStopCondition,
+         class ExecPolicy = ExecutionSeq>
 ExPolygons calculate_nfp(const ArrItem &itm,
                          const Context &context,
                          const Bed &bed,
-                         StopCond stopcond = {})
+                         StopCond stopcond = {},
+                         const ExecPolicy &ep = {})
 {
     return NFPArrangeItemTraits<ArrItem>::calculate_nfp(itm, context, bed,
-                                                        std::move(stopcond));
+                                                        std::move(stopcond),
+                                                        ep);
 }
 
 template<class ArrItem> Vec2crd reference_vertex(const ArrItem &itm)
@@ -252,7 +252,7 @@ bool pack(Strategy &strategy,
         set_translation(item, orig_tr);
 
         auto nfp = calculate_nfp(item, packing_context, bed,
-                                 strategy.stop_condition);
+                                 strategy.stop_condition, strategy.ep);
         double score = NaNd;
         if (!nfp.empty()) {
             score = pick_best_spot_on_nfp(item, nfp, bed, strategy);
@@ -495,11 +495,13 @@ void GLGizmoSimplify::process()
             m_state.status = State::Status::running;
         }
 
-        // Start the actual calculation.
+        // Start the actual calculation. Most of the reduction of big meshes
+        // is made on clusters in parallel, the callbacks above are thread safe.
+        constexpr float quality = 0.2f;
         try {
             for (const auto& it : its) {
                 float me = max_error;
-                its_quadric_edge_collapse(*it.second, triangle_count, &me, throw_on_cancel, statusfn);
+                its_quadric_edge_collapse(*it.second, triangle_count, &me, throw_on_cancel, statusfn, quality);
             }
         } catch (SimplifyCanceledException &) {
             std::lock_guard lk(m_state_mutex);
@@ -3066,6 +3066,11 @@ void TabPrinter::build_sla()
     optgroup = page->new_optgroup(L("Output"));
     optgroup->append_single_option_line("sla_archive_format");
     optgroup->append_single_option_line("sla_output_precision");
+    optgroup->append_single_option_line("sla_archive_compression");
+
+    optgroup = page->new_optgroup(L("Memory"));
+    optgroup->append_single_option_line("sla_slices_compression");
+    optgroup->append_single_option_line("sla_slices_memory_limit");
 
     build_print_host_upload_group(page.get());
 
@@ -19,6 +19,8 @@
 #include <map>
 #include <type_traits>
 #include <cstring>
+#include <array>
+#include <unordered_map>
 
 #define CEREAL_FUTURE_EXPERIMENTAL
 #include <cereal/archives/adapters.hpp>
@@ -28,6 +30,9 @@
 #include "slic3r/GUI/3DScene.hpp" // IWYU pragma: keep
 #include "libslic3r/BoundingBox.hpp"
 #include "libslic3r/Exception.hpp"
+
+#include <boost/uuid/detail/md5.hpp>
+#include <miniz.h>
 #if 0
 	// Stop at a fraction of the normal Undo / Redo stack size.
 	#define UNDO_REDO_DEBUG_LOW_MEM_FACTOR 10000
@@ -84,6 +89,173 @@ private:
 	size_t 	m_end;
 };
 
+// Random table of the gear rolling hash used to find the chunk boundaries.
+static const std::array<uint64_t, 256>& gear_table()
+{
+	static const std::array<uint64_t, 256> table = [] {
+		std::array<uint64_t, 256> out;
+		// splitmix64
+		uint64_t x = 0;
+		for (uint64_t &v : out) {
+			x += 0x9E3779B97F4A7C15ull;
+			uint64_t z = x;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			v = z ^ (z >> 31);
+		}
+		return out;
+	}();
+	return table;
+}
+
+std::vector<ChunkStore::Chunk*> ChunkStore::store(const std::string &data)
+{
+	const std::array<uint64_t, 256> &gear = gear_table();
+	std::vector<Chunk*> out;
+	out.reserve(data.size() / 8192 + 1);
+	for (size_t begin = 0; begin < data.size();) {
+		size_t end = std::min(data.size(), begin + max_chunk_size);
+		if (end - begin > min_chunk_size) {
+			uint64_t hash = 0;
+			for (size_t i = begin + min_chunk_size; i < end; ++ i) {
+				hash = (hash << 1) + gear[uint8_t(data[i])];
+				if ((hash & boundary_mask) == 0) {
+					end = i + 1;
+					break;
+				}
+			}
+		}
+		out.emplace_back(this->acquire(data.data() + begin, end - begin));
+		begin = end;
+	}
+	return out;
+}
+
+ChunkStore::Digest ChunkStore::digest(const char *data, size_t size)
+{
+	// boost::uuids::detail::md5 is an internal namespace thus it may change in the future, see appconfig_md5_hash_line().
+	using boost::uuids::detail::md5;
+	md5 				hash;
+	md5::digest_type 	md5_digest{};
+	hash.process_bytes(data, size);
+	hash.get_digest(md5_digest);
+	static_assert(sizeof(md5_digest) == sizeof(Digest));
+	Digest out;
+	memcpy(out.data(), &md5_digest, out.size());
+	return out;
+}
+
+ChunkStore::Chunk* ChunkStore::acquire(const char *data, size_t size)
+{
+	// Chunks of the same 128 bit digest are considered equal, the stored chunk is not inflated to be compared.
+	Digest key = digest(data, size);
+	if (auto it = m_chunks.find(key); it != m_chunks.end()) {
+		assert(it->second->size == size);
+		++ it->second->refcnt;
+		return it->second.get();
+	}
+
+	auto chunk = std::make_unique<Chunk>();
+	chunk->refcnt = 1;
+	chunk->digest = key;
+	chunk->size   = size;
+	mz_ulong len = mz_compressBound(mz_ulong(size));
+	chunk->data.resize(len);
+	if (mz_compress2(reinterpret_cast<unsigned char*>(chunk->data.data()), &len, reinterpret_cast<const unsigned char*>(data), mz_ulong(size), deflate_level) == MZ_OK &&
+		len < size - size / 8) {
+		chunk->data.resize(len);
+		chunk->deflated = true;
+	} else
+		// Not worth deflating.
+		chunk->data.assign(data, data + size);
+	chunk->data.shrink_to_fit();
+	return m_chunks.emplace(key, std::move(chunk)).first->second.get();
+}
+
+void ChunkStore::release(Chunk *chunk)
+{
+	assert(chunk->refcnt > 0);
+	if (-- chunk->refcnt > 0)
+		return;
+	// Copy of the key, the chunk is destroyed by erase().
+	Digest key = chunk->digest;
+	assert(m_chunks.count(key) == 1 && m_chunks.find(key)->second.get() == chunk);
+	m_chunks.erase(key);
+}
+
+void ChunkStore::read(const Chunk &chunk, std::string &out)
+{
+	size_t offset = out.size();
+	if (! chunk.deflated) {
+		out.append(chunk.data.data(), chunk.data.size());
+		return;
+	}
+	out.resize(offset + chunk.size);
+	mz_ulong len = mz_ulong(chunk.size);
+	if (mz_uncompress(reinterpret_cast<unsigned char*>(&out[offset]), &len, reinterpret_cast<const unsigned char*>(chunk.data.data()), mz_ulong(chunk.data.size())) != MZ_OK ||
+		len != chunk.size)
+		throw Slic3r::RuntimeError("Undo / Redo stack data are corrupted.");
+}
+
+// Serialized data of a single object stored as a sequence of chunks of the ChunkStore.
+class ChunkedData
+{
+public:
+	ChunkedData() = default;
+	ChunkedData(ChunkStore &store, const std::string &data) : m_store(&store), m_chunks(store.store(data)), m_size(data.size()) {}
+	ChunkedData(ChunkedData &&rhs) : m_store(rhs.m_store), m_chunks(std::move(rhs.m_chunks)), m_size(rhs.m_size) { rhs.m_chunks.clear(); rhs.m_size = 0; }
+	ChunkedData& operator=(ChunkedData &&rhs) {
+		if (this != &rhs) {
+			this->clear();
+			m_store  = rhs.m_store;
+			m_chunks = std::move(rhs.m_chunks);
+			m_size   = rhs.m_size;
+			rhs.m_chunks.clear();
+			rhs.m_size = 0;
+		}
+		return *this;
+	}
+	~ChunkedData() { this->clear(); }
+
+	void 		clear() {
+		for (ChunkStore::Chunk *chunk : m_chunks)
+			m_store->release(chunk);
+		m_chunks.clear();
+		m_size = 0;
+	}
+
+	bool 		empty() const { return m_chunks.empty(); }
+	// Size of the serialized data.
+	size_t 		size() const { return m_size; }
+
+	// Memory occupied by the chunks. Each chunk is counted by the share of its references, rounded up.
+	size_t 		memsize() const {
+		size_t memsize = sizeof(*this) + m_chunks.capacity() * sizeof(ChunkStore::Chunk*);
+		for (const ChunkStore::Chunk *chunk : m_chunks)
+			memsize += (chunk->memsize() + chunk->refcnt - 1) / chunk->refcnt;
+		return memsize;
+	}
+
+	std::string data() const {
+		std::string out;
+		out.reserve(m_size);
+		for (const ChunkStore::Chunk *chunk : m_chunks)
+			ChunkStore::read(*chunk, out);
+		return out;
+	}
+
+	// The chunks are unique in the ChunkStore, thus the same data are made of the same chunks.
+	bool 		operator==(const ChunkedData &rhs) const { return m_chunks == rhs.m_chunks; }
+
+private:
+	ChunkStore 						*m_store { nullptr };
+	std::vector<ChunkStore::Chunk*>  m_chunks;
+	size_t 							 m_size { 0 };
+
+	ChunkedData(const ChunkedData &rhs);
+	ChunkedData& operator=(const ChunkedData &rhs);
+};
+
 // History of a single object tracked by the Undo / Redo stack. The object may be mutable or immutable.
 class ObjectHistoryBase
 {
@@ -115,6 +287,9 @@ public:
 	virtual size_t release_optional() = 0;
 	// Restore optional data possibly released by release_optional.
 	virtual void   restore_optional() = 0;
+	// Serialize the immutable object into the chunks of the stack if it is not referenced from outside of the stack,
+	// and release it. Return the amount of memory released.
+	virtual size_t pack_unshared(StackImpl &/* stack */) { return 0; }
 
 	// Estimated size in memory, to be used to drop least recently used snapshots.
 	virtual size_t memsize() const = 0;
@@ -246,7 +421,7 @@ public:
 	size_t memsize() const override {
 		size_t memsize = sizeof(*this);
 		if (this->is_serialized())
-			memsize += m_serialized.size();
+			memsize += m_serialized.memsize();
 		else if (m_shared_object.use_count() == 1)
 			// Only count the shared object's memsize into the total Undo / Redo stack memsize if it is referenced from the Undo / Redo stack only.
 			memsize += m_shared_object->memsize();
@@ -282,7 +457,7 @@ public:
 		if (m_optional) {
 			bool released = false;
 			if (this->is_serialized()) {
-				mem_released += m_serialized.size();
+				mem_released += m_serialized.memsize();
 				m_serialized.clear();
 				released = true;
 			} else if (m_shared_object.use_count() == 1) {
@@ -307,8 +482,10 @@ public:
 			const_cast<T*>(m_shared_object.get())->restore_optional();
 	}
 
+	size_t 						pack_unshared(StackImpl &stack) override;
+
 	bool 						is_serialized() const { return m_shared_object.get() == nullptr; }
-	const std::string&			serialized_data() const { return m_serialized; }
+	const ChunkedData&			serialized_data() const { return m_serialized; }
 	std::shared_ptr<const T>& 	shared_ptr(StackImpl &stack);
 
 #ifdef SLIC3R_UNDOREDO_DEBUG
@@ -333,7 +510,7 @@ private:
 	std::shared_ptr<const T>	m_shared_object;
 	// If this object is optional, then it may be deleted from the Undo / Redo stack and recalculated from other data (for example mesh convex hull).
 	bool 						m_optional;
-	std::string 				m_serialized;
+	ChunkedData 				m_serialized;
 };
 
 struct MutableHistoryInterval
@@ -344,26 +521,22 @@ private:
 		// Reference counter of this data chunk. We may have used shared_ptr, but the shared_ptr is thread safe
 		// with the associated cost of CPU cache invalidation on refcount change.
 		size_t		refcnt;
-		size_t		size;
-		char 		data[1];
+		// The first 8 bytes of the serialized data, kept aside to check the timestamp without reading the chunks.
+		uint64_t 	header;
+		ChunkedData data;
 
 		// The serialized data matches the data stored here.
-		bool 		matches(const std::string& rhs) { return this->size == rhs.size() && memcmp(this->data, rhs.data(), this->size) == 0; }
+		bool 		matches(const ChunkedData& rhs) { return this->data == rhs; }
 
 		// The timestamp matches the timestamp serialized in the data stored here.
-		bool 		matches_timestamp(uint64_t timestamp) { assert(timestamp > 0);  assert(this->size > 8); return memcmp(this->data, &timestamp, 8) == 0; }
+		bool 		matches_timestamp(uint64_t timestamp) { assert(timestamp > 0);  assert(this->data.size() > 8); return this->header == timestamp; }
 	};
 
 	Interval    m_interval;
 	Data	   *m_data;
 
 public:
-	MutableHistoryInterval(const Interval &interval, const std::string &input_data) : m_interval(interval), m_data(nullptr) {
-		m_data = (Data*)new char[offsetof(Data, data) + input_data.size()];
-		m_data->refcnt = 1;
-		m_data->size = input_data.size();
-		memcpy(m_data->data, input_data.data(), input_data.size());
-	}
+	MutableHistoryInterval(const Interval &interval, ChunkedData &&input_data, uint64_t header) : m_interval(interval), m_data(new Data{ 1, header, std::move(input_data) }) {}
 
 	MutableHistoryInterval(const Interval &interval, MutableHistoryInterval &other) : m_interval(interval), m_data(other.m_data) {
 		++ m_data->refcnt;
@@ -377,7 +550,7 @@ public:
 
 	~MutableHistoryInterval() {
 		if (m_data != nullptr && -- m_data->refcnt == 0)
-			delete[] (char*)m_data;
+			delete m_data;
 	}
 
 	const Interval& interval() const { return m_interval; }
@@ -391,17 +564,18 @@ public:
 	bool		operator<(const MutableHistoryInterval& rhs) const { return m_interval < rhs.m_interval; }
 	bool 		operator==(const MutableHistoryInterval& rhs) const { return m_interval == rhs.m_interval; }
 
-	const char* data() const { return m_data->data; }
-	size_t  	size() const { return m_data->size; }
+	const ChunkedData& data() const { return m_data->data; }
+	size_t  	size() const { return m_data->data.size(); }
 	size_t		refcnt() const { return m_data->refcnt; }
-	bool		matches(const std::string& data) { return m_data->matches(data); }
+	bool		matches(const ChunkedData& data) { return m_data->matches(data); }
 	bool		matches_timestamp(uint64_t timestamp) { return m_data->matches_timestamp(timestamp); }
 	size_t 		memsize() const {
+		size_t memsize = sizeof(Data) + m_data->data.memsize();
 		return m_data->refcnt == 1 ?
 			// Count just the size of the snapshot data.
-			m_data->size :
+			memsize :
 			// Count the size of the snapshot data divided by the number of references, rounded up.
-			(m_data->size + m_data->refcnt - 1) / m_data->refcnt;
+			(memsize + m_data->refcnt - 1) / m_data->refcnt;
 	}
 
 private:
@@ -456,15 +630,19 @@ public:
 		return false;
 	}
 
-	void save(size_t active_snapshot_time, size_t current_time, const std::string &data) {
+	void save(size_t active_snapshot_time, size_t current_time, ChunkStore &store, const std::string &serialized) {
 		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time);
+		// Chunks of the data, shared with the previous snapshots where the data did not change.
+		ChunkedData data(store, serialized);
+		uint64_t    header = 0;
+		memcpy(&header, serialized.data(), std::min(serialized.size(), sizeof(header)));
 		if (m_history.empty() || m_history.back().end() < active_snapshot_time) {
 			if (! m_history.empty() && m_history.back().matches(data))
 				// Share the previous data by reference counting.
 				m_history.emplace_back(Interval(current_time, current_time + 1), m_history.back());
 			else
 				// Allocate new data.
-				m_history.emplace_back(Interval(current_time, current_time + 1), data);
+				m_history.emplace_back(Interval(current_time, current_time + 1), std::move(data), header);
 		} else {
 			assert(! m_history.empty());
 			assert(m_history.back().end() == active_snapshot_time);
@@ -473,7 +651,7 @@ public:
 				m_history.back().extend_end(current_time + 1);
 			else
 				// Allocate new data time continuous with the previous data.
-				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data);
+				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), std::move(data), header);
 		}
 	}
 
@@ -485,7 +663,7 @@ public:
 			-- it;
 		}
 		assert(timestamp >= it->begin() && timestamp < it->end());
-		return std::string(it->data(), it->data() + it->size());
+		return it->data().data();
 	}
 
 	// Currently all mutable snapshots are mandatory.
@@ -497,7 +675,7 @@ public:
 	std::string format() override {
 		std::string out = typeid(T).name();
 		for (const MutableHistoryInterval &interval : m_history)
-			out += std::string(", ptr:") + ptr_to_string(interval.data()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
+			out += std::string(", ptr:") + ptr_to_string(&interval.data()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
 		return out;
 	}
 #endif /* SLIC3R_UNDOREDO_DEBUG */
@@ -527,17 +705,14 @@ bool MutableObjectHistory<T>::valid()
 {
 	// Verify that the history intervals are sorted and do not overlap, and that the data reference counters are correct.
 	if (! m_history.empty()) {
-		std::map<const char*, size_t> refcntrs;
-		assert(m_history.front().data() != nullptr);
-		++ refcntrs[m_history.front().data()];
+		std::map<const ChunkedData*, size_t> refcntrs;
+		++ refcntrs[&m_history.front().data()];
 		for (size_t i = 1; i < m_history.size(); ++ i) {
 			assert(m_history[i - 1].interval().strictly_before(m_history[i].interval()));
-			++ refcntrs[m_history[i].data()];
-		}
-		for (const auto &hi : m_history) {
-			assert(hi.data() != nullptr);
-			assert(refcntrs[hi.data()] == hi.refcnt());
+			++ refcntrs[&m_history[i].data()];
 		}
+		for (const auto &hi : m_history)
+			assert(refcntrs[&hi.data()] == hi.refcnt());
 	}
 	return true;
 }
@@ -606,6 +781,8 @@ public:
 
 	const Selection& 				selection_deserialized() const { return m_selection; }
 
+	ChunkStore& 					chunk_store() { return m_chunk_store; }
+
 //protected:
 	template<typename T> ObjectID save_mutable_object(const T &object);
 	template<typename T> ObjectID save_immutable_object(std::shared_ptr<const T> &object, bool optional);
@@ -673,6 +850,8 @@ private:
 	// Maximum memory allowed to be occupied by the Undo / Redo stack. If the limit is exceeded,
 	// least recently used snapshots will be released.
 	size_t 													m_memory_limit;
+	// Chunks of the serialized data of all the objects. Declared before m_objects, so that it is destroyed after them.
+	ChunkStore 												m_chunk_store;
 	// Each individual object (Model, ModelObject, ModelInstance, ModelVolume, Selection, TriangleMesh)
 	// is stored with its own history, referenced by the ObjectID. Immutable objects do not provide
 	// their own IDs, therefore there are temporary IDs generated for them and stored to m_shared_ptr_to_object_id.
@@ -803,7 +982,7 @@ template<typename T> std::shared_ptr<const T>& 	ImmutableObjectHistory<T>::share
 {
 	if (m_shared_object.get() == nullptr && ! m_serialized.empty()) {
 		// Deserialize the object.
-		std::istringstream iss(m_serialized);
+		std::istringstream iss(m_serialized.data());
 		{
 			Slic3r::UndoRedo::InputArchive archive(stack, iss);
 			typedef typename std::remove_const<T>::type Type;
@@ -811,10 +990,29 @@ template<typename T> std::shared_ptr<const T>& 	ImmutableObjectHistory<T>::share
 			archive(*mesh.get());
 			m_shared_object = std::move(mesh);
 		}
+		// The object is shared with the scene again, it will be packed again once it is not.
+		m_serialized.clear();
 	}
 	return m_shared_object;
 }
 
+template<typename T> size_t ImmutableObjectHistory<T>::pack_unshared(StackImpl &stack)
+{
+	// Optional objects are rather released by release_optional().
+	if (m_optional || m_shared_object.use_count() != 1)
+		return 0;
+	std::ostringstream oss;
+	{
+		Slic3r::UndoRedo::OutputArchive archive(stack, oss);
+		archive(*m_shared_object);
+	}
+	size_t mem_unpacked = m_shared_object->memsize();
+	m_serialized = ChunkedData(stack.chunk_store(), oss.str());
+	m_shared_object.reset();
+	size_t mem_packed = m_serialized.memsize();
+	return mem_unpacked > mem_packed ? mem_unpacked - mem_packed : 0;
+}
+
 template<typename T> ObjectID StackImpl::save_mutable_object(const T &object)
 {
 	// First find or allocate a history stack for the ObjectID of this object instance.
@@ -837,7 +1035,7 @@ template<typename T> ObjectID StackImpl::save_mutable_object(const T &object)
 			Slic3r::UndoRedo::OutputArchive archive(*this, oss);
 			archive(object);
 		}
-		object_history->save(m_active_snapshot_time, m_current_time, oss.str());
+		object_history->save(m_active_snapshot_time, m_current_time, m_chunk_store, oss.str());
 	}
 	return object.id();
 }
@@ -874,7 +1072,12 @@ template<typename T> std::shared_ptr<const T> StackImpl::load_immutable_object(c
 	auto *object_history = static_cast<ImmutableObjectHistory<T>*>(it_object_history->second.get());
 	assert(object_history->has_snapshot(m_active_snapshot_time));
 	object_history->restore_optional();
-	return object_history->shared_ptr(*this);
+	bool packed = object_history->is_serialized();
+	std::shared_ptr<const T> &ptr = object_history->shared_ptr(*this);
+	if (packed && ptr)
+		// The object was unpacked into a new instance, map its pointer to the original ObjectID.
+		m_shared_ptr_to_object_id[(const void*)ptr.get()] = id;
+	return ptr;
 }
 
 template<typename T> void StackImpl::load_mutable_object(const Slic3r::ObjectID id, T &target)
@@ -1119,7 +1322,17 @@ void StackImpl::release_least_recently_used()
 #ifdef SLIC3R_UNDOREDO_DEBUG
 	bool released = false;
 #endif
-	// First try to release the optional immutable data (for example the convex hulls),
+	// First pack the immutable objects (triangle meshes), which are referenced by the Undo / Redo stack only,
+	// into the deflated chunks. That does not lose any history.
+	for (auto it = m_objects.begin(); current_memsize > m_memory_limit && it != m_objects.end(); ++ it) {
+		const void *ptr = it->second->immutable_object_ptr();
+		size_t mem_released = it->second->pack_unshared(*this);
+		if (ptr != nullptr && it->second->immutable_object_ptr() == nullptr)
+			// The object was released, its pointer may be reused by another object.
+			m_shared_ptr_to_object_id.erase(ptr);
+		current_memsize -= std::min(current_memsize, mem_released);
+	}
+	// Then try to release the optional immutable data (for example the convex hulls),
 	// or the shared vertices of triangle meshes.
 	for (auto it = m_objects.begin(); current_memsize > m_memory_limit && it != m_objects.end();) {
 		const void *ptr = it->second->immutable_object_ptr();
@@ -10,9 +10,12 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
+#include <cstring>
 #include <cassert>
 #include <utility>
 #include <cinttypes>
@@ -103,6 +106,67 @@ struct Selection : public Slic3r::ObjectBase {
 	template<class Archive> void serialize(Archive &ar) { ar(mode, volumes_and_instances); }
 };
 
+// The serialized snapshot data are split into content defined chunks, which are shared by all the snapshots
+// of all the objects on the Undo / Redo stack and which are stored deflated. A small change of a big object
+// (for example painting a few triangles of a big mesh) then costs just the few chunks it touched,
+// as the chunk boundaries are given by the data around them and they do not shift with the data inserted
+// or removed before them.
+class ChunkStore
+{
+public:
+	// MD5 of the chunk data. With 128 bits, two different chunks of the stack practically never get the same digest.
+	using Digest = std::array<unsigned char, 16>;
+
+	struct Chunk
+	{
+		// Reference counter of this chunk. Not thread safe for the same reason as MutableHistoryInterval::Data::refcnt.
+		size_t 				refcnt { 0 };
+		// Digest of the data before deflating, identifies the chunk in the ChunkStore.
+		Digest 				digest {};
+		// Size of the data before deflating.
+		size_t 				size { 0 };
+		bool 				deflated { false };
+		std::vector<char> 	data;
+
+		size_t 				memsize() const { return sizeof(Chunk) + data.capacity(); }
+	};
+
+	ChunkStore() = default;
+	ChunkStore(const ChunkStore &) = delete;
+	ChunkStore& operator=(const ChunkStore &) = delete;
+	~ChunkStore() { assert(m_chunks.empty()); }
+
+	// Split the data into chunks, reusing the chunks already stored. The chunks returned are referenced.
+	std::vector<Chunk*> 	store(const std::string &data);
+	// Release a reference to the chunk, the chunk is deleted with its last reference.
+	void 					release(Chunk *chunk);
+	// Append the content of the chunk to out.
+	static void 			read(const Chunk &chunk, std::string &out);
+
+	// Number of the distinct chunks stored.
+	size_t 					num_chunks() const { return m_chunks.size(); }
+
+	// Chunks shorter than that are only produced at the end of the data.
+	static constexpr size_t min_chunk_size = 2048;
+	static constexpr size_t max_chunk_size = 65536;
+
+private:
+	static Digest 			digest(const char *data, size_t size);
+	Chunk* 					acquire(const char *data, size_t size);
+
+	// The chunk ends where the top bits of the rolling hash are all zero, on average after 8kB.
+	static constexpr uint64_t boundary_mask = ~uint64_t(0) << (64 - 13);
+	// Deflate with the fastest level, the chunks are compressed whenever a snapshot is taken.
+	static constexpr int 	deflate_level = 1;
+
+	struct DigestHash {
+		// The digest is uniformly distributed, its first bytes make a good hash.
+		size_t operator()(const Digest &digest) const { size_t out; memcpy(&out, digest.data(), sizeof(out)); return out; }
+	};
+	std::unordered_map<Digest, std::unique_ptr<Chunk>, DigestHash> m_chunks;
+};
+
+
 class StackImpl;
 
 class Stack
@@ -3,8 +3,10 @@
 #include <catch2/matchers/catch_matchers.hpp>
 #include <catch2/catch_approx.hpp>
 #include "test_utils.hpp"
+#include <atomic>
 
 #include <libslic3r/Execution/ExecutionSeq.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
 
 #include <arrange/ArrangeBase.hpp>
 #include <arrange/ArrangeFirstFit.hpp>
@@ -464,6 +466,54 @@ TEST_CASE("NFP should be empty if item cannot fit into bed", "[arrange2]") {
     }
 }
 
+TEST_CASE("NFP of copies of the same parts follows the fixed copies", "[arrange2]") {
+    using namespace Slic3r;
+
+    auto parts = prusa_parts_ex();
+    REQUIRE(parts.size() >= 2);
+
+    ArrangeItem orbiter = parts[0];
+    orbiter.rotation(PI / 3.);
+    arr2::translate(orbiter, Vec2crd{scaled(20.), scaled(-40.)});
+
+    ArrangeItem fixed1 = parts[1];
+    ArrangeItem fixed2 = parts[1];
+    Vec2crd d{scaled(150.), scaled(70.)};
+    arr2::translate(fixed2, d);
+
+    std::array<std::reference_wrapper<const ArrangeItem>, 1> first  = {{fixed1}};
+    std::array<std::reference_wrapper<const ArrangeItem>, 1> second = {{fixed2}};
+    std::array<std::reference_wrapper<const ArrangeItem>, 2> both   = {{fixed1, fixed2}};
+
+    Polygons nfp1 = arr2::calculate_nfp_unnormalized(orbiter, crange(first));
+    Polygons nfp2 = arr2::calculate_nfp_unnormalized(orbiter, crange(second));
+    Polygons nfp_both = arr2::calculate_nfp_unnormalized(orbiter, crange(both));
+
+    REQUIRE(!nfp1.empty());
+
+    // The second copy is served from the cache and has to be shifted
+    // along with the fixed item.
+    Polygons nfp1_moved = nfp1;
+    for (Polygon &p : nfp1_moved)
+        p.translate(d);
+
+    Polygons nfp_sum = nfp1;
+    append(nfp_sum, nfp2);
+
+    REQUIRE(area(xor_ex(union_ex(nfp1_moved), union_ex(nfp2))) == Approx(0.));
+    REQUIRE(area(xor_ex(union_ex(nfp_sum), union_ex(nfp_both))) == Approx(0.));
+
+    // The fixed items processed in parallel give the same result.
+    Polygons nfp_both_tbb = arr2::calculate_nfp_unnormalized(orbiter, crange(both), arr2::DefaultStopCondition{}, ex_tbb);
+    REQUIRE(area(xor_ex(union_ex(nfp_both), union_ex(nfp_both_tbb))) == Approx(0.));
+
+    // Stopped while the fixed items are processed.
+    std::atomic<int> calls = 0;
+    Polygons nfp_stopped = arr2::calculate_nfp_unnormalized(orbiter, crange(both),
+                                                            [&calls] { return ++calls > 1; });
+    REQUIRE(nfp_stopped.empty());
+}
+
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem.hpp>
 
@@ -10,6 +10,7 @@
 #include <fstream>
 
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/ConflictChecker.hpp"
 #include "libslic3r/Geometry/ConvexHull.hpp"
 #include "test_data.hpp"
 
@@ -345,3 +346,28 @@ TEST_CASE("M201 for acceleation reset", "[GCode]") {
     INFO("M204 is not generated for repetier firmware");
     CHECK(!has_m204);
 }
+
+TEST_CASE("Conflict checker finds crossing lines of different instances", "[GCode][ConflictChecker]") {
+    const Line horizontal{Point::new_scale(0., 5.), Point::new_scale(10., 5.)};
+    const Line vertical{Point::new_scale(5., 0.), Point::new_scale(5., 10.)};
+    const Line far_away{Point::new_scale(50., 0.), Point::new_scale(50., 10.)};
+
+    SECTION("Crossing lines of two objects conflict") {
+        const LineWithIDs lines{{horizontal, 0, 0, ExtrusionRole::Perimeter}, {vertical, 1, 0, ExtrusionRole::Perimeter}};
+        const ConflictComputeOpt result = ConflictChecker::find_inter_of_lines(lines);
+        REQUIRE(result.has_value());
+        CHECK(((result->_obj1 == 0 && result->_obj2 == 1) || (result->_obj1 == 1 && result->_obj2 == 0)));
+    }
+    SECTION("Crossing lines of two instances of the same object conflict") {
+        const LineWithIDs lines{{horizontal, 0, 0, ExtrusionRole::Perimeter}, {vertical, 0, 1, ExtrusionRole::Perimeter}};
+        CHECK(ConflictChecker::find_inter_of_lines(lines).has_value());
+    }
+    SECTION("Crossing lines of a single instance do not conflict") {
+        const LineWithIDs lines{{horizontal, 0, 0, ExtrusionRole::Perimeter}, {vertical, 0, 0, ExtrusionRole::Perimeter}};
+        CHECK(! ConflictChecker::find_inter_of_lines(lines).has_value());
+    }
+    SECTION("Distant objects do not conflict") {
+        const LineWithIDs lines{{horizontal, 0, 0, ExtrusionRole::Perimeter}, {vertical, 0, 0, ExtrusionRole::Perimeter}, {far_away, 1, 0, ExtrusionRole::Perimeter}};
+        CHECK(! ConflictChecker::find_inter_of_lines(lines).has_value());
+    }
+}
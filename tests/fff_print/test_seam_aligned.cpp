@@ -164,3 +164,19 @@ TEST_CASE_METHOD(Test::SeamsFixture, "Calculate visibility", "[Seams][SeamAligne
         }
     }
 }
+
+TEST_CASE_METHOD(Test::SeamsFixture, "Visibility cache reuses samples", "[Seams][SeamAligned][Integration]") {
+    ModelInfo::VisibilityCache cache;
+    const std::shared_ptr<const ModelInfo::Visibility> first{
+        cache.get(transformation, volumes, params.visibility, [](){})};
+    const std::shared_ptr<const ModelInfo::Visibility> second{
+        cache.get(transformation, volumes, params.visibility, [](){})};
+    CHECK(first == second);
+
+    Transform3d moved{transformation};
+    moved.pretranslate(Vec3d{1.0, 0.0, 0.0});
+    const std::shared_ptr<const ModelInfo::Visibility> third{
+        cache.get(moved, volumes, params.visibility, [](){})};
+    CHECK(third != first);
+    CHECK(third->mesh_samples_visibility.size() == first->mesh_samples_visibility.size());
+}
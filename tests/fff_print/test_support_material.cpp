@@ -1,12 +1,16 @@
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 
+#include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/SupportSpotsGenerator.hpp"
 
 #include "test_data.hpp" // get access to init_print, etc
 
 using namespace Slic3r::Test;
 using namespace Slic3r;
+using namespace Catch;
 
 TEST_CASE("SupportMaterial: Three raft layers created", "[SupportMaterial]")
 {
@@ -237,6 +241,94 @@ SCENARIO("SupportMaterial: Checking bridge speed", "[SupportMaterial]")
 
 #endif
 
+TEST_CASE("SupportMaterial: support spots search resumes from the first changed layer", "[SupportMaterial]")
+{
+    // A 5x5x20mm stem carrying a 30x30x2mm plate. The overhanging plate needs support spots.
+    TriangleMesh mesh = make_cube(5., 5., 20.);
+    TriangleMesh plate = make_cube(30., 30., 2.);
+    plate.translate(-12.5f, -12.5f, 20.f);
+    mesh.merge(plate);
+
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config_with({
+        { "layer_height",       0.2 },
+        { "first_layer_height", 0.2 },
+        { "top_solid_layers",   3 }
+    });
+    Print print;
+    Model model;
+    Test::init_print({ mesh }, print, model, config);
+    print.process();
+
+    // 110 layers, only the topmost ones of the plate are filled differently, the stem and the bottom of the plate are kept.
+    config.set_deserialize_strict({{ "top_solid_layers", 6 }});
+    print.apply(model, config);
+    print.process();
+    const PrintObject *object = print.objects().front();
+    CHECK(SupportSpotsGenerator::resumed_layer_idx(object->support_spots_cache()) == 64);
+
+    Print expected_print;
+    Model expected_model;
+    Test::init_print({ mesh }, expected_print, expected_model, config);
+    expected_print.process();
+
+    const auto &resumed  = *object->shared_regions()->generated_support_points;
+    const auto &expected = *expected_print.objects().front()->shared_regions()->generated_support_points;
+    // The plate is above the resumed layer, thus its support spots are searched again on the warm run.
+    REQUIRE(! expected.support_points.empty());
+    REQUIRE(resumed.support_points.size() == expected.support_points.size());
+    for (size_t i = 0; i < expected.support_points.size(); ++ i) {
+        CHECK(resumed.support_points[i].position == expected.support_points[i].position);
+        CHECK(resumed.support_points[i].cause == expected.support_points[i].cause);
+    }
+    REQUIRE(resumed.partial_objects.size() == expected.partial_objects.size());
+    for (size_t i = 0; i < expected.partial_objects.size(); ++ i) {
+        CHECK(resumed.partial_objects[i].volume == Approx(expected.partial_objects[i].volume));
+        CHECK(resumed.partial_objects[i].centroid.isApprox(expected.partial_objects[i].centroid));
+    }
+}
+
+
+TEST_CASE("SupportMaterial: organic supports avoid the object and are reproducible", "[SupportMaterial]")
+{
+    // Box h = 20mm, hole bottom at 5mm, hole height 10mm. The top of the hole needs support.
+    TriangleMesh mesh = Slic3r::Test::mesh(Slic3r::Test::TestMesh::cube_with_hole);
+    mesh.rotate_x(float(M_PI / 2));
+    auto process = [&mesh](Print &print) {
+        Slic3r::Test::init_and_process_print({ mesh }, print, {
+            { "support_material",       1 },
+            { "support_material_style", "organic" },
+            { "layer_height",           0.2 },
+            { "first_layer_height",     0.2 },
+        });
+    };
+    Print print;
+    process(print);
+    const PrintObject &object = *print.objects().front();
+    SpanOfConstPtrs<SupportLayer> support_layers = object.support_layers();
+    REQUIRE(! support_layers.empty());
+
+    // Branches are moved out of the object by organic_smooth_branches_avoid_collisions() and clipped by the collision areas.
+    double support_area = 0.;
+    double overlap_area = 0.;
+    for (const SupportLayer *support_layer : support_layers) {
+        support_area += area(support_layer->support_islands);
+        for (const Layer *layer : object.layers())
+            if (std::abs(layer->print_z - support_layer->print_z) < EPSILON)
+                overlap_area += area(intersection_ex(support_layer->support_islands, layer->lslices));
+    }
+    REQUIRE(support_area > 0.);
+    CHECK(overlap_area < 0.01 * support_area);
+
+    // The branches are smoothed, clipped and merged in parallel, the result does not depend on the scheduling.
+    Print print2;
+    process(print2);
+    SpanOfConstPtrs<SupportLayer> support_layers2 = print2.objects().front()->support_layers();
+    REQUIRE(support_layers2.size() == support_layers.size());
+    for (size_t i = 0; i < support_layers.size(); ++ i) {
+        CHECK(support_layers2[i]->print_z == Approx(support_layers[i]->print_z));
+        CHECK(area(support_layers2[i]->support_islands) == Approx(area(support_layers[i]->support_islands)));
+    }
+}
 
 /* 
 
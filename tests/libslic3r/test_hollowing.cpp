@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 
 #include "libslic3r/SLA/Hollowing.hpp"
 
@@ -19,3 +20,24 @@ TEST_CASE("Hollow two overlapping spheres") {
     sphere1.WriteOBJFile("twospheres.obj");
 }
 
+
+TEST_CASE("Interior of a tall model is computed in slabs") {
+    using namespace Slic3r;
+
+    // Tall enough to be split into several Z slabs.
+    TriangleMesh box = make_cube(20., 20., 100.);
+
+    sla::HollowingConfig hcfg;
+    sla::InteriorPtr interior = sla::generate_interior(box.its, hcfg);
+    REQUIRE(interior);
+
+    const indexed_triangle_set &its = sla::get_mesh(*interior);
+    REQUIRE(!its.empty());
+
+    // The slabs are merged before meshing, the interior has to be one piece
+    // without caps at the slab boundaries.
+    REQUIRE(its_split(its).size() == 1);
+
+    double w = 20. - 2 * hcfg.min_thickness, h = 100. - 2 * hcfg.min_thickness;
+    REQUIRE(std::abs(its_volume(its)) == Catch::Approx(w * w * h).epsilon(0.05));
+}
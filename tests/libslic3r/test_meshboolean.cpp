@@ -4,6 +4,7 @@
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/MeshBoolean.hpp>
+#include <libslic3r/CSGMesh/PerformCSGMeshBooleans.hpp>
 
 using namespace Slic3r;
 using namespace Catch;
@@ -51,3 +52,58 @@ TEST_CASE("Add TriangleMeshes", "[MeshBoolean]")
     //its_write_obj(tm1.its, "test_add.obj");
     CHECK(tm1.its.indices.size() > init_size);
 }
+
+TEST_CASE("CSG parts with disjoint bounding boxes", "[MeshBoolean]")
+{
+    indexed_triangle_set cube  = its_make_cube(10., 10., 10.);
+    indexed_triangle_set drill = its_make_cube(2., 2., 20.);
+
+    auto moved = [](const Vec3f &v) {
+        Transform3f tr = Transform3f::Identity();
+        tr.translate(v);
+        return tr;
+    };
+
+    std::vector<csg::CSGPart> parts;
+    parts.emplace_back(&cube, csg::CSGType::Union);
+    parts.emplace_back(&cube, csg::CSGType::Union, moved({20.f, 0.f, 0.f}));
+    parts.emplace_back(&cube, csg::CSGType::Union, moved({40.f, 0.f, 0.f}));
+    parts.emplace_back(&drill, csg::CSGType::Difference, moved({4.f, 4.f, -5.f}));
+    parts.emplace_back(&drill, csg::CSGType::Difference, moved({100.f, 4.f, -5.f}));
+
+    auto cgalmesh = csg::perform_csgmesh_booleans(range(parts));
+    REQUIRE(cgalmesh);
+
+    indexed_triangle_set its = MeshBoolean::cgal::cgal_to_indexed_triangle_set(*cgalmesh);
+    CHECK(its_volume(its) == Approx(3 * 1000. - 40.));
+    CHECK(its_num_open_edges(its) == 0);
+}
+
+TEST_CASE("CSG part pushing a difference frame", "[MeshBoolean]")
+{
+    indexed_triangle_set cube  = its_make_cube(10., 10., 10.);
+    indexed_triangle_set drill = its_make_cube(2., 2., 20.);
+
+    auto moved = [](const Vec3f &v) {
+        Transform3f tr = Transform3f::Identity();
+        tr.translate(v);
+        return tr;
+    };
+
+    // The part opening the frame is the first member of the frame, it is
+    // united with the rest of the frame. The operation of the part is applied
+    // to the frame's result when the frame is popped.
+    std::vector<csg::CSGPart> parts;
+    parts.emplace_back(&cube, csg::CSGType::Union);
+    parts.emplace_back(&drill, csg::CSGType::Difference, moved({2.f, 2.f, -5.f}));
+    parts.back().stack_operation = csg::CSGStackOp::Push;
+    parts.emplace_back(&drill, csg::CSGType::Union, moved({6.f, 6.f, -5.f}));
+    parts.back().stack_operation = csg::CSGStackOp::Pop;
+
+    auto cgalmesh = csg::perform_csgmesh_booleans(range(parts));
+    REQUIRE(cgalmesh);
+
+    indexed_triangle_set its = MeshBoolean::cgal::cgal_to_indexed_triangle_set(*cgalmesh);
+    CHECK(its_volume(its) == Approx(1000. - 2 * 40.));
+    CHECK(its_num_open_edges(its) == 0);
+}
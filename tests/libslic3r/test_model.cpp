@@ -0,0 +1,62 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/ModelProcessing.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+
+using namespace Slic3r;
+
+TEST_CASE("Volumes with equal meshes share a single mesh", "[Model]") {
+    Model model;
+    ModelObject *object = model.add_object();
+    ModelVolume *v1 = object->add_volume(make_cube(10., 10., 10.));
+    ModelVolume *v2 = object->add_volume(make_cube(10., 10., 10.));
+    REQUIRE(&v1->mesh() != &v2->mesh());
+
+    REQUIRE(ModelProcessing::share_identical_meshes(model) == 1);
+    REQUIRE(&v1->mesh() == &v2->mesh());
+    // Sharing again changes nothing.
+    REQUIRE(ModelProcessing::share_identical_meshes(model) == 0);
+
+    const indexed_triangle_set its = v2->mesh().its;
+
+    SECTION("Scaling one of the volumes leaves the other one untouched") {
+        v1->scale_geometry_after_creation(2.f);
+        REQUIRE(&v1->mesh() != &v2->mesh());
+        REQUIRE(v1->mesh().its.vertices != its.vertices);
+        REQUIRE(v2->mesh().its.vertices == its.vertices);
+        REQUIRE(v2->get_convex_hull().bounding_box().size().isApprox(Vec3d(10., 10., 10.)));
+    }
+
+    SECTION("Centering one of the volumes leaves the other one untouched") {
+        // Shift the shared mesh off the origin, so that centering moves it.
+        TriangleMesh shifted = v1->mesh();
+        shifted.translate(5.f, 5.f, 5.f);
+        v1->set_mesh(std::move(shifted));
+        std::shared_ptr<const TriangleMesh> shared = v1->get_mesh_shared_ptr();
+        v2->set_mesh(shared);
+        REQUIRE(&v1->mesh() == &v2->mesh());
+
+        v1->center_geometry_after_creation();
+        REQUIRE(&v1->mesh() != &v2->mesh());
+        REQUIRE(v1->mesh().bounding_box().center().isApprox(Vec3d::Zero()));
+        REQUIRE(v2->mesh().bounding_box().center().isApprox(Vec3d(5., 5., 5.)));
+    }
+}
+
+TEST_CASE("Volumes with different repair statistics keep their meshes", "[Model]") {
+    Model model;
+    ModelObject *object = model.add_object();
+
+    RepairedMeshErrors repaired;
+    repaired.facets_reversed = 2;
+
+    ModelVolume *v1 = object->add_volume(make_cube(10., 10., 10.));
+    ModelVolume *v2 = object->add_volume(TriangleMesh(its_make_cube(10., 10., 10.), repaired));
+    REQUIRE(v1->mesh().its.vertices == v2->mesh().its.vertices);
+    REQUIRE(v1->mesh().its.indices == v2->mesh().its.indices);
+
+    REQUIRE(ModelProcessing::share_identical_meshes(model) == 0);
+    REQUIRE(&v1->mesh() != &v2->mesh());
+    REQUIRE(v2->mesh().stats().repaired_errors.facets_reversed == 2);
+}
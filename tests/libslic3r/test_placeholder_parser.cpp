@@ -47,6 +47,24 @@ SCENARIO("Placeholder parser scripting", "[PlaceholderParser]") {
     SECTION("multiple expressions with semicolons 3") { REQUIRE(parser.process("{temperature[foo];;;temperature[foo];;}") == "357357"); }
 
     SECTION("parsing string with escaped characters") { REQUIRE(parser.process("{\"hu\\nha\\\\\\\"ha\\\"\"}") == "hu\nha\\\"ha\""); }
+    SECTION("text and legacy variables between macro blocks") {
+        std::string long_text(300, ';');
+        REQUIRE(parser.process("G1 [temperature_[foo]] {foo + 1}\n; [bar] {bar}" + long_text + "{\"}\" + \"/\"} [ bar ]\n") == "G1 357 1\n; 2 2" + long_text + "}/ 2\n");
+    }
+    SECTION("repeated evaluation of a template") {
+        std::string templ = ";[temperature]\n{if foo == 0}zero [bar]{else}nonzero{endif}\n";
+        REQUIRE(parser.process(templ) == ";357\nzero 2\n");
+        REQUIRE(parser.process(templ) == ";357\nzero 2\n");
+    }
+    SECTION("error line is counted from the start of the template") {
+        std::string message;
+        try {
+            parser.process("line 1\n[bar]\n{if foo == 0}{1 + }{endif}");
+        } catch (const std::exception &ex) {
+            message = ex.what();
+        }
+        REQUIRE(message.rfind("Parsing error at line 3", 0) == 0);
+    }
 
     WHEN("An UTF-8 character is used inside the code block") {
         THEN("A std::runtime_error exception is thrown.") {
@@ -56,3 +56,28 @@ TEST_CASE("PNG read", "[PNG]") {
         REQUIRE(sum == rstsum);
     }
 }
+
+TEST_CASE("PNG write in strips", "[PNG]") {
+    // Big enough to be deflated in several independent strips.
+    auto rst = create_raster({1200, 1000});
+    for (double v : {100., 300., 500.}) {
+        ExPolygon poly{{scaled(v), scaled(v)}, {scaled(2 * v), scaled(v / 2)}, {scaled(v), scaled(2 * v)}};
+        rst.draw(poly);
+    }
+
+    for (int level : {0, 1, 6, 9}) {
+        auto enc_rst = rst.encode(sla::PNGRasterEncoder{level});
+
+        png::ImageGreyscale img;
+        REQUIRE(png::decode_png({enc_rst.data(), enc_rst.size()}, img));
+        REQUIRE(img.rows == rst.resolution().height_px);
+        REQUIRE(img.cols == rst.resolution().width_px);
+
+        bool equal = true;
+        for (size_t r = 0; r < img.rows && equal; ++r)
+            for (size_t c = 0; c < img.cols && equal; ++c)
+                equal = img.get(r, c) == rst.read_pixel(c, r);
+
+        REQUIRE(equal);
+    }
+}
@@ -302,3 +302,20 @@ TEST_CASE("Simplified cube should not be empty.", "[its]")
     its_quadric_edge_collapse(its, wanted_count, &max_error);
     CHECK(!its.indices.empty());
 }
+
+TEST_CASE("Simplify big mesh by clusters", "[its][quadric_edge_collapse]")
+{
+    // Big enough to be split into clusters simplified in parallel.
+    indexed_triangle_set its = its_make_sphere(10., PI / 300.);
+    REQUIRE(its.indices.size() >= 200000);
+    double original_volume = its_volume(its);
+
+    uint32_t wanted_count = 2000;
+    float    max_error    = std::numeric_limits<float>::max();
+    its_quadric_edge_collapse(its, wanted_count, &max_error, nullptr, nullptr, 0.f);
+
+    CHECK(its.indices.size() <= wanted_count);
+    CHECK(!Private::exist_triangle_with_twice_vertices(its.indices));
+    CHECK(its_num_open_edges(its) == 0);
+    CHECK(fabs(original_volume - its_volume(its)) < 0.02 * original_volume);
+}
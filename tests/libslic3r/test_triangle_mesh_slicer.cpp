@@ -0,0 +1,84 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "libslic3r/Geometry.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+
+using namespace Slic3r;
+
+namespace {
+
+// Points and colors of all the polygons of a layer, independent of the order of the polygons and of their starting points.
+void sorted_points_and_colors(const ColorPolygons &color_polygons, Points &points, ColorPolygon::Colors &colors)
+{
+    for (const ColorPolygon &color_polygon : color_polygons) {
+        append(points, color_polygon.points);
+        append(colors, color_polygon.colors);
+    }
+    std::sort(points.begin(), points.end(), [](const Point &a, const Point &b) { return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y()); });
+    std::sort(colors.begin(), colors.end());
+}
+
+double area(const ColorPolygons &color_polygons)
+{
+    double out = 0.;
+    for (const ColorPolygon &color_polygon : color_polygons)
+        out += color_polygon.area();
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("Slicing a colored mesh batch by batch gives the slices of the whole mesh", "[TriangleMeshSlicer]") {
+    const indexed_triangle_set sphere = its_make_sphere(10., PI / 20.);
+
+    indexed_triangle_set_with_color mesh{sphere.indices, sphere.vertices, {}};
+    for (size_t facet_idx = 0; facet_idx < mesh.indices.size(); ++ facet_idx)
+        mesh.colors.emplace_back(uint8_t(facet_idx % 3));
+
+    std::vector<float> zs;
+    for (float z = 0.05f; z < 20.f; z += 0.05f)
+        zs.emplace_back(z);
+
+    const size_t batch_size = 64;
+
+    for (const Transform3d &trafo : {Transform3d(Transform3d::Identity()),
+                                     Transform3d(Geometry::translation_transform(Vec3d(1., 2., 10.)) *
+                                                 Geometry::rotation_transform(Vec3d(0.3, 0.2, 0.1)))}) {
+        const MeshSlicingParams params{trafo};
+
+        const std::vector<ColorPolygons>    whole             = slice_mesh(mesh, zs, params);
+        const std::vector<std::vector<int>> facets_per_batch  = facets_per_slicing_batch(mesh, zs, batch_size, params);
+        REQUIRE(facets_per_batch.size() == (zs.size() + batch_size - 1) / batch_size);
+
+        for (size_t batch_idx = 0; batch_idx < facets_per_batch.size(); ++ batch_idx) {
+            const std::vector<int> &facets = facets_per_batch[batch_idx];
+            CHECK(facets.size() < mesh.indices.size());
+            CHECK(std::is_sorted(facets.begin(), facets.end()));
+
+            const size_t                     batch_begin = batch_idx * batch_size;
+            const size_t                     batch_end   = std::min(batch_begin + batch_size, zs.size());
+            const std::vector<float>         batch_zs(zs.begin() + batch_begin, zs.begin() + batch_end);
+            const std::vector<ColorPolygons> batch = slice_mesh(mesh, facets, batch_zs, params);
+            REQUIRE(batch.size() == batch_zs.size());
+
+            for (size_t layer_idx = batch_begin; layer_idx < batch_end; ++ layer_idx) {
+                const ColorPolygons &expected = whole[layer_idx];
+                const ColorPolygons &sliced   = batch[layer_idx - batch_begin];
+                CHECK(sliced.size() == expected.size());
+                CHECK_THAT(area(sliced), Catch::Matchers::WithinRel(area(expected), 1e-9));
+
+                Points               expected_points, sliced_points;
+                ColorPolygon::Colors expected_colors, sliced_colors;
+                sorted_points_and_colors(expected, expected_points, expected_colors);
+                sorted_points_and_colors(sliced, sliced_points, sliced_colors);
+                CHECK(sliced_points == expected_points);
+                CHECK(sliced_colors == expected_colors);
+            }
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleSelector.hpp"
+
+using namespace Slic3r;
+
+namespace {
+
+using Facet = std::array<Vec3f, 3>;
+
+bool vertex_less(const Vec3f &a, const Vec3f &b)
+{
+    return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3);
+}
+
+// Facets of the mesh by their vertex coordinates, independent of the order of the vertices and facets
+// in the indexed triangle set. The winding of each facet is kept.
+std::vector<Facet> sorted_facets(const indexed_triangle_set &its)
+{
+    std::vector<Facet> out;
+    out.reserve(its.indices.size());
+    for (const stl_triangle_vertex_indices &face : its.indices) {
+        Facet facet{its.vertices[face(0)], its.vertices[face(1)], its.vertices[face(2)]};
+        std::rotate(facet.begin(), std::min_element(facet.begin(), facet.end(), vertex_less), facet.end());
+        out.emplace_back(facet);
+    }
+    std::sort(out.begin(), out.end(), [](const Facet &a, const Facet &b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), vertex_less);
+    });
+    return out;
+}
+
+// Index of a facet of the unsplit mesh touching the vertex.
+int facet_at_vertex(const TriangleMesh &mesh, const Vec3f &vertex)
+{
+    for (size_t i = 0; i < mesh.its.indices.size(); ++ i)
+        for (int j = 0; j < 3; ++ j)
+            if (mesh.its.vertices[mesh.its.indices[i](j)] == vertex)
+                return int(i);
+    return -1;
+}
+
+void paint(TriangleSelector &selector, const TriangleMesh &mesh, const Vec3f &center, float radius, TriangleStateType state)
+{
+    int facet = facet_at_vertex(mesh, center);
+    REQUIRE(facet >= 0);
+    selector.select_patch(facet,
+                          std::make_unique<TriangleSelector::Sphere>(center, Vec3f(20.f, 20.f, 20.f), radius,
+                                                                     Transform3d::Identity(), TriangleSelector::ClippingPlane{}),
+                          state, Transform3d::Identity(), true);
+}
+
+constexpr size_t NumStates = 4;
+
+// Paints three states around corners of the cube, partially erases the first one and collects the garbage.
+void paint_unpaint_collect(TriangleSelector &selector, const TriangleMesh &mesh)
+{
+    paint(selector, mesh, Vec3f(0.f, 0.f, 10.f), 4.f, TriangleStateType::ENFORCER);
+    paint(selector, mesh, Vec3f(10.f, 10.f, 0.f), 4.f, TriangleStateType::BLOCKER);
+    paint(selector, mesh, Vec3f(10.f, 0.f, 10.f), 3.f, TriangleStateType::Extruder3);
+    paint(selector, mesh, Vec3f(0.f, 0.f, 10.f), 2.f, TriangleStateType::NONE);
+    selector.garbage_collect();
+}
+
+} // namespace
+
+TEST_CASE("Painted facets survive serialization after garbage collection", "[TriangleSelector]") {
+    TriangleMesh     mesh = make_cube(10., 10., 10.);
+    TriangleSelector selector(mesh);
+    paint_unpaint_collect(selector, mesh);
+
+    TriangleSelector::TriangleSplittingData data = selector.serialize();
+    REQUIRE(! data.triangles_to_split.empty());
+
+    TriangleSelector loaded(mesh);
+    loaded.deserialize(data);
+    REQUIRE(loaded.serialize() == data);
+
+    for (size_t state = 0; state < NumStates; ++ state) {
+        indexed_triangle_set facets = selector.get_facets_strict(TriangleStateType(state));
+        REQUIRE(! facets.indices.empty());
+        REQUIRE(sorted_facets(loaded.get_facets_strict(TriangleStateType(state))) == sorted_facets(facets));
+    }
+}
+
+TEST_CASE("Painted facets of all states extracted at once match the facets of each state", "[TriangleSelector]") {
+    TriangleMesh     mesh = make_cube(10., 10., 10.);
+    TriangleSelector selector(mesh);
+    paint_unpaint_collect(selector, mesh);
+
+    std::vector<indexed_triangle_set> per_state = selector.get_facets_strict_per_state(NumStates);
+    REQUIRE(per_state.size() == NumStates);
+    for (size_t state = 0; state < NumStates; ++ state) {
+        indexed_triangle_set facets = selector.get_facets_strict(TriangleStateType(state));
+        REQUIRE(per_state[state].indices.size() == facets.indices.size());
+        REQUIRE(sorted_facets(per_state[state]) == sorted_facets(facets));
+    }
+}
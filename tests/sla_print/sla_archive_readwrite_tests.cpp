@@ -69,3 +69,66 @@ TEST_CASE("Archive export test", "[sla_archives]") {
         }
     }
 }
+
+TEST_CASE("Deferred archive export matches the rasterized one", "[sla_archives]") {
+    auto registry = registered_sla_archives();
+
+    for (const ArchiveEntry &entry : registry) {
+        if (!entry.rdfactoryfn)
+            continue;
+
+        INFO(std::string("Testing archive type: ") + entry.id);
+        SLAPrint print;
+        SLAFullPrintConfig fullcfg;
+
+        auto m = FileReader::load_model(TEST_DATA_DIR PATH_SEPARATOR + std::string("20mm_cube.obj"));
+
+        fullcfg.printer_technology.setInt(ptSLA);
+        fullcfg.set("sla_archive_format", entry.id);
+        fullcfg.set("supports_enable", false);
+        fullcfg.set("pad_enable", false);
+
+        DynamicPrintConfig cfg;
+        cfg.apply(fullcfg);
+
+        print.set_status_callback([](const PrintBase::SlicingStatus&) {});
+        print.apply(m, cfg);
+        print.process();
+
+        const size_t layer_num = print.print_layers().size();
+        REQUIRE(layer_num > 0);
+
+        // Squares shrinking with the layer index, placed well inside the display.
+        auto drawfn = [](sla::RasterBase &raster, size_t idx) {
+            coord_t a = scaled(20.), b = scaled(40. - 0.02 * idx);
+            raster.draw(ExPolygon{Polygon{{a, a}, {b, a}, {b, b}, {a, b}}});
+        };
+
+        auto rasterized = SLAArchiveWriter::create(entry.id, print.printer_config());
+        auto deferred   = SLAArchiveWriter::create(entry.id, print.printer_config());
+        REQUIRE(rasterized);
+        REQUIRE(deferred);
+
+        rasterized->draw_layers(layer_num, drawfn, []() { return false; });
+        deferred->defer_layers(layer_num, drawfn);
+
+        ThumbnailsList thumbnails;
+        const auto tmpdir = boost::filesystem::temp_directory_path();
+        std::string rasterized_fname = (tmpdir / boost::filesystem::unique_path("rasterized-%%%%-%%%%." + std::string(entry.ext))).string();
+        std::string deferred_fname   = (tmpdir / boost::filesystem::unique_path("deferred-%%%%-%%%%." + std::string(entry.ext))).string();
+        rasterized->export_print(rasterized_fname, print, thumbnails, "rasterized");
+        deferred->export_print(deferred_fname, print, thumbnails, "deferred");
+
+        indexed_triangle_set its_rasterized, its_deferred;
+        DynamicPrintConfig cfg_rasterized, cfg_deferred;
+        import_sla_archive(rasterized_fname, "", its_rasterized, cfg_rasterized);
+        import_sla_archive(deferred_fname, "", its_deferred, cfg_deferred);
+        boost::filesystem::remove(rasterized_fname);
+        boost::filesystem::remove(deferred_fname);
+
+        REQUIRE(!its_deferred.empty());
+        double vol_rasterized = its_volume(its_rasterized);
+        double vol_deferred   = its_volume(its_deferred);
+        REQUIRE(std::abs(vol_rasterized - vol_deferred) <= 1e-6 * vol_rasterized);
+    }
+}
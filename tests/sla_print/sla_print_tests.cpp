@@ -7,6 +7,11 @@
 
 #include <libslic3r/TriangleMeshSlicer.hpp>
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
+#include <libslic3r/SLA/SpanRaster.hpp>
+#include <libslic3r/SLA/Rotfinder.hpp>
+#include <libslic3r/SLA/SliceStore.hpp>
+#include <libslic3r/CSGMesh/SliceCSGMesh.hpp>
+#include <libslic3r/Model.hpp>
 #include <libslic3r/BranchingTree/PointCloud.hpp>
 
 namespace {
@@ -72,6 +77,28 @@ TEST_CASE("WingedPadAroundObjectIsValid", "[SLASupportGeneration]") {
     for (auto &fname : AROUND_PAD_TEST_OBJECTS) test_pad(fname, padcfg);
 }
 
+TEST_CASE("Pad of many separate parts is deterministic", "[SLASupportGeneration]") {
+    // Footprints too far from each other to be joined into one pad part.
+    ExPolygons blueprint;
+    for (int i = 0; i < 8; ++i)
+        for (int j = 0; j < 8; ++j) {
+            Vec2d c(100. * i, 100. * j);
+            blueprint.emplace_back(Polygon::new_scale({c + Vec2d{0., 0.}, c + Vec2d{5., 0.},
+                                                       c + Vec2d{5., 5.}, c + Vec2d{0., 5.}}));
+        }
+
+    sla::PadConfig padcfg;
+    padcfg.max_merge_dist_mm = 10.;
+
+    indexed_triangle_set pad1, pad2;
+    sla::create_pad(blueprint, {}, pad1, padcfg);
+    sla::create_pad(blueprint, {}, pad2, padcfg);
+
+    REQUIRE(!pad1.empty());
+    REQUIRE(pad1.vertices == pad2.vertices);
+    REQUIRE(pad1.indices == pad2.indices);
+}
+
 TEST_CASE("DefaultSupports::ElevatedSupportGeometryIsValid", "[SLASupportGeneration]") {
     sla::SupportTreeConfig supportcfg;
     supportcfg.object_elevation_mm = 10.;
@@ -205,6 +232,42 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
     REQUIRE(raster_pxsum(raster0) == 0);
 }
 
+TEST_CASE("SpanRasterShouldMatchAGGRaster", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::Resolution res{2560, 1440};
+    sla::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+    auto to_bitmap = [](const sla::RasterBase &raster) {
+        std::vector<uint8_t> px;
+        raster.foreach_pixel_run([&px](uint8_t v, size_t len) { px.insert(px.end(), len, v); });
+        return px;
+    };
+
+    for (auto orientation : {sla::RasterBase::roLandscape, sla::RasterBase::roPortrait}) {
+        sla::RasterBase::Trafo trafo{orientation, sla::RasterBase::MirrorX};
+
+        sla::RasterGrayscaleAAGammaPower raster(res, pixdim, trafo, 1.);
+        sla::SpanRaster spans(res, pixdim, trafo, agg::gamma_power(1.));
+
+        // Two separate polygons, inside the display in both orientations.
+        for (double x : {22., 44.}) {
+            ExPolygon poly = square_with_hole(x - 12.);
+            poly.translate(scaled(x), scaled(34.));
+            raster.draw(poly);
+            spans.draw(poly);
+        }
+
+        std::vector<uint8_t> expected = to_bitmap(raster);
+        std::vector<uint8_t> px = to_bitmap(spans);
+        REQUIRE(px.size() == res.pixels());
+        REQUIRE(expected.size() == px.size());
+
+        long diff = 0;
+        for (size_t i = 0; i < px.size(); ++i)
+            diff = std::max(diff, std::abs(long(px[i]) - long(expected[i])));
+
+        REQUIRE(diff <= 1);
+    }
+}
 
 TEST_CASE("halfcone test", "[halfcone]") {
     sla::DiffBridge br{Vec3d{1., 1., 1.}, Vec3d{10., 10., 10.}, 0.25, 0.5};
@@ -225,3 +288,130 @@ TEST_CASE("Test concurrency")
 
     REQUIRE(s == Approx(ref));
 }
+
+TEST_CASE("Rotfinder finds the lowest orientation of a box", "[SLARotfinder]")
+{
+    Model model;
+    ModelObject *mo = model.add_object();
+    mo->add_instance();
+    mo->add_volume(make_cube(10., 20., 40.));
+
+    Vec2d rot = sla::find_min_z_height_rotation(*mo);
+
+    Transform3d tr = Transform3d::Identity();
+    tr.rotate(Eigen::AngleAxisd(rot.y(), Vec3d::UnitY()));
+    tr.rotate(Eigen::AngleAxisd(rot.x(), Vec3d::UnitX()));
+
+    TriangleMesh mesh = mo->raw_mesh();
+    mesh.transform(tr);
+
+    REQUIRE(mesh.bounding_box().size().z() == Approx(10.).margin(EPSILON));
+}
+
+TEST_CASE("Rotfinder respects the time budget", "[SLARotfinder]")
+{
+    Model model;
+    ModelObject *mo = model.add_object();
+    mo->add_instance();
+    mo->add_volume(TriangleMesh{its_make_sphere(10., PI / 256.)});
+
+    auto params = sla::RotOptimizeParams{}.accuracy(1.f).time_budget(std::chrono::milliseconds{50});
+
+    auto start = std::chrono::steady_clock::now();
+    Vec2d rot1 = sla::find_best_misalignment_rotation(*mo, params);
+    Vec2d rot2 = sla::find_least_supports_rotation(*mo, params);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(std::isfinite(rot1.x()));
+    REQUIRE(std::isfinite(rot1.y()));
+    REQUIRE(std::isfinite(rot2.x()));
+    REQUIRE(std::isfinite(rot2.y()));
+
+    // Generous limit, a single evaluation is well below a millisecond.
+    REQUIRE(elapsed < std::chrono::seconds{5});
+}
+
+TEST_CASE("SliceStore returns the stored slices", "[SLASliceStore]")
+{
+    TriangleMesh mesh = load_model("20mm_cube.obj");
+    mesh.merge(TriangleMesh{its_make_sphere(5., PI / 64.)});
+    std::vector<float> heights = grid(0.05f, 20.f, 0.05f);
+    std::vector<ExPolygons> slices = slice_mesh_ex(mesh.its, heights);
+
+    // Coordinates of both signs and a hole.
+    slices.front() = {ExPolygon{Polygon::new_scale({{-10., -10.}, {10., -10.}, {10., 10.}, {-10., 10.}}),
+                                Polygon::new_scale({{-1., -1.}, {-1., 1.}, {1., 1.}, {1., -1.}})}};
+
+    auto check = [&slices](const sla::SliceStore &store) {
+        REQUIRE(store.size() == slices.size());
+        for (size_t i = 0; i < slices.size(); ++i)
+            REQUIRE(store.get(i) == slices[i]);
+        REQUIRE(store.get_all() == slices);
+    };
+
+    sla::SliceStoreParams params;
+
+    SECTION("plain") {}
+    SECTION("encoded") { params.encoded = true; }
+    SECTION("compressed") { params.compressed = true; }
+    SECTION("spilled") { params.memory_limit = 1000; }
+    SECTION("compressed and spilled") { params.compressed = true; params.memory_limit = 1000; }
+
+    sla::SliceStore store;
+    store.assign(std::vector<ExPolygons>{slices}, params);
+    check(store);
+
+    if (params.memory_limit == 1000) {
+        REQUIRE(store.memory_usage() <= 1000);
+        REQUIRE(store.spilled_size() > 0);
+    }
+
+    // Changed storage parameters keep the slices.
+    sla::SliceStoreParams other_params;
+    other_params.compressed = !params.compressed;
+    store.store_again(other_params);
+    REQUIRE(store.params() == other_params);
+    REQUIRE(store.spilled_size() == 0);
+    check(store);
+
+    store.store_again(params);
+    check(store);
+}
+
+TEST_CASE("CSG parts are resolved on the slices", "[SLACSGSlicing]")
+{
+    indexed_triangle_set cube  = its_make_cube(20., 20., 20.);
+    indexed_triangle_set drill = its_make_cube(2., 2., 10.);
+
+    auto moved = [](const Vec3f &v) {
+        Transform3f tr = Transform3f::Identity();
+        tr.translate(v);
+        return tr;
+    };
+
+    // cube - drill - (drill + drill), the last two drills only span the top.
+    std::vector<csg::CSGPart> parts;
+    parts.emplace_back(&cube, csg::CSGType::Union);
+    parts.emplace_back(&drill, csg::CSGType::Difference, moved({9.f, 9.f, 5.f}));
+    parts.emplace_back(&drill, csg::CSGType::Difference, moved({2.f, 2.f, 15.f}));
+    parts.back().stack_operation = csg::CSGStackOp::Push;
+    parts.emplace_back(&drill, csg::CSGType::Union, moved({16.f, 16.f, 15.f}));
+    parts.back().stack_operation = csg::CSGStackOp::Pop;
+
+    std::vector<float> heights = {2.f, 10.f, 18.f, 30.f};
+    std::vector<ExPolygons> slices = csg::slice_csgmesh_ex(range(parts), heights, MeshSlicingParamsEx{});
+
+    REQUIRE(slices.size() == heights.size());
+
+    auto area = [](const ExPolygons &slice) {
+        double a = 0.;
+        for (const ExPolygon &expoly : slice)
+            a += expoly.area();
+        return a * SCALING_FACTOR * SCALING_FACTOR;
+    };
+
+    CHECK(area(slices[0]) == Approx(400.));
+    CHECK(area(slices[1]) == Approx(396.));
+    CHECK(area(slices[2]) == Approx(392.));
+    CHECK(slices[3].empty());
+}
@@ -9,6 +9,7 @@
 #include "libslic3r/SLA/SupportTreeSlicer.hpp"
 #include "libslic3r/SLA/SupportTreeBuilder.hpp"
 #include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
 #include "libslic3r/ClipperUtils.hpp"
 
 #include "libslic3r/SVG.hpp"
@@ -69,7 +70,7 @@ std::pair<std::vector<ExPolygons>, std::vector<float>> get_mesh_slices(const Tri
     auto bb = mesh.bounding_box();
     for (double z=bb.min.z() + top_bottom_clearance; z<bb.max.z() - top_bottom_clearance; z += bb.size().z() / 50.)
         heights.emplace_back(z);
-    std::vector<ExPolygons> mesh_slices = sla::slice(mesh.its, {}, heights, slice_closing_radius, {});
+    std::vector<ExPolygons> mesh_slices = slice_mesh_ex(mesh.its, heights, slice_closing_radius);
     return std::make_pair(std::move(mesh_slices), std::move(heights));
 }
 
@@ -170,5 +171,39 @@ TEST_CASE("Analytical slicing", "[analytical_slicing]") {
     }
 }
 
+TEST_CASE("Indexed analytical slicing matches the full scan", "[analytical_slicing]") {
+    // A small forest of all kinds of primitives spread over a tall range.
+    sla::SupportTreeBuilder builder;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(0., 1.);
+    for (unsigned i = 0; i < 30; ++i) {
+        const Vec3d pos(10. * dist(rng), 10. * dist(rng), 5. + 20. * dist(rng));
+        const Vec3d dir = Vec3d(dist(rng) - .5, dist(rng) - .5, -1.).normalized();
+        builder.add_head(i, 1., 0.3, 2., 0.2, dir, pos);
+        builder.add_pillar(Vec3d(pos.x(), pos.y(), 0.), pos.z() - 4., 0.8, 0.6);
+        builder.add_junction(pos - Vec3d(0., 0., 4.), 0.8);
+        builder.add_bridge(pos, pos + Vec3d(3. * dist(rng), 3. * dist(rng), -2.), 0.5);
+        builder.add_diffbridge(pos, pos + Vec3d(-2., 1., -3. * dist(rng)), 0.5, 0.7);
+    }
+
+    SupportTreeOutput output = builder.retrieve_output();
+
+    std::vector<float> heights;
+    for (float h = -1.f; h < 30.f; h += 0.05f)
+        heights.emplace_back(h);
+
+    std::vector<ExPolygons> full = slice_support_tree(output, heights);
+    SupportTreeSlicer slicer{std::move(output)};
+    std::vector<ExPolygons> indexed = slicer.slice(heights);
+
+    REQUIRE(full.size() == indexed.size());
+    for (size_t i = 0; i < full.size(); ++i) {
+        INFO("height " << heights[i]);
+        REQUIRE(full[i].size() == indexed[i].size());
+        for (size_t j = 0; j < full[i].size(); ++j)
+            CHECK(full[i][j] == indexed[i][j]);
+    }
+}
+
 }
 }
@@ -141,6 +141,79 @@ TEST_CASE("Two parallel plates should be supported", "[SupGen][Hollowed]")
 }
 
 
+TEST_CASE("Regenerated supports of changed object match new generation", "[SupGen]")
+{
+    // Tall base with floating plate above, only the plate is moved
+    TriangleMesh base = make_cube(20., 20., 10.);
+    TriangleMesh plate = make_cube(10., 10., 1.);
+    plate.translate(5.f, 5.f, 15.f);
+    TriangleMesh mesh = base;
+    mesh.merge(plate);
+
+    TriangleMesh changed_mesh = base;
+    plate.translate(3.f, 0.f, 0.f);
+    changed_mesh.merge(plate);
+
+    std::vector<float> heights = grid(0.05f, 16.f, 0.1f);
+    auto prepare = [&heights](const TriangleMesh &m) {
+        return sla::prepare_generator_data(slice_mesh_ex(m.its, heights, CLOSING_RADIUS), heights);
+    };
+
+    sla::SupportPointGeneratorConfig cfg;
+    sla::SupportPointGeneratorCache cache;
+    sla::SupportPointGeneratorData data = prepare(mesh);
+    sla::generate_support_points(data, cfg, cache);
+    CHECK(!cache.checkpoints.empty());
+
+    sla::SupportPointGeneratorData changed_data = prepare(changed_mesh);
+    sla::LayerSupportPoints regenerated = sla::generate_support_points(changed_data, cfg, cache);
+    sla::LayerSupportPoints expected = sla::generate_support_points(changed_data, cfg);
+
+    // Checkpoints of the unchanged base are kept
+    REQUIRE(!cache.checkpoints.empty());
+    REQUIRE(regenerated.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+        CHECK(regenerated[i].pos == expected[i].pos);
+
+    // Checkpoints store only differences, each support point is appended once
+    size_t appended_count = 0;
+    for (const sla::SupportPointGeneratorCache::Checkpoint &checkpoint : cache.checkpoints)
+        appended_count += checkpoint.appended.size();
+    CHECK(appended_count <= expected.size());
+}
+
+TEST_CASE("Same islands get the same support points", "[SupGen]")
+{
+    // Array of same elevated objects
+    TriangleMesh mesh;
+    const float offset = 15.f;
+    for (size_t i = 0; i < 3; ++i) {
+        TriangleMesh part = make_cube(10., 5., 2.);
+        part.translate(i * offset, 0.f, 1.f);
+        mesh.merge(part);
+    }
+
+    std::vector<float> heights = grid(0.05f, 4.f, 0.1f);
+    sla::SupportPointGeneratorData data = sla::prepare_generator_data(
+        slice_mesh_ex(mesh.its, heights, CLOSING_RADIUS), heights);
+    sla::LayerSupportPoints pts = sla::generate_support_points(data, sla::SupportPointGeneratorConfig{});
+
+    std::vector<sla::LayerSupportPoints> part_points(3);
+    for (const sla::LayerSupportPoint &p : pts)
+        part_points[static_cast<size_t>(p.pos.x() / offset)].push_back(p);
+
+    const sla::LayerSupportPoints &first = part_points.front();
+    REQUIRE(!first.empty());
+    for (size_t part_id = 1; part_id < part_points.size(); ++part_id) {
+        const sla::LayerSupportPoints &points = part_points[part_id];
+        REQUIRE(points.size() == first.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            Vec3f moved = first[i].pos + Vec3f::UnitX() * (part_id * offset);
+            CHECK((points[i].pos - moved).norm() < 0.01f);
+        }
+    }
+}
+
 Slic3r::Polygon create_cross_roads(double size, double width)
 {
     auto r1 = PolygonUtils::create_rect(5.3 * size, width);
@@ -3,6 +3,7 @@
 #include "libslic3r/SLA/AGGRaster.hpp"
 #include "libslic3r/SLA/DefaultSupportTree.hpp"
 #include "libslic3r/SLA/BranchingTreeSLA.hpp"
+#include "libslic3r/SLA/SupportTreeSlicer.hpp"
 
 #include <iomanip>
 
@@ -22,18 +23,20 @@ void test_support_model_collision(
 
     test_supports(obj_filename, supportcfg, hollowingcfg, drainholes, byproducts);
 
-    // Slice the support mesh given the slice grid of the model.
-    std::vector<ExPolygons> support_slices =
-        sla::slice(byproducts.suptree_builder.retrieve_mesh(sla::MeshType::Support),
-              byproducts.suptree_builder.retrieve_mesh(sla::MeshType::Pad),
-              byproducts.slicegrid, CLOSING_RADIUS, {});
-
-    // The slices originate from the same slice grid so the numbers must match
-
+    // The support mesh is cached by the builder, so it survives taking the
+    // output for the analytical slicing below.
     bool support_mesh_is_empty =
-            byproducts.suptree_builder.retrieve_mesh(sla::MeshType::Pad).empty() &&
             byproducts.suptree_builder.retrieve_mesh(sla::MeshType::Support).empty();
 
+    // Slice the support tree given the slice grid of the model, the same
+    // way as the print does.
+    std::vector<ExPolygons> support_slices;
+    if (!support_mesh_is_empty)
+        support_slices = sla::SupportTreeSlicer{byproducts.suptree_builder.retrieve_output()}
+                             .slice(byproducts.slicegrid);
+
+    // The slices originate from the same slice grid so the numbers must match
+
     if (support_mesh_is_empty)
         REQUIRE(support_slices.empty());
     else
@@ -171,6 +174,15 @@ void test_supports(const std::string          &obj_filename,
 
     check_validity(output_mesh, validityflags);
 
+    // The mesh built later from the retrieved output (as SLAPrint does for
+    // preview and export) has to be the same as the one of the builder.
+    {
+        sla::SupportTreeBuilder builder_copy{treebuilder};
+        indexed_triangle_set output_its = sla::merged_mesh(builder_copy.retrieve_output());
+        REQUIRE(output_its.indices.size() == output_mesh.its.indices.size());
+        REQUIRE(output_its.vertices.size() == output_mesh.its.vertices.size());
+    }
+
     // Quick check if the dimensions and placement of supports are correct
     auto obb = output_mesh.bounding_box();
 
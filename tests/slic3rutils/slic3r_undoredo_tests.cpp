@@ -0,0 +1,110 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "slic3r/Utils/UndoRedo.hpp"
+
+using namespace Slic3r::UndoRedo;
+
+static std::string random_data(size_t size, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::string out(size, '\0');
+    for (char &c : out)
+        c = char(dist(rng));
+    return out;
+}
+
+static std::string read_chunks(const std::vector<ChunkStore::Chunk*> &chunks)
+{
+    std::string out;
+    for (const ChunkStore::Chunk *chunk : chunks)
+        ChunkStore::read(*chunk, out);
+    return out;
+}
+
+static void release_chunks(ChunkStore &store, const std::vector<ChunkStore::Chunk*> &chunks)
+{
+    for (ChunkStore::Chunk *chunk : chunks)
+        store.release(chunk);
+}
+
+TEST_CASE("Undo / Redo chunks are bounded by size and read back", "[UndoRedo]") {
+    ChunkStore store;
+    std::string data = random_data(1024 * 1024, 1);
+
+    std::vector<ChunkStore::Chunk*> chunks = store.store(data);
+    REQUIRE(chunks.size() > 1);
+    size_t total = 0;
+    for (size_t i = 0; i < chunks.size(); ++ i) {
+        REQUIRE(chunks[i]->size <= ChunkStore::max_chunk_size);
+        // Only the last chunk may be shorter than the minimum.
+        if (i + 1 < chunks.size())
+            REQUIRE(chunks[i]->size >= ChunkStore::min_chunk_size);
+        total += chunks[i]->size;
+    }
+    REQUIRE(total == data.size());
+    REQUIRE(read_chunks(chunks) == data);
+
+    // Compressible data are deflated and inflated back.
+    std::string zeros(100000, '\0');
+    std::vector<ChunkStore::Chunk*> zero_chunks = store.store(zeros);
+    REQUIRE(zero_chunks.front()->deflated);
+    REQUIRE(read_chunks(zero_chunks) == zeros);
+
+    release_chunks(store, chunks);
+    release_chunks(store, zero_chunks);
+    REQUIRE(store.num_chunks() == 0);
+}
+
+TEST_CASE("Undo / Redo chunks are shared by equal data", "[UndoRedo]") {
+    ChunkStore store;
+    std::string data = random_data(512 * 1024, 2);
+
+    std::vector<ChunkStore::Chunk*> chunks = store.store(data);
+    const size_t num_chunks = store.num_chunks();
+    REQUIRE(num_chunks == chunks.size());
+
+    // The same data are made of the same chunks.
+    std::vector<ChunkStore::Chunk*> chunks2 = store.store(data);
+    REQUIRE(chunks2 == chunks);
+    REQUIRE(store.num_chunks() == num_chunks);
+    for (const ChunkStore::Chunk *chunk : chunks)
+        REQUIRE(chunk->refcnt == 2);
+
+    // Bytes inserted at the start only change the chunks around them, the boundaries after them do not shift.
+    std::string modified = random_data(100, 3) + data;
+    std::vector<ChunkStore::Chunk*> chunks3 = store.store(modified);
+    REQUIRE(read_chunks(chunks3) == modified);
+    REQUIRE(store.num_chunks() <= num_chunks + 2);
+
+    release_chunks(store, chunks3);
+    REQUIRE(store.num_chunks() == num_chunks);
+}
+
+TEST_CASE("Undo / Redo chunks are released with their last reference", "[UndoRedo]") {
+    ChunkStore store;
+    std::string data = random_data(256 * 1024, 4);
+
+    std::vector<ChunkStore::Chunk*> chunks  = store.store(data);
+    std::vector<ChunkStore::Chunk*> chunks2 = store.store(data);
+    const size_t num_chunks = store.num_chunks();
+
+    release_chunks(store, chunks);
+    REQUIRE(store.num_chunks() == num_chunks);
+    for (const ChunkStore::Chunk *chunk : chunks2)
+        REQUIRE(chunk->refcnt == 1);
+    REQUIRE(read_chunks(chunks2) == data);
+
+    release_chunks(store, chunks2);
+    REQUIRE(store.num_chunks() == 0);
+
+    // Stored again after the release.
+    std::vector<ChunkStore::Chunk*> chunks3 = store.store(data);
+    REQUIRE(store.num_chunks() == num_chunks);
+    REQUIRE(read_chunks(chunks3) == data);
+    release_chunks(store, chunks3);
+}